@@ -1,13 +1,44 @@
 /* File name: chenhowa.adventure.c
  * Author: Howard Chen
  * Date Created: 7-18-2017
- * Last Modified: 7-23-2017
- * Description: Uses 7 room files located in ./chenhowa.rooms.<PROCESS ID>, to generate
+ * Last Modified: 10-16-2026
+ * Description: Uses the maze located in ./chenhowa.rooms.<PROCESS ID>, to generate
  * 	a dungeon. This program then provides the user with an interface to explore
- * 	and complete that dungeon.
+ * 	and complete that dungeon. The maze is mapped straight from its binary maze
+ * 	file if the directory has one, and otherwise read from its room files by
+ * 	-j <threads> worker threads (default: one per processor).
+ *
+ * 	The time command is answered by a separate thread, which also writes the time
+ * 	to currentTime.txt unless -T is given.
+ *
+ * 	With -b <script>, no game is played interactively; the sessions in the script
+ * 	are replayed headlessly and a throughput report is printed (see chenhowa.batch.c).
+ *
+ * 	With -s <socket>, the maze is loaded once and served to any number of players
+ * 	over a Unix domain socket by -w <workers> threads (default: one per processor),
+ * 	until SIGINT or SIGTERM (see chenhowa.server.h for the protocol).
+ *
+ * 	With --reload, the game or the server keeps watching for new mazes: when
+ * 	./chenhowa.latest is repointed or the maze's directory changes, the new maze
+ * 	is loaded in the background, and every player moves into it on their next
+ * 	move (see chenhowa.reload.c).
+ *
+ * 	With --solve, no game is played; a shortest route from the START_ROOM to the
+ * 	END_ROOM is printed along with how long it took to find.
+ *
+ * 	With --simulate <walkers>, no game is played; that many random walkers start
+ * 	in the START_ROOM, split across -j threads, and the distribution of the steps
+ * 	they take to hit the END_ROOM is printed (see chenhowa.simulate.c). Walkers
+ * 	give up after --max-steps <n> steps (default 100 per room), and --seed <n>
+ * 	makes the walks repeatable (default: from the clock and the process id).
+ *
+ * 	When built with -DCHENHOWA_STATS (make stats), room file reads and parses,
+ * 	moves, time commands and the time service's lock are timed per thread.
+ * 	SIGUSR1 prints a snapshot of the stats to stderr, and --stats prints them on exit.
  *
  * 	Note that this program will use the most recent ./chenhowa.rooms.<PROCESS ID> directory
- * 	as the source for its room files
+ * 	as the source for its room files: the one ./chenhowa.latest points to, or the
+ * 	one modified last if that link is missing
  *
  */
 
@@ -20,142 +51,37 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <dirent.h>
 #include <pthread.h>
-
-#define START_ROOM 1
-#define MID_ROOM 2
-#define END_ROOM 3
-#define NUM_ROOMS 7
-#define NUM_NAMES 10
-#define MAX_CONNECTIONS 6
-#define MIN_CONNECTIONS 3
-
-/*Declares a global mutex -- I'd rather not use this, but in the process of
- * trying to figure out how to make the unlock and lock work (eventually I discovered
- * that I had to make the main thread sleep in my case), I decided using a 
- * global variable to simplify things was the best choice for this assignment.*/
-pthread_mutex_t fileMutex = PTHREAD_MUTEX_INITIALIZER;
-
-/*struct that contains the information in Room */
-struct Room {
-	char name[50]; /*name of room */
-	char connections[MAX_CONNECTIONS][50]; /*names of rooms that are connected to this room */
-	int type; /*type of the room */
-	int numConnections; /*Number of rooms connected to this room */
-
-};
-
-/*Player struct that holds player data */
-struct Player {
-	struct Room* curRoom; /*current room */
-	char *history; /*string containing the history of rooms the player has visited */
-	int visited; /*total number of rooms the Player has visited */
-};
-
-
-/* Reads in a Room's data from a Room file
- * args: [1] file, a pointer to an opened FILE
- *	[2] room, a pointer to a Room
- * pre: file should point to a Room file created by chenhowa.buildrooms
- * post: data in the Room file has been read into the Room struct
- * ret: none
- */
-void readRoom(FILE *file, struct Room *room) {
-	char type[50];
-	int trash = 0;
-
-	memset(type, '\0', sizeof(type) );
-
-	/*First, scan in the name */
-	fscanf(file, "ROOM NAME: %s\n", room->name);
-
-	/*Then repeatedly scan in connections */	
-	while(fscanf(file, "CONNECTION %i: %s\n", &trash, room->connections[room->numConnections] ) == 2) {
-		room->numConnections++;
-
-	}
-
-	/*Once you're done reading all the connections, read the room type */
-	fscanf(file, "ROOM TYPE: %s\n", type);
-	if (strcmp( type, "MID_ROOM") == 0 ) {
-		room->type = MID_ROOM;
-	}
-	else if(strcmp( type, "START_ROOM") == 0) {
-		room->type = START_ROOM;
-	}
-	else if(strcmp( type, "END_ROOM") == 0) {
-		room->type = END_ROOM;
-	}
-	else {
-		fprintf(stderr, "ERROR in reading room type for %s\n", room->name);
-	}
-
-}
-
-/*Initialize a Room struct to good default values, like 0 connections,
- * strings full of null terminators, etc. */
-void initRoom(struct Room *room) {
-	int i;
-
-	memset(room->name, '\0', 50);
-	for( i = 0; i < MAX_CONNECTIONS; i++) {
-		memset(room->connections[i], '\0', 50);
-	}
-
-	room->type = -1;
-	room->numConnections = 0;
-}
-
-/*prints the contents of a Room struct to a given open file */ 
-void printRoom(FILE *file, struct Room *r) {
-	int i;
-	char* type_str;
-
-	/*print the Room's name, or NULL if the room has no name */
-	if( r->name[0] == '\0') {
-		fprintf(file, "NULL\n");
-	} else {
-		fprintf(file, "ROOM NAME: %s\n", r->name);
-	}
-
-	/*Print each of the room's existing connections, or print NULL CONNECTION
- * 	if somehow a room connection is null */
-	for (i = 0; i < r->numConnections; i++) {
-		if(r->connections[i][0] == '\0') {
-			fprintf(file, "NULL CONNECTION\n");
-		} else {
-			fprintf(file, "CONNECTION %i: %s\n", i + 1, r->connections[i]);
-		}
-	}
-	
-	/*Print the room's type */
-	switch (r->type) {
-		case 1: type_str = "START_ROOM";
-		break;
-		case 2: type_str = "MID_ROOM";
-		break;
-		case 3: type_str = "END_ROOM";
-		break;
-		default: type_str = "UNASSIGNED_ROOM";
-		break;
-	}
-
-	/*flush the buffer to write to the file */
-	fprintf(file, "ROOM TYPE: %s\n", type_str);
-	fflush(file);
-}
+#include <signal.h>
+#include <getopt.h>
+
+#include "chenhowa.maze.h"
+#include "chenhowa.nametable.h"
+#include "chenhowa.loader.h"
+#include "chenhowa.timeservice.h"
+#include "chenhowa.player.h"
+#include "chenhowa.batch.h"
+#include "chenhowa.server.h"
+#include "chenhowa.graph.h"
+#include "chenhowa.simulate.h"
+#include "chenhowa.rng.h"
+#include "chenhowa.timing.h"
+#include "chenhowa.stats.h"
+#include "chenhowa.reload.h"
 
 
 /*Prompts the user for a command using the data contained in the
  * player's current room member variable */
 void promptPlayer(struct Player* player) {
 	int i;
-	printf("CURRENT LOCATION: %s\n", player->curRoom->name);
+	int numConnections = player->maze->degrees[player->curRoom];
+	const uint32_t* connections = mazeConnections(player->maze, player->curRoom);
+
+	printf("CURRENT LOCATION: %s\n", mazeRoomName(player->maze, player->curRoom));
 	printf("POSSIBLE CONNECTIONS:");
-	for(i = 0; i < player->curRoom->numConnections; i++) {
-		printf(" %s", player->curRoom->connections[i]);
-		if(i < player->curRoom->numConnections - 1) {
+	for(i = 0; i < numConnections; i++) {
+		printf(" %s", mazeRoomName(player->maze, connections[i]));
+		if(i < numConnections - 1) {
 			printf(",");
 		} else {
 			printf(".");
@@ -172,7 +98,8 @@ void promptPlayer(struct Player* player) {
  * post: a single line will be read from the file
  * post: returned c-string MUST be freed
  * post: newline is not included in the returned string
- * ret: a pointer to the line that was read, which was allocated on the heap.
+ * ret: a pointer to the line that was read, which was allocated on the heap,
+ * 	or NULL if the file has no more input.
  *
  * NOTE: this method comes from the lecture slides of CS 344 that describe
  * 	how to use getline to get a string of input from an open File.
@@ -184,9 +111,15 @@ char* getInput(FILE* file) {
 
 	/*Get a line of user input ending in '\n' */
 	numChars = getline(&line, &bufferSize, file);
+	if(numChars <= 0) {
+		free(line);
+		return NULL;
+	}
 	
 	/*Remove the newline from the end of the string */
-	line[numChars - 1] = '\0';
+	if(line[numChars - 1] == '\n') {
+		line[numChars - 1] = '\0';
+	}
 	
 	return line;
 }
@@ -194,63 +127,27 @@ char* getInput(FILE* file) {
 /* Executes the command input by the user
  * args: [1] player, the struct containing the player's data
  * 	[2] string, a cstring pointing to the user's command
- * 	[3] rooms, an array of room structs that the user is trying to navigate through
- * pre: rooms and player must have been completely initialized
+ * pre: player and its maze must have been completely initialized
  * post: user's current room is updated if user input was valid, or the time is
  * 	shown to the user. Otherwise an error message is given to the user.
  * ret: an int indicating whether or not an input error occured -- 1 represents error
  * 	0 represents successful user input
  */
-int executeCommand(struct Player* player, char* string, struct Room* rooms) {
-	int i;
-	int j;
-	char* time;
-	FILE* file;
-
-	/*If player chose to view time, we open the file, unlock the mutex so the thread
- * 	can write to it, sleep to give the other thread time to acquire the lock, then
- * 	relock the mutex, close the file, open for reading, read in the value
- * 	and then close the file again */
+int executeCommand(struct Player* player, char* string) {
+	char time[TIME_TEXT_LEN];
+
+	/*If player chose to view time, ask the time thread for it and show it */
 	if(strcmp(string, "time") == 0) {
-		/*Sleep two seconds to let the other thread obtain the lock and write the time */
-		pthread_mutex_unlock(&fileMutex);
-		sleep(2);
-		pthread_mutex_lock(&fileMutex);
-
-		/*After regaining the lock, read the current time from file */
-		file = fopen("currentTime.txt", "r");
-		time = getInput( file );
+		requestTime(player->timeService, time, sizeof(time));
 		fprintf(stdout, "\n%s\n\n", time);
-
-		free(time);
-		time = NULL;
-		fclose(file);
 		return 0;
-
-
 	}
-	
-	for(i = 0; i < player->curRoom->numConnections; i++) {
-		/*If the input string was one of the possible connections, change
- * 			the player's current room to point to the room with that name */
-		if(strcmp(player->curRoom->connections[i], string) == 0) {
-			for(j = 0; j < NUM_ROOMS; j++) {
-				if(strcmp(rooms[j].name, string) == 0) {
-					player->curRoom = rooms + j;
-					player->visited++;
-
-					/*Update the player's room history by reallocating
- * 						the history string */
-					player->history = realloc(player->history, 25 * player->visited);
-					strcat(player->history, string);
-					strcat(player->history, "\n");
-				}
 
-			}
-			printf("\n");
-			return 0;
-		}
-	}	
+	/*If the input string was one of the possible connections, the player moves there */
+	if(movePlayer(player, string) == 0) {
+		printf("\n");
+		return 0;
+	}
 
 	/*Otherwise, the string was not a command or a room name, so print
  * 		and error message and return 1 */
@@ -259,265 +156,333 @@ int executeCommand(struct Player* player, char* string, struct Room* rooms) {
 	return 1;
 }
 
-/*Method of getting time is from
- * https://stackoverflow.com/questions/1442116/how-to-get-date-and-time-value-in-c-program
- *
- * Description: this function writes the current LOCAL time in the assignment format to a file called
- * 	"currentTime.txt"
- * Args: none
- * Pre: requires a global mutex called fileMutex. This function must acquire a lock on this mutex
- * 	before writing to the file
- * Post: this function executes indefinitely, repeatedly opening "currentTime.txt" and writing
- * 	the time, IF it can get the lock again.
- * ret: none 
- * */
-void *writeTime(void *args) {
-	time_t t;
-	struct tm local_time;
-	FILE *file;
-	while(1) {
-		
-		/*Attempt to gain a lock on writing to the file */
-		pthread_mutex_lock( &fileMutex );
-
-		/* Once the lock is gained, open the deisred file */
-		t = time(NULL);
-		local_time = *localtime(&t);
-		file = fopen("currentTime.txt", "w");
-
-		/*Convert hour values to correct format while writing to file */
-		if(local_time.tm_hour == 0) {
-			fprintf(file, "12");
-		} else if (local_time.tm_hour <= 12) {
-			fprintf(file, "%d", local_time.tm_hour);
-		} else {
-			fprintf(file, "%d", local_time.tm_hour - 12);
-		}
-		fprintf(file, ":");
-
-		/*Convert minute values to correct format while writing to file*/
-		fprintf(file, "%02d", local_time.tm_min);
-		
-		/*Print am/pm status*/
-		if(local_time.tm_hour >= 12) {
-			fprintf(file, "pm");
+/* Prints a shortest route from the START_ROOM to the END_ROOM, found both with a
+ * 	plain and with a bidirectional BFS, and how long each search took. Small
+ * 	mazes also get their diameter from the all-pairs distances
+ * args: [1] maze, the loaded maze
+ * ret: 0 on success, 1 if the maze has no START_ROOM or END_ROOM, memory could not
+ * 	be allocated, or the searches disagree
+ */
+int solveMaze(struct Maze* maze) {
+	struct GraphSearch search;
+	struct Path path, bidirectional;
+	uint16_t* distances;
+	uint32_t start = findRoomOfType(maze, START_ROOM);
+	uint32_t end = findRoomOfType(maze, END_ROOM);
+	uint64_t bfsReached;
+	uint64_t i;
+	unsigned int diameter = 0;
+	double began, bfsTime, bidirectionalTime, allPairsTime;
+	int result = 0;
+
+	if(start == NO_ROOM || end == NO_ROOM) {
+		fprintf(stderr, "Error. The maze needs a START_ROOM and an END_ROOM\n");
+		return 1;
+	}
+	if(initGraphSearch(&search, maze) != 0) {
+		fprintf(stderr, "Error. Couldn't allocate a search of %u rooms\n", maze->numRooms);
+		return 1;
+	}
+	initPath(&path);
+	initPath(&bidirectional);
+
+	began = nowNs();
+	result |= shortestPath(&search, start, end, &path);
+	bfsTime = nowNs() - began;
+	bfsReached = search.reached;
+	began = nowNs();
+	result |= bidirectionalPath(&search, start, end, &bidirectional);
+	bidirectionalTime = nowNs() - began;
+
+	if(result != 0 || path.length != bidirectional.length) {
+		fprintf(stderr, "Error. The searches failed or disagree\n");
+		result = 1;
+	} else if(path.length == NO_PATH) {
+		printf("the END_ROOM can't be reached from the START_ROOM\n");
+	} else {
+		printf("shortest route: %u steps\n", path.length);
+		for(i = 0; i <= path.length; i++) {
+			printf("%s\n", mazeRoomName(maze, path.rooms[i]));
 		}
-		else {
-			fprintf(file, "am");
+	}
+	printf("bfs: %.3f us, %llu rooms reached\n", bfsTime / 1e3, (unsigned long long)bfsReached);
+	printf("bidirectional bfs: %.3f us, %llu rooms reached\n", bidirectionalTime / 1e3,
+		(unsigned long long)search.reached);
+
+	if(maze->numRooms <= ALL_PAIRS_LIMIT) {
+		began = nowNs();
+		if(allPairsDistances(maze, &distances) == 0) {
+			allPairsTime = nowNs() - began;
+			for(i = 0; i < (uint64_t)maze->numRooms * maze->numRooms; i++) {
+				if(distances[i] != UNREACHABLE && distances[i] > diameter) {
+					diameter = distances[i];
+				}
+			}
+			printf("all-pairs distances: %.3f us, diameter %u steps\n", allPairsTime / 1e3, diameter);
+			free(distances);
 		}
+	}
 
-		fprintf(file, ", ");
+	freePath(&path);
+	freePath(&bidirectional);
+	freeGraphSearch(&search);
+	return result;
+}
 
-		/*Write the current day of the week */
-		switch(local_time.tm_wday) {
-			case 0: fprintf(file, "Sunday");
-			break;
-			case 1: fprintf(file, "Monday");
-			break;
-			case 2: fprintf(file, "Tuesday");
-			break;
-			case 3: fprintf(file, "Wednesday");
-			break;
-			case 4: fprintf(file, "Thurday");
-			break;
-			case 5: fprintf(file, "Friday");
-			break;
-			case 6: fprintf(file, "Saturday");
-			break;
-			default: fprintf(stderr, "ERROR IN WEEKDAY\n\n");
-		}
-		fprintf(file, ", ");
-		
-		/*Write the month */
-		switch(local_time.tm_mon) {
-			case 0: fprintf(file, "January");
-			break;
-			case 1: fprintf(file, "February");
+/*Prints the stats to stderr as the program exits, for --stats */
+void dumpStats(void) {
+	printStats(stderr);
+}
+
+/*Returns the number of steps on a shortest route from the START_ROOM to the
+ * END_ROOM, or NO_PATH if there is none or it could not be searched for */
+uint32_t optimalSteps(struct Maze* maze) {
+	struct GraphSearch search;
+	struct Path path;
+	uint32_t steps = NO_PATH;
+
+	if(initGraphSearch(&search, maze) != 0) {
+		return NO_PATH;
+	}
+	initPath(&path);
+	if(bidirectionalPath(&search, findRoomOfType(maze, START_ROOM), findRoomOfType(maze, END_ROOM), &path) == 0) {
+		steps = path.length;
+	}
+	freePath(&path);
+	freeGraphSearch(&search);
+	return steps;
+}
+
+int main(int argc, char* argv[]) {
+	char newestDirName[256]; /*holds name of newest dir so we can open it later */
+
+	struct Maze maze; /*Holds the rooms data in this program */
+	struct NameTable names; /*Looks up rooms by name */
+
+	struct Player player; /*Holds the player data */
+	char* playerInput;  /*Holds the user input during the game's execution */
+
+	struct TimeService timeService; /*thread that tells the time */
+	int writeTimeFile = 1; /*whether the time thread also writes currentTime.txt */
+	char* batchScript = NULL; /*script to replay headlessly, if any */
+	char* socketPath = NULL; /*socket to serve players on, if any */
+	int reload = 0; /*whether to watch for new mazes and move players into them */
+	struct MazeReloader reloader; /*loads new mazes, with --reload */
+	int serverWorkers; /*number of threads that serve players */
+	sigset_t stopSignals; /*signals that stop the server */
+	int result;
+
+	int solve = 0; /*whether to print a shortest route instead of playing */
+	int stats = 0; /*whether to print the stats on exit */
+	struct Simulation simulation; /*random walkers to run instead of playing, if any */
+	uint32_t optimal; /*steps on a shortest route to the END_ROOM */
+
+	int loadThreads; /*number of threads that read room files */
+	int opt;
+	static struct option longOptions[] = {
+		{ "solve", no_argument, NULL, 'S' },
+		{ "stats", no_argument, NULL, 'D' },
+		{ "simulate", required_argument, NULL, 'R' },
+		{ "max-steps", required_argument, NULL, 'M' },
+		{ "seed", required_argument, NULL, 'E' },
+		{ "reload", no_argument, NULL, 'L' },
+		{ NULL, 0, NULL, 0 }
+	};
+	STATS_TIMER(started);
+
+	/*Read room files with one thread per processor unless told otherwise */
+	loadThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	serverWorkers = loadThreads;
+	simulation.walkers = 0;
+	simulation.maxSteps = 0;
+	simulation.seed = defaultSeed();
+	while((opt = getopt_long(argc, argv, "j:Tb:s:w:", longOptions, NULL)) != -1) {
+		switch(opt) {
+			case 'j': loadThreads = atoi(optarg);
 			break;
-			case 2: fprintf(file, "March");
+			case 'T': writeTimeFile = 0;
 			break;
-			case 3: fprintf(file, "April");
+			case 'b': batchScript = optarg;
 			break;
-			case 4: fprintf(file, "May");
+			case 's': socketPath = optarg;
 			break;
-			case 5: fprintf(file, "June");
+			case 'w': serverWorkers = atoi(optarg);
 			break;
-			case 6: fprintf(file, "July");
+			case 'S': solve = 1;
 			break;
-			case 7: fprintf(file, "August");
+			case 'D': stats = 1;
 			break;
-			case 8: fprintf(file, "September");
+			case 'R': simulation.walkers = strtoull(optarg, NULL, 10);
 			break;
-			case 9: fprintf(file, "October");
+			case 'M': simulation.maxSteps = strtoul(optarg, NULL, 10);
 			break;
-			case 10: fprintf(file, "November");
+			case 'E': simulation.seed = strtoull(optarg, NULL, 10);
 			break;
-			case 11: fprintf(file, "December");
+			case 'L': reload = 1;
 			break;
-			default: fprintf(stderr, "ERROR IN MONTH\n\n");
+			default:
+				fprintf(stderr, "Usage: %s [-j threads] [-T] [-b script | -s socket [-w workers] | --solve "
+					"| --simulate walkers [--max-steps n] [--seed n]] [--reload] [--stats]\n", argv[0]);
+				return 1;
 		}
-		fprintf(file, " ");
-
-		/*Write the day of the month, and the year */
-		fprintf(file, "%d", local_time.tm_mday);
-		fprintf(file, ", %d\n", local_time.tm_year + 1900);
-
-		/*Once the writing is done, close the file, unlock the file for reading,
- * 		and SLEEP so the main thread can regain the lock */
-		fclose(file);
-		pthread_mutex_unlock( &fileMutex );
-		sleep(2);
 	}
-}
-
-
-int main() {
-	/*the directory manipulation code used here is DIRECTLY based on the code
- * 		provided in the Reading Notes for CS 344 on Canvas */
-
-	int newestDirTime = -1;
-	char targetDirPrefix[64] = "chenhowa.rooms."; /*Desired prefix of directory*/
-	char newestDirName[256]; /*holds name of newest dir so we can open it later */
-
-	DIR* dirToCheck; /*Holds my starting directory */
-	struct dirent *fileInDir; /*Hold current file in starting directory */
-	struct stat dirAttributes; /*Holds info from stat call on fileInDir */
-
-	FILE *fd; /*File descriptor for opening and closing room files */
-	char fileName[256]; /*Holds a given room file's name. */
-
-	struct Room rooms[NUM_ROOMS]; /*Hold the rooms data in this program */
-	int i;		/*index for the rooms array */
-
-	struct Player player; /*Holds the player data */
-	char* playerInput;  /*Holds the user input during the game's execution */
-
-	int threadResult; /*holds result of creating thread */
-	pthread_t timeThread; /*thread! */
-
-	/*Null terminate string memory to avoid problems later */
-	memset(fileName, '\0', sizeof(fileName));
-	memset(newestDirName, '\0', sizeof(newestDirName));
-
-	/*initialize all the rooms */
-	for(i = 0; i < NUM_ROOMS; i++) {
-		initRoom(rooms + i);
+	if(reload && (batchScript != NULL || solve || simulation.walkers > 0)) {
+		fprintf(stderr, "Error. --reload only works with the game and the server\n");
+		return 1;
+	}
+	if(loadThreads < 1) {
+		loadThreads = 1;
+	}
+	if(stats && !STATS_ENABLED) {
+		fprintf(stderr, "Error. --stats needs a build with -DCHENHOWA_STATS (make stats)\n");
+		return 1;
 	}
 
+	/*The stats thread takes SIGUSR1, so start it before any other thread to
+ * 		have them all inherit the blocked signal */
+	if(startStatsThread() != 0) {
+		fprintf(stderr, "Error. Couldn't start the stats thread\n");
+		return 1;
+	}
+	if(stats) {
+		atexit(dumpStats);
+	}
 
-
-	dirToCheck = opendir(".");  /*Open the current working directory as the starting dir */
-	if(!dirToCheck) {
-		fprintf(stderr, "Error. Couldn't open current working directory");
+	/*Find the newest rooms directory */
+	STATS_START(started);
+	if(findNewestRoomsDir(newestDirName, sizeof(newestDirName)) != 0) {
 		return 1;
 	}
+	STATS_STOP(STAT_DISCOVER, started);
 
-	/*check every entry in the directory to see if it contains the prefix*/
-	fileInDir = readdir(dirToCheck);
-	while(fileInDir != NULL) { 
-		/*If the entry has the prefix in its name, get the attributes of this entry */
-		if(strstr(fileInDir->d_name, targetDirPrefix) != NULL) { 
-			stat(fileInDir->d_name, &dirAttributes);
+	/*Now that we have the newest directory, load the maze in it. With --reload,
+ * 		the reloader loads it instead, once the server's signals are blocked */
+	if(!reload && loadMaze(newestDirName, &maze, &names, loadThreads) != 0) {
+		return 1;
+	}
 
-			if( (int)dirAttributes.st_mtime > newestDirTime ) {
-				/*if this entry was created later, then it is the newest directory
- * 					with the desired prefix*/
-				newestDirTime = (int)dirAttributes.st_mtime;
-				memset(newestDirName, '\0', sizeof(newestDirName));
-				strcpy(newestDirName, fileInDir->d_name);
+	/*Solving needs neither a player nor the time thread */
+	if(solve) {
+		result = solveMaze(&maze);
+		freeNameTable(&names);
+		closeMaze(&maze);
+		return result;
+	}
 
-			}
+	/*Simulating needs neither a player nor the time thread either */
+	if(simulation.walkers > 0) {
+		simulation.threads = loadThreads;
+		simulation.optimal = optimalSteps(&maze);
+		if(simulation.maxSteps == 0) {
+			simulation.maxSteps = (uint64_t)maze.numRooms * 100 < UINT32_MAX ? maze.numRooms * 100 : UINT32_MAX - 1;
 		}
-		
-		fileInDir = readdir(dirToCheck);
+		result = runSimulation(&maze, &simulation);
+		freeNameTable(&names);
+		closeMaze(&maze);
+		return result;
 	}
 
-	/*After examining all the MATCHING files in the current directory, close it */
-	closedir(dirToCheck);
-	dirToCheck = NULL;
+	/*The server takes SIGINT and SIGTERM through a signalfd, so no thread may
+ * 		receive them the usual way. Block them before the time thread starts,
+ * 		since new threads inherit the mask */
+	if(socketPath != NULL) {
+		sigemptyset(&stopSignals);
+		sigaddset(&stopSignals, SIGINT);
+		sigaddset(&stopSignals, SIGTERM);
+		pthread_sigmask(SIG_BLOCK, &stopSignals, NULL);
+	}
 
-	/*Now that we have the newest directory, we can open it and scan the contents */
-	dirToCheck = opendir(newestDirName);
-	if(!dirToCheck) {
-		fprintf(stderr, "Error. Couldn't open NEWEST directory");
+	/*The reloader's thread inherits the mask too; only the server reports reloads */
+	if(reload && startMazeReloader(&reloader, loadThreads, socketPath != NULL) != 0) {
 		return 1;
 	}
 
-	i = 0; /*Prepare to read in room files to the rooms array */
-
-	/*Read every Room file in the directory. Use each room file to set the values of a new
- * 		Room struct in the Room array */
-	fileInDir = readdir(dirToCheck);
-	while(fileInDir != NULL) { 
-		memset(fileName, '\0', sizeof(fileName));
-		/*We care about every file except the . and .. files */
-		if(strcmp(fileInDir->d_name, ".") != 0 && strcmp(fileInDir->d_name, "..") != 0  ) {
-			sprintf(fileName, "./%s/%s", newestDirName, fileInDir->d_name);
-
-			/*Open the room file, and if the open is successful, read in the Room data */
-			fd = fopen(fileName, "r"); 
-			
-			if(!fd) {
-				fprintf(stderr, "Error. Attempt to open room file %s failed", fileName);
-				return 1;
-			}	
+	/*Create a thread that tells the time whenever the player asks for it */
+	if(startTimeService(&timeService, writeTimeFile) != 0) {
+		fprintf(stderr, "Error. Couldn't start the time thread\n");
+		return 1;
+	}
+
+	/*In batch mode, replay the script instead of playing interactively */
+	if(batchScript != NULL) {
+		result = runBatch(batchScript, &maze, &names, &timeService);
+		stopTimeService(&timeService);
+		freeNameTable(&names);
+		closeMaze(&maze);
+		return result;
+	}
 
-			readRoom(fd, rooms + i);
-			i++;
-			
-			/*Close the room file once we're done with it */
-			fclose(fd);
+	/*In server mode, serve players until told to stop */
+	if(socketPath != NULL) {
+		if(reload) {
+			result = runServer(socketPath, serverWorkers, NULL, NULL, &reloader, &timeService);
+			stopMazeReloader(&reloader);
+		} else {
+			result = runServer(socketPath, serverWorkers, &maze, &names, NULL, &timeService);
+			freeNameTable(&names);
+			closeMaze(&maze);
 		}
-		/*Get the next room file */
-		fileInDir = readdir(dirToCheck);
+		stopTimeService(&timeService);
+		return result;
 	}
-	/*Close the directory when done. Now ready to begin the game */
-	closedir(dirToCheck);
-	dirToCheck = NULL;
 
 	/*To begin the game, initiate the player to the required values:
  * 		give the player an empty history, with 0 rooms visited
  * 		and the correct starting room */
-	player.history = malloc(25 * sizeof(char) );
-	memset(player.history, '\0', 25);
-	player.visited = 0;
-	for(i = 0; i < NUM_ROOMS; i++) {
-		if( rooms[i].type == START_ROOM ) {
-			player.curRoom = rooms + i;
+	if(reload) {
+		result = initPlayerFromReloader(&player, &reloader, &timeService);
+	} else {
+		result = initPlayer(&player, &maze, &names, &timeService);
+	}
+	if(result != 0) {
+		fprintf(stderr, "Error. The maze has no START_ROOM\n");
+		if(reload) {
+			stopMazeReloader(&reloader);
 		}
+		stopTimeService(&timeService);
+		return 1;
 	}
 
-	/*Before starting the thread, LOCK THE FILE */
-	pthread_mutex_lock( &fileMutex );
-
-	/*Create a thread to constantly try to write and read a current time to a file */
-	threadResult = pthread_create( &timeThread, NULL, writeTime, NULL);
-
 	/*While the current room of the player is NOT the end room, play the game */
-	while(player.curRoom->type != END_ROOM) {
+	while(!playerHasWon(&player)) {
 		/* get player input */
 		promptPlayer(&player);
 		playerInput = getInput(stdin);	
+		if(playerInput == NULL) {
+			/*Out of input, so the game can never be finished */
+			printf("\n");
+			break;
+		}
 
 		/*Execute the command specified by the player input */
-		executeCommand(&player, playerInput, rooms);
+		executeCommand(&player, playerInput);
 
 		/*Prepare to get new user input */
 		free(playerInput);
 		playerInput = NULL;
 	}
 
-	printf("YOU HAVE FOUND THE END ROOM. CONGRATULATIONS!\n");
-	printf("YOU TOOK %i STEPS. YOUR PATH TO VICTORY WAS:\n", player.visited);
-	printf("%s", player.history);
+	if(playerHasWon(&player)) {
+		printf("YOU HAVE FOUND THE END ROOM. CONGRATULATIONS!\n");
+		printf("YOU TOOK %i STEPS. YOUR PATH TO VICTORY WAS:\n", player.visited);
+		printHistory(stdout, &player);
+		optimal = optimalSteps(player.maze);
+		if(optimal != NO_PATH) {
+			printf("THE SHORTEST PATH TOOK %u STEPS.\n", optimal);
+		}
+	}
 
-	/*Clean up the allocated memory of the player's history cstring */
-	free(player.history);
+	/*Clean up the allocated memory of the player's history */
+	freePlayer(&player);
+	if(reload) {
+		stopMazeReloader(&reloader);
+	} else {
+		freeNameTable(&names);
+		closeMaze(&maze);
+	}
 
-	/*End the other thread */
-	pthread_cancel(timeThread);
-	sleep(8);
+	/*Tell the time thread to finish, and wait for it */
+	stopTimeService(&timeService);
 
 	return 0;
 }
-
@@ -0,0 +1,213 @@
+/* Filename: chenhowa.batch.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Runs a script of game sessions with no prompt output.
+ *
+ * 	A script holds one command per line, exactly as a player would type it.
+ * 	Sessions are separated by blank lines, and lines starting with # are ignored.
+ * 	Every session starts a fresh player in the START_ROOM; once the player reaches
+ * 	the END_ROOM, the rest of that session's commands are skipped.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "chenhowa.batch.h"
+#include "chenhowa.player.h"
+#include "chenhowa.timing.h"
+#include "chenhowa.graph.h"
+
+/*A script read into memory and cut into lines */
+struct Script {
+	char* text; /*the whole script, with every newline replaced by a NUL */
+	char** lines; /*start of every command line, in order */
+	size_t numLines; /*number of entries in lines */
+	size_t* sessionStart; /*index in lines of the first command of each session */
+	size_t numSessions; /*number of sessions */
+};
+
+/*Frees the memory held by a Script */
+static void freeScript(struct Script* script) {
+	free(script->text);
+	free(script->lines);
+	free(script->sessionStart);
+	memset(script, 0, sizeof(*script));
+}
+
+/* Reads a batch script into memory before any session is timed
+ * args: [1] path, the script file
+ * 	[2] script, the Script to fill in
+ * post: script must be released with freeScript. sessionStart has one extra entry
+ * 	at the end holding numLines, so session i runs lines sessionStart[i] up to
+ * 	sessionStart[i + 1]
+ * ret: 0 on success, 1 if the file could not be read or memory could not be allocated
+ */
+static int readScript(const char* path, struct Script* script) {
+	FILE* file;
+	long size;
+	char* line;
+	char* end;
+	int inSession = 0;
+
+	memset(script, 0, sizeof(*script));
+
+	file = fopen(path, "r");
+	if(!file) {
+		fprintf(stderr, "Error. Couldn't open batch script %s\n", path);
+		return 1;
+	}
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	/*Every line is at least one byte, so size + 1 entries are always enough */
+	script->text = malloc(size + 1);
+	script->lines = malloc((size + 1) * sizeof(char*));
+	script->sessionStart = malloc((size + 2) * sizeof(size_t));
+	if(script->text == NULL || script->lines == NULL || script->sessionStart == NULL
+			|| fread(script->text, 1, size, file) != (size_t)size) {
+		fprintf(stderr, "Error. Couldn't read batch script %s\n", path);
+		fclose(file);
+		freeScript(script);
+		return 1;
+	}
+	fclose(file);
+	script->text[size] = '\0';
+
+	/*Cut the text into lines, and start a new session after every blank line */
+	line = script->text;
+	while(line < script->text + size) {
+		end = strchr(line, '\n');
+		if(end == NULL) {
+			end = script->text + size;
+		}
+		*end = '\0';
+		if(end > line && end[-1] == '\r') {
+			end[-1] = '\0';
+		}
+
+		if(line[0] == '\0') {
+			inSession = 0;
+		} else if(line[0] != '#') {
+			if(!inSession) {
+				script->sessionStart[script->numSessions] = script->numLines;
+				script->numSessions++;
+				inSession = 1;
+			}
+			script->lines[script->numLines] = line;
+			script->numLines++;
+		}
+		line = end + 1;
+	}
+	script->sessionStart[script->numSessions] = script->numLines;
+
+	return 0;
+}
+
+/* Replays every session of a batch script and reports how fast they ran
+ * args: [1] scriptPath, the batch script
+ * 	[2] maze, the loaded maze
+ * 	[3] names, the name table of maze
+ * 	[4] timeService, a started time service for the time command
+ * post: nothing is printed while sessions run. Afterwards a report of the number
+ * 	of sessions and commands, moves per second, session latency percentiles,
+ * 	and how the finished sessions compare to a shortest route is printed to stdout
+ * ret: 0 on success, 1 if the script could not be read or a player could not be started
+ */
+int runBatch(const char* scriptPath, struct Maze* maze, struct NameTable* names, struct TimeService* timeService) {
+	struct Script script;
+	struct Player player;
+	char time[TIME_TEXT_LEN];
+	double* latencies;
+	double start;
+	double sessionStart;
+	double elapsed;
+	unsigned long long moves = 0;
+	unsigned long long timeCommands = 0;
+	unsigned long long invalid = 0;
+	unsigned long long skipped = 0;
+	size_t finished = 0;
+	unsigned long long finishedSteps = 0; /*steps taken by sessions that reached the END_ROOM */
+	struct GraphSearch search;
+	struct Path optimal;
+	size_t session;
+	size_t line;
+	uint32_t startRoom;
+
+	if(readScript(scriptPath, &script) != 0) {
+		return 1;
+	}
+	latencies = malloc((script.numSessions + 1) * sizeof(double));
+	if(latencies == NULL) {
+		freeScript(&script);
+		return 1;
+	}
+
+	/*Every session starts in the same room, so only look for it once */
+	startRoom = findRoomOfType(maze, START_ROOM);
+
+	start = nowNs();
+	for(session = 0; session < script.numSessions; session++) {
+		sessionStart = nowNs();
+		if(initPlayerInRoom(&player, maze, names, timeService, startRoom) != 0) {
+			fprintf(stderr, "Error. Couldn't start a player in the maze\n");
+			free(latencies);
+			freeScript(&script);
+			return 1;
+		}
+
+		for(line = script.sessionStart[session]; line < script.sessionStart[session + 1]; line++) {
+			if(playerHasWon(&player)) {
+				skipped += script.sessionStart[session + 1] - line;
+				break;
+			}
+			if(strcmp(script.lines[line], "time") == 0) {
+				requestTime(timeService, time, sizeof(time));
+				timeCommands++;
+			} else if(movePlayer(&player, script.lines[line]) == 0) {
+				moves++;
+			} else {
+				invalid++;
+			}
+		}
+		if(playerHasWon(&player)) {
+			finished++;
+			finishedSteps += player.visited;
+		}
+
+		freePlayer(&player);
+		latencies[session] = nowNs() - sessionStart;
+	}
+	elapsed = nowNs() - start;
+
+	sortSamples(latencies, script.numSessions);
+
+	/*Grade every finished session against one shortest route, found after timing */
+	initPath(&optimal);
+	if(initGraphSearch(&search, maze) == 0) {
+		bidirectionalPath(&search, startRoom, findRoomOfType(maze, END_ROOM), &optimal);
+		freeGraphSearch(&search);
+	}
+
+	printf("sessions: %zu (%zu reached the END_ROOM)\n", script.numSessions, finished);
+	printf("commands: %llu moves, %llu time, %llu not understood, %llu skipped after the END_ROOM\n",
+		moves, timeCommands, invalid, skipped);
+	printf("elapsed: %.6f s\n", elapsed / 1e9);
+	printf("moves per second: %.0f\n", elapsed > 0 ? moves / (elapsed / 1e9) : 0.0);
+	printf("session latency (us): p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n",
+		percentile(latencies, script.numSessions, 0.50) / 1e3,
+		percentile(latencies, script.numSessions, 0.90) / 1e3,
+		percentile(latencies, script.numSessions, 0.99) / 1e3,
+		percentile(latencies, script.numSessions, 1.0) / 1e3);
+	if(optimal.length != NO_PATH && finished > 0) {
+		printf("shortest route: %u steps; finished sessions averaged %.2f steps (%.2fx the shortest)\n",
+			optimal.length, (double)finishedSteps / finished,
+			optimal.length > 0 ? (double)finishedSteps / finished / optimal.length : 1.0);
+	}
+	freePath(&optimal);
+
+	free(latencies);
+	freeScript(&script);
+	return 0;
+}
@@ -0,0 +1,18 @@
+/* Filename: chenhowa.batch.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Headless batch mode for chenhowa.adventure. Replays scripted
+ * 	sessions against a loaded maze without printing prompts, and reports
+ * 	throughput and per-session latency.
+ */
+
+#ifndef CHENHOWA_BATCH_H
+#define CHENHOWA_BATCH_H
+
+#include "chenhowa.maze.h"
+#include "chenhowa.nametable.h"
+#include "chenhowa.timeservice.h"
+
+int runBatch(const char* scriptPath, struct Maze* maze, struct NameTable* names, struct TimeService* timeService);
+
+#endif
@@ -0,0 +1,457 @@
+/* Filename: chenhowa.bench.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Benchmark harness for the whole pipeline, from generating a maze
+ * 	to playing it: generation, writing the room files, parsing them back, name
+ * 	lookups, single moves and whole replayed sessions, each at several maze sizes.
+ * Input: optional -n <sizes>, comma separated room counts (default 1000,100000,1000000)
+ * 	optional -r <repeats>, runs of each benchmark per size (default 5)
+ * 	optional -o <file>, where to write the results (default chenhowa.bench.csv)
+ * 	optional -F <csv|json>, the format of the results (default csv)
+ * 	optional -t <rooms>, the largest maze whose room files are written and parsed (default 100000)
+ * 	optional -p <threads>, the threads that generate and load mazes (default 1)
+ * 	optional -s <seed>, the random seed (default 1)
+ * Output: a table of results on stdout, and one record per benchmark and size in
+ * 	the results file with the sample count and the median, 90th and 99th
+ * 	percentile, fastest and slowest time of one operation in ns
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "chenhowa.roomgraph.h"
+#include "chenhowa.generator.h"
+#include "chenhowa.loader.h"
+#include "chenhowa.player.h"
+#include "chenhowa.timing.h"
+#include "chenhowa.rng.h"
+
+#define MAX_SIZES 16
+#define NAME_LEN 16 /*room for "ROOM_" plus a 10 digit index */
+#define BATCH 4096 /*lookups or moves timed together as one sample */
+#define LOOKUPS (64 * BATCH) /*lookups per repeat */
+#define MOVES (64 * BATCH) /*moves per repeat */
+#define SESSIONS 1024 /*sessions replayed per repeat */
+#define SESSION_MOVES 64 /*moves in each session */
+#define SCRATCH_DIR "chenhowa.bench.XXXXXX"
+
+/*Growable list of timing samples, in ns per operation */
+struct Samples {
+	double* values;
+	size_t count;
+	size_t capacity;
+};
+
+/*Settings shared by every benchmark */
+struct BenchConfig {
+	uint32_t sizes[MAX_SIZES];
+	int numSizes;
+	int repeats;
+	uint32_t textLimit; /*largest maze that is written out and parsed back */
+	int threads;
+	uint64_t seed;
+	FILE* out;
+	int json; /*1 for JSON results, 0 for CSV */
+	int records; /*results written so far */
+};
+
+/*Adds a sample to a list. Returns 0 on success, 1 if memory ran out */
+static int addSample(struct Samples* samples, double value) {
+	double* grown;
+	size_t capacity;
+
+	if(samples->count == samples->capacity) {
+		capacity = samples->capacity ? 2 * samples->capacity : 256;
+		grown = realloc(samples->values, capacity * sizeof(double));
+		if(grown == NULL) {
+			return 1;
+		}
+		samples->values = grown;
+		samples->capacity = capacity;
+	}
+	samples->values[samples->count] = value;
+	samples->count++;
+	return 0;
+}
+
+/* Prints the summary of one benchmark to stdout and the results file
+ * args: [1] config, the settings and results file
+ * 	[2] name, the benchmark
+ * 	[3] unit, the operation one sample times
+ * 	[4] rooms, the maze size
+ * 	[5] samples, the samples taken. They are sorted and then cleared
+ */
+static void report(struct BenchConfig* config, const char* name, const char* unit, uint32_t rooms,
+		struct Samples* samples) {
+	size_t n = samples->count;
+	double* v = samples->values;
+
+	if(n == 0) {
+		return;
+	}
+	sortSamples(v, n);
+	printf("%-10s %8u %-8s %8zu %12.1f %12.1f %12.1f %12.1f %12.1f\n", name, rooms, unit, n,
+		percentile(v, n, 0.5), percentile(v, n, 0.9), percentile(v, n, 0.99), v[0], v[n - 1]);
+
+	if(config->json) {
+		fprintf(config->out, "%s\n  {\"benchmark\": \"%s\", \"rooms\": %u, \"unit\": \"%s\", \"samples\": %zu, "
+			"\"median_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"min_ns\": %.1f, \"max_ns\": %.1f}",
+			config->records ? "," : "", name, rooms, unit, n,
+			percentile(v, n, 0.5), percentile(v, n, 0.9), percentile(v, n, 0.99), v[0], v[n - 1]);
+	} else {
+		fprintf(config->out, "%s,%u,%s,%zu,%.1f,%.1f,%.1f,%.1f,%.1f\n", name, rooms, unit, n,
+			percentile(v, n, 0.5), percentile(v, n, 0.9), percentile(v, n, 0.99), v[0], v[n - 1]);
+	}
+	config->records++;
+	samples->count = 0;
+}
+
+/* Names every room of a graph ROOM_<n>
+ * args: [1] graph, the RoomGraph to name
+ * ret: the memory holding the names, to be freed after the graph, or NULL if
+ * 	memory could not be allocated
+ */
+static char* nameRooms(struct RoomGraph* graph) {
+	char* storage = malloc((size_t)graph->numRooms * NAME_LEN);
+	uint32_t i;
+
+	for(i = 0; storage != NULL && i < graph->numRooms; i++) {
+		graph->names[i] = storage + (size_t)i * NAME_LEN;
+		snprintf(graph->names[i], NAME_LEN, "ROOM_%u", i);
+	}
+	return storage;
+}
+
+/* Generates a random maze, with generated names
+ * args: [1] graph, the RoomGraph to create
+ * 	[2] storage, set to the memory holding the names
+ * 	[3] rooms, the number of rooms
+ * 	[4] config, the settings; the seed is varied by repeat
+ * 	[5] repeat, the run of the benchmark
+ * ret: the ns per room taken by allocating, naming, typing and connecting the rooms,
+ * 	or a negative number if memory could not be allocated
+ */
+static double generate(struct RoomGraph* graph, char** storage, uint32_t rooms,
+		const struct BenchConfig* config, int repeat) {
+	struct Rng rng;
+	double start;
+
+	seedRng(&rng, config->seed + repeat);
+	start = nowNs();
+	if(initRoomGraph(graph, rooms, 3, 6) != 0) {
+		return -1;
+	}
+	*storage = nameRooms(graph);
+	if(*storage == NULL) {
+		freeRoomGraph(graph);
+		return -1;
+	}
+	assignRandomTypes(graph, &rng);
+	if(connectRandomRooms(graph, config->threads, &rng) != 0) {
+		freeRoomGraph(graph);
+		free(*storage);
+		return -1;
+	}
+	return (nowNs() - start) / rooms;
+}
+
+/*Removes a scratch directory and the room files of graph in it */
+static void removeRoomFiles(const char* dirName, const struct RoomGraph* graph) {
+	int dirFd = open(dirName, O_RDONLY | O_DIRECTORY);
+	uint32_t i;
+
+	for(i = 0; dirFd >= 0 && i < graph->numRooms; i++) {
+		unlinkat(dirFd, graph->names[i], 0);
+	}
+	if(dirFd >= 0) {
+		close(dirFd);
+	}
+	rmdir(dirName);
+}
+
+/* Times writing a graph out as room files and loading them back into a maze
+ * args: [1] config, the settings and results file
+ * 	[2] graph, a finished RoomGraph
+ * 	[3] samples, an empty sample list to use
+ * ret: 0 on success, 1 if the files could not be written or read
+ */
+static int benchText(struct BenchConfig* config, const struct RoomGraph* graph, struct Samples* samples) {
+	char dirName[] = SCRATCH_DIR;
+	struct Maze maze;
+	struct NameTable names;
+	double start;
+	int repeat;
+	int result = 0;
+
+	if(mkdtemp(dirName) == NULL) {
+		fprintf(stderr, "Could not create a scratch directory\n");
+		return 1;
+	}
+
+	for(repeat = 0; repeat < config->repeats && result == 0; repeat++) {
+		start = nowNs();
+		result = writeRoomFiles(dirName, graph);
+		if(result == 0 && addSample(samples, (nowNs() - start) / graph->numRooms) != 0) {
+			result = 1;
+		}
+	}
+	report(config, "write", "room", graph->numRooms, samples);
+
+	for(repeat = 0; repeat < config->repeats && result == 0; repeat++) {
+		start = nowNs();
+		result = loadTextMaze(dirName, &maze, &names, config->threads);
+		if(result == 0) {
+			result = addSample(samples, (nowNs() - start) / graph->numRooms);
+			freeNameTable(&names);
+			closeMaze(&maze);
+		}
+	}
+	report(config, "parse", "room", graph->numRooms, samples);
+
+	removeRoomFiles(dirName, graph);
+	return result;
+}
+
+/* Takes a random walk through a maze
+ * args: [1] maze, the maze to walk
+ * 	[2] room, the room to start in
+ * 	[3] steps, the names of the rooms walked to, in order
+ * 	[4] count, the number of steps to take
+ * 	[5] rng, the random stream
+ * ret: the room the walk ends in
+ */
+static uint32_t randomWalk(const struct Maze* maze, uint32_t room, const char** steps, size_t count,
+		struct Rng* rng) {
+	size_t i;
+
+	for(i = 0; i < count; i++) {
+		room = mazeConnections(maze, room)[rngBounded(rng, maze->degrees[room])];
+		steps[i] = mazeRoomName(maze, room);
+	}
+	return room;
+}
+
+/* Times name lookups, single moves and whole sessions in a maze
+ * args: [1] config, the settings and results file
+ * 	[2] maze, the maze to play
+ * 	[3] names, the name table of maze
+ * 	[4] samples, an empty sample list to use
+ * ret: 0 on success, 1 if memory could not be allocated or a move failed
+ */
+static int benchPlay(struct BenchConfig* config, struct Maze* maze, struct NameTable* names, struct Samples* samples) {
+	const char** steps;
+	struct Player player;
+	struct Rng rng;
+	uint32_t start = findRoomOfType(maze, START_ROOM);
+	uint32_t found = 0;
+	double begin;
+	size_t i;
+	size_t j;
+	int repeat;
+	int failed = 0;
+
+	steps = malloc(MOVES * sizeof(const char*));
+	if(steps == NULL) {
+		return 1;
+	}
+	seedRng(&rng, config->seed);
+
+	/*Lookups of random names, so most of them miss the cache */
+	for(repeat = 0; repeat < config->repeats; repeat++) {
+		for(i = 0; i < LOOKUPS; i++) {
+			steps[i] = mazeRoomName(maze, rngBounded(&rng, maze->numRooms));
+		}
+		for(i = 0; i < LOOKUPS; i += BATCH) {
+			begin = nowNs();
+			for(j = i; j < i + BATCH; j++) {
+				found ^= lookupName(names, steps[j]);
+			}
+			failed |= addSample(samples, (nowNs() - begin) / BATCH);
+		}
+	}
+	report(config, "lookup", "lookup", maze->numRooms, samples);
+
+	/*Moves along one long random walk, the way a player wanders */
+	for(repeat = 0; repeat < config->repeats && !failed; repeat++) {
+		randomWalk(maze, start, steps, MOVES, &rng);
+		failed = initPlayerInRoom(&player, maze, names, NULL, start);
+		for(i = 0; i < MOVES && !failed; i += BATCH) {
+			begin = nowNs();
+			for(j = i; j < i + BATCH; j++) {
+				failed |= movePlayer(&player, steps[j]);
+			}
+			failed |= addSample(samples, (nowNs() - begin) / BATCH);
+		}
+		freePlayer(&player);
+	}
+	report(config, "move", "move", maze->numRooms, samples);
+
+	/*Whole sessions: a new player from the START_ROOM, its moves, and the cleanup */
+	for(repeat = 0; repeat < config->repeats && !failed; repeat++) {
+		for(i = 0; i < SESSIONS; i++) {
+			randomWalk(maze, start, steps + i * SESSION_MOVES, SESSION_MOVES, &rng);
+		}
+		for(i = 0; i < SESSIONS && !failed; i++) {
+			begin = nowNs();
+			failed = initPlayerInRoom(&player, maze, names, NULL, start);
+			for(j = 0; j < SESSION_MOVES && !failed; j++) {
+				failed |= movePlayer(&player, steps[i * SESSION_MOVES + j]);
+			}
+			found ^= playerHasWon(&player);
+			freePlayer(&player);
+			failed |= addSample(samples, nowNs() - begin);
+		}
+	}
+	report(config, "session", "session", maze->numRooms, samples);
+
+	/*Keep the lookups from being optimized away */
+	if(found == NO_ROOM - 1) {
+		printf("\n");
+	}
+	free(steps);
+	return failed;
+}
+
+/* Runs every benchmark at one maze size
+ * args: [1] config, the settings and results file
+ * 	[2] rooms, the number of rooms
+ * ret: 0 on success, 1 if a benchmark failed
+ */
+static int benchSize(struct BenchConfig* config, uint32_t rooms) {
+	struct Samples samples = { NULL, 0, 0 };
+	struct RoomGraph graph;
+	struct Maze maze;
+	struct NameTable names;
+	char* storage = NULL;
+	double sample;
+	int repeat;
+	int result = 0;
+
+	/*Generate a fresh maze each repeat, and keep the last one for the rest */
+	for(repeat = 0; repeat < config->repeats; repeat++) {
+		if(repeat > 0) {
+			freeRoomGraph(&graph);
+			free(storage);
+		}
+		sample = generate(&graph, &storage, rooms, config, repeat);
+		if(sample < 0 || addSample(&samples, sample) != 0) {
+			fprintf(stderr, "Could not generate %u rooms\n", rooms);
+			return 1;
+		}
+	}
+	report(config, "generate", "room", rooms, &samples);
+
+	if(rooms <= config->textLimit) {
+		result = benchText(config, &graph, &samples);
+	}
+
+	if(result == 0 && graphToMaze(&graph, &maze) == 0) {
+		if(buildNameTable(&names, &maze) == 0) {
+			result = benchPlay(config, &maze, &names, &samples);
+			freeNameTable(&names);
+		} else {
+			result = 1;
+		}
+		closeMaze(&maze);
+	} else {
+		result = 1;
+	}
+	if(result != 0) {
+		fprintf(stderr, "Benchmarks of %u rooms failed\n", rooms);
+	}
+
+	freeRoomGraph(&graph);
+	free(storage);
+	free(samples.values);
+	return result;
+}
+
+/*Reads a comma separated list of room counts into config. Returns 0 on success, 1 on failure */
+static int parseSizes(struct BenchConfig* config, const char* list) {
+	char* end;
+	long size;
+
+	config->numSizes = 0;
+	while(*list != '\0') {
+		size = strtol(list, &end, 10);
+		if(end == list || size < 7 || size >= NO_ROOM || config->numSizes == MAX_SIZES) {
+			return 1;
+		}
+		config->sizes[config->numSizes] = size;
+		config->numSizes++;
+		list = *end == ',' ? end + 1 : end;
+		if(*end != ',' && *end != '\0') {
+			return 1;
+		}
+	}
+	return config->numSizes == 0;
+}
+
+int main(int argc, char* argv[]) {
+	struct BenchConfig config;
+	const char* outName = "chenhowa.bench.csv";
+	int opt;
+	int i;
+	int result = 0;
+
+	memset(&config, 0, sizeof(config));
+	parseSizes(&config, "1000,100000,1000000");
+	config.repeats = 5;
+	config.textLimit = 100000;
+	config.threads = 1;
+	config.seed = 1;
+
+	while((opt = getopt(argc, argv, "n:r:o:F:t:p:s:")) != -1) {
+		switch(opt) {
+			case 'n': result |= parseSizes(&config, optarg);
+			break;
+			case 'r': config.repeats = atoi(optarg);
+			break;
+			case 'o': outName = optarg;
+			break;
+			case 'F': config.json = strcmp(optarg, "json") == 0;
+				result |= !config.json && strcmp(optarg, "csv") != 0;
+			break;
+			case 't': config.textLimit = strtoul(optarg, NULL, 10);
+			break;
+			case 'p': config.threads = atoi(optarg);
+			break;
+			case 's': config.seed = strtoull(optarg, NULL, 10);
+			break;
+			default: result = 1;
+			break;
+		}
+	}
+	if(result != 0 || config.repeats < 1 || config.threads < 1) {
+		fprintf(stderr, "Usage: %s [-n sizes] [-r repeats] [-o file] [-F csv|json] [-t text limit] "
+			"[-p threads] [-s seed]\n", argv[0]);
+		return 1;
+	}
+
+	config.out = fopen(outName, "w");
+	if(config.out == NULL) {
+		fprintf(stderr, "Could not open %s\n", outName);
+		return 1;
+	}
+	if(config.json) {
+		fprintf(config.out, "[");
+	} else {
+		fprintf(config.out, "benchmark,rooms,unit,samples,median_ns,p90_ns,p99_ns,min_ns,max_ns\n");
+	}
+	printf("%-10s %8s %-8s %8s %12s %12s %12s %12s %12s\n", "benchmark", "rooms", "unit", "samples",
+		"median ns", "p90 ns", "p99 ns", "min ns", "max ns");
+
+	for(i = 0; i < config.numSizes && result == 0; i++) {
+		result = benchSize(&config, config.sizes[i]);
+	}
+
+	if(config.json) {
+		fprintf(config.out, "\n]\n");
+	}
+	fclose(config.out);
+	printf("Results written to %s\n", outName);
+	return result;
+}
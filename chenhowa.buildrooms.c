@@ -2,8 +2,30 @@
  * Author: Howard Chen
  * Date Created: 7-11-2017
  * Description: File creates room files for the Program 2 adventure game
- * Input: N/A
- * Output: 7 room files with randomly generated room names and room connections
+ * Input: optional -n <count>, the number of rooms to generate (default 7)
+ * 	optional -f <binary|text|both>, the output format (default binary)
+ * 	optional -j <threads>, the threads that verify the maze (default one per processor)
+ * 	optional -p <threads>, connect the rooms in parallel, one shard of rooms per thread
+ * 	(default 1, the serial generator)
+ * 	optional -V, print the seed and how long verification takes with 1, 2, 4, ... threads
+ * 	optional -s/--seed <number>, the random seed; the same seed and options (including
+ * 	-p) always give the same maze (default: from the clock and the process id)
+ * 	optional -d/--names <file>, a dictionary to draw room names from, one per line
+ * 	(default: 10 hard-coded names, or ROOM_<n> names for more than 10 rooms)
+ * 	optional -g/--generate-names, name the rooms ROOM_<n>; with -d, only the rooms
+ * 	the dictionary has no names left for
+ * 	optional -m/--min-degree <n> and -M/--max-degree <n>, the fewest and most
+ * 	connections a room may have (default 3 and 6). 1 <= min < max <= 255
+ * 	optional -S/--stream <MB>, generate the maze in about MB megabytes however many
+ * 	rooms it has, writing it straight to the binary maze file (see chenhowa.stream.c).
+ * 	Rooms get generated names. Not with -f text or both, -d, or -p
+ * Output: a binary maze file (see chenhowa.maze.h) and/or one text file per room,
+ * 	with randomly generated room names and room connections, in a new
+ * 	./chenhowa.rooms.<PROCESS ID> directory. ./chenhowa.latest is pointed at it.
+ * 	Nothing is written unless every room is reachable and has the minimum to
+ * 	maximum number of two-way connections. A streamed maze is checked for its
+ * 	bounds as it is written and is connected by construction; with -V it is also
+ * 	verified like any other, which takes memory for every room
  *
  *
  */
@@ -17,275 +39,431 @@
 #include <fcntl.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <getopt.h>
+
+#include "chenhowa.maze.h"
+#include "chenhowa.roomgraph.h"
+#include "chenhowa.generator.h"
+#include "chenhowa.verify.h"
+#include "chenhowa.rng.h"
+#include "chenhowa.stream.h"
 
 
-#define START_ROOM 1
-#define MID_ROOM 2
-#define END_ROOM 3
 #define NUM_ROOMS 7
 #define NUM_NAMES 10
-#define MAX_CONNECTIONS 6
-#define MIN_CONNECTIONS 3
+#define MAX_CONNECTIONS 6 /*default most connections a room may have */
+#define MIN_CONNECTIONS 3 /*default fewest connections a room may have */
+#define GENERATED_NAME_LEN 16 /*room for "ROOM_" plus a 10 digit index */
+#define FORMAT_BINARY 1 /*output flag for the binary maze file */
+#define FORMAT_TEXT 2 /*output flag for the directory of room files */
 
 
-/*Room struct to hold room data*/
-struct Room {
-	char* name;
-	struct Room* connections[MAX_CONNECTIONS]; /*Pointer to other, connected rooms */
-	int type; /*integer representing the room type */
-	int numConnections; /*Number of room's connections */
-};
-
 /*Struct for organizing the names and whether or not they've been assigned */
 struct OneToOneNameMap {
 	char** names; /*Holds an array of char* representing names */
-	int* used_names; /*array mapping each name to whether its been used */
 	int size; /*total number of names */
+	int assigned; /*names at the front of names that have been given to rooms */
+	char* storage; /*backing memory for generated or loaded names, or NULL */
 };
 
-/*Prints the data in a Room struct to a given opened FILE */
-void printRoom(FILE *file, struct Room *r) {
-	int i;
-	char* type_str;
-
-	/*Print the name of the Room, or NULL if there is no name */
-	if( r->name == NULL) {
-		fprintf(file, "NULL\n");
-	} else {
-		fprintf(file, "ROOM NAME: %s\n", r->name);
-	}
-
-	/*Print the name of the connected room, or NULL CONNECTION
- * 		if the connected room is somehow NULL */
-	for (i = 0; i < r->numConnections; i++) {
-		if(r->connections[i] == NULL) {
-			fprintf(file, "NULL CONNECTION\n");
-		} else {
-			fprintf(file, "CONNECTION %i: %s\n", i + 1, r->connections[i]->name);
-		}
-	}
-	
-	/*If a room type has been assigned, print it to console */
-	switch (r->type) {
-		case 1: type_str = "START_ROOM";
-		break;
-		case 2: type_str = "MID_ROOM";
-		break;
-		case 3: type_str = "END_ROOM";
-		break;
-		default: type_str = "UNASSIGNED_ROOM";
-		break;
-	}
-	fprintf(file, "ROOM TYPE: %s\n", type_str);
-
-	/*flush the output to the file */
-	fflush(file);
-}
-
 /*Simple function for printing out a OneToOneNameMap to ensure that
  * unique names were assigned randomly */
 void printNameMap(struct OneToOneNameMap* map) {
 	int i;
 	for(i = 0; i < map->size; i++) {
-		printf("Name %i: %s; Used: %i\n", i + 1, map->names[i], map->used_names[i]);
+		printf("Name %i: %s; Used: %i\n", i + 1, map->names[i], i < map->assigned);
 
 	}
 
 }
 
-/* Assigns random names from a OneToOneNameMap to an array of rooms
- * Arguments: [1} rooms, an array of Room structs
- * 		[2] count, the number of Rooms
+/* Assigns random names from a OneToOneNameMap to an array of rooms, with a
+ * 	partial Fisher-Yates shuffle: each room swaps a random unassigned name to the
+ * 	front of the map, so every room costs one random draw however full the map gets
+ * Arguments: [1} rooms, the name of each room to be named
+ * 		[2] count, the number of rooms
  * 		[3] name_map, holds the names to assign
- * Pre: There should be at least as many names as their are rooms
- * pre: Both the rooms and the map should be initialized with their respective init functions
- * post: random names will have been assigned the rooms. Each Room struct will have a pointer
- * 	to its name
+ * 		[4] rng, the random stream to draw from
+ * Pre: There should be at least as many unassigned names as their are rooms
+ * pre: The map should be initialized with its init function
+ * post: random names will have been assigned the rooms. Each room will have a pointer
+ * 	to its name. The assigned names are moved to the front of name_map->names
  * ret: none
  *
  */
-void assignRandomNames(struct Room* rooms, int count, struct OneToOneNameMap* name_map) {
-	/*For every room in rooms, generate a random index that referes to a name*/
+void assignRandomNames(char** rooms, int count, struct OneToOneNameMap* name_map, struct Rng* rng) {
 	int i;
+	int name_index;
+	char* name;
+
+	/*Names before name_map->assigned are taken; pick one of the rest and swap it into place */
 	for(i = 0; i < count; i++) {
-		int unassigned = 1;
-		while(unassigned == 1) {
-			/*Get a random name */
-			int name_index = rand() % name_map->size;
-			/*If that name is unused, point the current room to it, and continue
- * 			to the next room. Otherwise, try again for the same room*/
-			if(name_map->used_names[name_index] == 0) {
-				name_map->used_names[name_index] = 1;
-				rooms[i].name = name_map->names[name_index];
-				unassigned = 0;
-			}
-		}
-	}	
+		name_index = name_map->assigned + rngBounded(rng, name_map->size - name_map->assigned);
+		name = name_map->names[name_index];
+		name_map->names[name_index] = name_map->names[name_map->assigned];
+		name_map->names[name_map->assigned] = name;
+		name_map->assigned++;
+		rooms[i] = name;
+	}
 }
 
-/* Assigns random room types to an array of rooms
- * Arguments: [1] rooms, an array of Room structs
- * 		[2] count, the number of Rooms
- * pre: rooms should be initialized with their init function
- * post: rooms will have been assigned random room types. Exactly 1 room will  be a 
- * 	START_ROOM. Exactly 1 room will be an END_ROOM
- * ret: none
- *
+/*Frees the memory held by a OneToOneNameMap from initGeneratedNameMap or loadNameMap */
+void freeNameMap(struct OneToOneNameMap* map) {
+	free(map->names);
+	free(map->storage);
+	map->names = NULL;
+	map->storage = NULL;
+	map->size = 0;
+	map->assigned = 0;
+}
+
+/* Fills a OneToOneNameMap with generated names of the form ROOM_<n>, for
+ * mazes that need more rooms than there are names to pick from
+ * Args: [1] map, the OneToOneNameMap to fill in
+ *	[2] count, the number of names to generate
+ * post: map must be freed with freeNameMap
+ * ret: 0 on success, 1 if memory could not be allocated
  */
-void assignRandomTypes(struct Room* rooms, int count) {
+int initGeneratedNameMap(struct OneToOneNameMap* map, int count) {
 	int i;
-	int startRoom = -1;
-	int endRoom = -1;
 
-	/*Every room execpt the start room and end room must be MID_ROOMs.
-		So assign the midrooms first, and 
-		then randomly generate two different indices to be
-		START_ROOM and END_ROOM */
-	for(i = 0; i < count; i++) {
-		rooms[i].type = 2;
+	map->names = malloc(count * sizeof(char*));
+	map->storage = malloc((size_t)count * GENERATED_NAME_LEN + 1);
+	map->size = count;
+	map->assigned = 0;
+	if(map->names == NULL || map->storage == NULL) {
+		freeNameMap(map);
+		return 1;
 	}
 
-	startRoom = rand() % count;
-	do {
-		endRoom = rand() % count;
-
-	} while(endRoom == startRoom);
-
-	rooms[startRoom].type = 1;
-	rooms[endRoom].type = 3;
-}
-
-/* Determines whether or not a graph is full 
- * Args: [1] rooms, an array of Room structs
- *	[2] count, the number of rooms
- * pre: rooms should be initialized properly
- * post: may panic if a room has more than MAX_CONNECTION connections
- * ret: 0 if any room has fewer than MIN_CONNECTIONS
- * 	1 if every room has at least MIN_CONNECTIONS, but no more than MAX_CONNECTIONS
- */     
-int graphIsFull(struct Room* rooms, int count) {
-	int i;
 	for(i = 0; i < count; i++) {
-		assert(rooms[i].numConnections <= MAX_CONNECTIONS);
-		if(rooms[i].numConnections < MIN_CONNECTIONS) {
-			return 0;
-		}	
+		map->names[i] = map->storage + (size_t)i * GENERATED_NAME_LEN;
+		sprintf(map->names[i], "ROOM_%i", i + 1);
 	}
-	return 1;
 
+	return 0;
 }
 
+/* Fills a OneToOneNameMap with the names in a dictionary file, one name per line
+ * Args: [1] map, the OneToOneNameMap to fill in
+ *	[2] path, the dictionary file. Blank lines are skipped, and a trailing \r is dropped
+ * post: map must be freed with freeNameMap. The names point into map->storage
+ * ret: 0 on success, 1 if the file could not be read, memory could not be
+ * 	allocated, or a line can't be a room name
+ */
+int loadNameMap(struct OneToOneNameMap* map, const char* path) {
+	struct stat info;
+	char* line;
+	char* end;
+	char* limit;
+	ssize_t got;
+	size_t total = 0;
+	size_t length;
+	int lines = 1;
+	int lineNumber;
+	int fd;
+
+	map->names = NULL;
+	map->size = 0;
+	map->assigned = 0;
+	map->storage = NULL;
+
+	/*Read the whole file at once; the names are cut out of it in place */
+	fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		fprintf(stderr, "Could not open the name dictionary %s\n", path);
+		return 1;
+	}
+	if(fstat(fd, &info) != 0 || (map->storage = malloc(info.st_size + 1)) == NULL) {
+		fprintf(stderr, "Could not read the name dictionary %s\n", path);
+		close(fd);
+		return 1;
+	}
+	while(total < (size_t)info.st_size
+			&& (got = read(fd, map->storage + total, info.st_size - total)) > 0) {
+		total += got;
+	}
+	close(fd);
+	limit = map->storage + total;
+	*limit = '\0';
 
-/*Returns a pointer to a random existing room*/
-struct Room* getRandomRoom(struct Room* rooms, int count) {
-	int room_index = rand() % count;
-
-	return rooms + room_index;
-}
-
-/*Returns true if a room has fewer than MAX_CONNECTIONS
- * Returns false otherwise */
-int canAddConnectionFrom(struct Room* room) {
-	return room->numConnections < MAX_CONNECTIONS;
-}
+	/*Count the lines, to size the name array */
+	for(line = map->storage; (end = memchr(line, '\n', limit - line)) != NULL; line = end + 1) {
+		lines++;
+	}
+	map->names = malloc(lines * sizeof(char*));
+	if(map->names == NULL) {
+		fprintf(stderr, "Could not allocate %i names\n", lines);
+		freeNameMap(map);
+		return 1;
+	}
 
-/*Creates a one-way connection between two rooms, and updates the
- * numConnections of the source room*/
-/*WARNING: Does not check if this connection is legal
- * Use canAddConnectionFrom to check beforehand*/
-void connectRoom(struct Room* x, struct Room* y) {
-	x->connections[x->numConnections] = y;	
-	x->numConnections++;
-}
+	/*Cut each line into a name, and check it is usable */
+	lineNumber = 0;
+	for(line = map->storage; line < limit; line = end + 1) {
+		lineNumber++;
+		end = memchr(line, '\n', limit - line);
+		if(end == NULL) {
+			end = limit;
+		}
+		*end = '\0';
+		length = end - line;
+		if(length > 0 && line[length - 1] == '\r') {
+			length--;
+			line[length] = '\0';
+		}
+		if(length == 0) {
+			continue;
+		}
+		if(!isRoomName(line, length)) {
+			fprintf(stderr, "%s:%i: \"%s\" can't be a room name\n", path, lineNumber, line);
+			freeNameMap(map);
+			return 1;
+		}
+		map->names[map->size] = line;
+		map->size++;
+	}
 
-/*Returns 1 if two room pointers are pointing at the same room
- * Otherwise returns 0 */
-int isSameRoom(struct Room* x, struct Room* y) {
-	return x == y;
+	return 0;
 }
 
-/*Returns 1 if x has no one-way connection to y
- * Otherwise returns 0*/
-int unconnected(struct Room* x, struct Room* y ) {
+/*Names every room from the front of a generated OneToOneNameMap. Generated names
+ * are unique by construction, so no random draws are needed */
+void assignGeneratedNames(char** rooms, int count, struct OneToOneNameMap* name_map) {
 	int i;
 
-	/*Scan all of x's connectiosn and compare them to y */
-	for(i = 0; i < x->numConnections; i++) {
-		if(x->connections[i] == y) {
-			return 0;
-		}
+	for(i = 0; i < count; i++) {
+		rooms[i] = name_map->names[name_map->assigned];
+		name_map->assigned++;
 	}
+}
 
-	return 1;
+/* Points the LATEST_LINK_NAME symlink at a rooms directory
+ * Args: [1] target, the name of the rooms directory, relative to the current directory
+ * post: the link is replaced atomically: a new link is made under a temporary name
+ * 	and renamed over the old one, so readers see either the old or the new target
+ * ret: 0 on success, 1 if the link could not be made
+ */
+int updateLatestLink(const char* target) {
+	char tempName[64];
 
+	sprintf(tempName, "%s.%i", LATEST_LINK_NAME, (int)getpid());
+	unlink(tempName);
+	if(symlink(target, tempName) != 0) {
+		fprintf(stderr, "Could not create %s\n", tempName);
+		return 1;
+	}
+	if(rename(tempName, LATEST_LINK_NAME) != 0) {
+		fprintf(stderr, "Could not update %s\n", LATEST_LINK_NAME);
+		unlink(tempName);
+		return 1;
+	}
+	return 0;
 }
 
-/* Adds a random connection between two Rooms in an array of rooms
- * Args: [1] rooms, an array of Room structs
- *	[2] count, the number of Room structs in the array
- * pre: all rooms should be initialized
- * post: the rooms will have random connections such that the graph is full:
- * 	that is, every room has a valid number of connections to other rooms,
- * 	between MIN_CONNECTIONS and MAX_CONNECTIONS, inclusive
- * ret: nont
- *
+/* Verifies a generated maze: every room has minDegree to maxDegree connections,
+ * 	every connection goes both ways, and every room can be reached from the START_ROOM
+ * Args: [1] maze, the finished maze
+ * 	[2] minDegree, [3] maxDegree, the degree bounds it was generated with
+ * 	[4] threads, the number of threads to verify with
+ * 	[5] report, 1 to print the verification time for 1, 2, 4, ... up to threads threads
+ * ret: 0 if the maze is valid, 1 if it isn't or it could not be verified
  */
-void addRandomConnection(struct Room* rooms, int count) {
-	struct Room* x;
-	struct Room* y;
-
-	/*First, get a random room that can still add a connection */
-	while(1) {
-		x = getRandomRoom(rooms, count);
-		
-		if(canAddConnectionFrom(x) == 1 ) {
+int validateMaze(const struct Maze* maze, int minDegree, int maxDegree, int threads, int report) {
+	struct MazeCheck check;
+	double oneThread = 0;
+	int count;
+
+	if(verifyMaze(maze, minDegree, maxDegree, threads, &check) != 0) {
+		return 1;
+	}
+	if(!mazeIsValid(maze, &check)) {
+		fprintf(stderr, "Generated maze is invalid: %llu rooms with a bad degree, %llu bad connections, "
+			"%llu one-way connections, %llu of %u rooms reachable\n", (unsigned long long)check.badDegrees,
+			(unsigned long long)check.badLinks, (unsigned long long)check.oneWayLinks, (unsigned long long)check.reached, maze->numRooms);
+		return 1;
+	}
+	if(!report) {
+		return 0;
+	}
+
+	printf("verified %u rooms: degrees %i..%i, symmetric, connected in %u levels\n",
+		maze->numRooms, minDegree, maxDegree, check.levels);
+	printf("%8s %12s %12s %9s %10s %10s\n", "threads", "degree ms", "bfs ms", "speedup", "top-down", "bottom-up");
+	for(count = 1; ; count *= 2) {
+		if(count > threads) {
+			count = threads;
+		}
+		if(verifyMaze(maze, minDegree, maxDegree, count, &check) != 0) {
+			return 1;
+		}
+		if(count == 1) {
+			oneThread = check.bfsSeconds;
+		}
+		printf("%8i %12.3f %12.3f %9.2f %10u %10u\n", count, check.degreeSeconds * 1e3,
+			check.bfsSeconds * 1e3, check.bfsSeconds > 0 ? oneThread / check.bfsSeconds : 0.0,
+			check.topDownLevels, check.bottomUpLevels);
+		if(count == threads) {
 			break;
 		}
 	}
+	return 0;
+}
 
-	/*Second, get a random room, different from the first one, that
- * 	can add a connection */
-	do {
-		y = getRandomRoom(rooms, count);
-
-	} while(canAddConnectionFrom(y) == 0 || isSameRoom(x, y) == 1);
+/* Generates a maze with the streaming generator, into a new rooms directory
+ * Args: [1] numRooms, the number of rooms
+ * 	[2] minDegree, [3] maxDegree, the degree bounds
+ * 	[4] memory, the memory budget in bytes
+ * 	[5] threads, the number of threads to verify with
+ * 	[6] report, 1 to print what streaming took, and to verify the finished maze
+ * 	[7] rng, the seeded random stream
+ * post: on success the directory holds only the binary maze file, and the latest
+ * 	link points at it. On failure the directory is removed
+ * ret: 0 on success, 1 on error
+ */
+int streamRooms(int numRooms, int minDegree, int maxDegree, size_t memory, int threads, int report, struct Rng* rng) {
+	struct Maze maze;
+	char dirname[64];
+	char fileName[128];
+	int result;
 
-	/*Now that we have two random rooms, connect them if they haven't been connected before*/
-	if( unconnected(x, y) && unconnected(y, x) ) {
-		connectRoom(x, y);
-		connectRoom(y, x);
+	sprintf(dirname, "%s%i", ROOMS_DIR_PREFIX, (int)getpid());
+	if(mkdir(dirname, 0755) != 0) {
+		fprintf(stderr, "Directory creation failed!\n");
+		return 1;
+	}
+	sprintf(fileName, "%s/%s", dirname, MAZE_FILE_NAME);
+
+	result = streamMaze(fileName, numRooms, minDegree, maxDegree, memory, rng, report);
+	if(result == 0 && report) {
+		result = openMaze(&maze, fileName);
+		if(result == 0) {
+			result = validateMaze(&maze, minDegree, maxDegree, threads, report);
+			closeMaze(&maze);
+		}
+		if(result != 0) {
+			unlink(fileName);
+		}
+	}
+	if(result != 0) {
+		rmdir(dirname);
+		return 1;
 	}
 
+	return updateLatestLink(dirname);
 }
 
-/*Initializes a room struct to valid starting values */
-void initRoom(struct Room *room) {
-		int i;
-
-		room->name = NULL;
-		room->type = -1;
-		room->numConnections = 0;
-		for(i = 0; i < MAX_CONNECTIONS; i++) {
-			room->connections[i] = NULL;
-		}
+/*Prints the command line options */
+static void printUsage(const char* program) {
+	fprintf(stderr, "Usage: %s [-n rooms] [-f binary|text|both] [-j threads] [-V] [-s seed] [-p threads] "
+		"[-d names file] [-g] [-m min degree] [-M max degree] [-S memory MB]\n", program);
 }
 
-
-int main() {
-	int used_names[NUM_NAMES];
+int main(int argc, char* argv[]) {
 	char* names[NUM_NAMES];
-	int i;
 	struct OneToOneNameMap map;
-	struct Room rooms[NUM_ROOMS];
+	struct OneToOneNameMap generated; /*ROOM_<n> names for rooms the map can't name */
+	const char* dictionary = NULL; /*file to load room names from */
+	int generateNames = 0; /*whether rooms without a picked name get ROOM_<n> */
+	int numPicked; /*rooms named from map, rather than generated */
+	struct RoomGraph graph; /*the rooms and their connections */
+	int numRooms = NUM_ROOMS;
+	int minDegree = MIN_CONNECTIONS; /*fewest connections a room may have */
+	int maxDegree = MAX_CONNECTIONS; /*most connections a room may have */
+	int formats = FORMAT_BINARY;
+	int threads = sysconf(_SC_NPROCESSORS_ONLN); /*threads that verify the maze */
+	int reportValidation = 0; /*whether to print how verification scales */
+	int genThreads = 1; /*threads that connect the rooms */
+	long streamMemory = 0; /*memory budget in MB for the streaming generator, or 0 */
+	uint64_t seed = defaultSeed(); /*seed of the random stream */
+	struct Rng rng; /*random stream every random choice is drawn from */
+	static struct option longOptions[] = {
+		{ "seed", required_argument, NULL, 's' },
+		{ "names", required_argument, NULL, 'd' },
+		{ "generate-names", no_argument, NULL, 'g' },
+		{ "min-degree", required_argument, NULL, 'm' },
+		{ "max-degree", required_argument, NULL, 'M' },
+		{ "stream", required_argument, NULL, 'S' },
+		{ NULL, 0, NULL, 0 }
+	};
+	struct Maze maze;
+	int opt;
 	int pid;
 	int result;
-	FILE* fd;
 	char dirname[1000];
 	char roomDescription[2000];
 	memset(dirname, 0, sizeof(dirname)); /*zero out the directory name array*/
 	memset(roomDescription, 0, sizeof(roomDescription));
 
-	srand(time(NULL));
+	/*Read the number of rooms to generate, if one was given */
+	while((opt = getopt_long(argc, argv, "n:f:j:Vs:p:d:gm:M:S:", longOptions, NULL)) != -1) {
+		switch(opt) {
+			case 'n': numRooms = atoi(optarg);
+			break;
+			case 'f':
+				if(strcmp(optarg, "binary") == 0) {
+					formats = FORMAT_BINARY;
+				} else if(strcmp(optarg, "text") == 0) {
+					formats = FORMAT_TEXT;
+				} else if(strcmp(optarg, "both") == 0) {
+					formats = FORMAT_BINARY | FORMAT_TEXT;
+				} else {
+					fprintf(stderr, "Unknown format %s\n", optarg);
+					return 1;
+				}
+			break;
+			case 'j': threads = atoi(optarg);
+			break;
+			case 'V': reportValidation = 1;
+			break;
+			case 's': seed = strtoull(optarg, NULL, 0);
+			break;
+			case 'p': genThreads = atoi(optarg);
+			break;
+			case 'd': dictionary = optarg;
+			break;
+			case 'g': generateNames = 1;
+			break;
+			case 'm': minDegree = atoi(optarg);
+			break;
+			case 'M': maxDegree = atoi(optarg);
+			break;
+			case 'S': streamMemory = atol(optarg);
+			break;
+			default:
+				printUsage(argv[0]);
+				return 1;
+		}
+	}
+
+	/*Every room needs minDegree distinct neighbors */
+	if(numRooms < 0) {
+		printUsage(argv[0]);
+		return 1;
+	}
+	if(checkDegreeBounds(numRooms, minDegree, maxDegree) != 0) {
+		return 1;
+	}
+
+	if(streamMemory != 0 && (formats != FORMAT_BINARY || dictionary != NULL || genThreads > 1)) {
+		fprintf(stderr, "--stream only writes a binary maze with generated names, from one thread\n");
+		return 1;
+	}
+	if(streamMemory != 0 && streamMemory < MIN_STREAM_MEMORY >> 20) {
+		fprintf(stderr, "--stream needs at least %i MB\n", MIN_STREAM_MEMORY >> 20);
+		return 1;
+	}
+
+	seedRng(&rng, seed);
+	if(reportValidation) {
+		printf("seed: %llu\n", (unsigned long long)seed);
+	}
+
+	/*A streamed maze never has every room in memory at once, so it skips the RoomGraph */
+	if(streamMemory != 0) {
+		return streamRooms(numRooms, minDegree, maxDegree, (size_t)streamMemory << 20, threads,
+			reportValidation, &rng);
+	}
 
 	/*Create an array of hard-coded room names*/
 	names[0] = "FOYER";
@@ -299,31 +477,65 @@ int main() {
 	names[8] = "DINING_ROOM";
 	names[9] = "PRISON_CELL";
 
-	/*Create array to store whether a name has been used*/
-	for(i = 0; i < NUM_NAMES; i++) {
-		used_names[i] = 0;
+	/*Pick names from the dictionary, or the hard-coded names. Without a dictionary,
+ * 	more rooms than hard-coded names are all given generated names */
+	if(dictionary != NULL) {
+		if(loadNameMap(&map, dictionary) != 0) {
+			return 1;
+		}
+	} else {
+		map.names = names;
+		map.size = NUM_NAMES;
+		map.assigned = 0;
+		map.storage = NULL;
+		if(numRooms > NUM_NAMES) {
+			generateNames = 1;
+		}
+	}
+	if(generateNames && dictionary == NULL) {
+		map.size = 0;
+	}
+	numPicked = numRooms < map.size ? numRooms : map.size;
+	if(numPicked < numRooms && !generateNames) {
+		fprintf(stderr, "%s has only %i names for %i rooms; use -g to generate the rest\n",
+			dictionary, map.size, numRooms);
+		return 1;
+	}
+	generated.names = NULL;
+	generated.storage = NULL;
+	if(numPicked < numRooms && initGeneratedNameMap(&generated, numRooms - numPicked) != 0) {
+		fprintf(stderr, "Could not allocate names for %i rooms\n", numRooms - numPicked);
+		return 1;
 	}
 
-	/*store these data structures in a OneToOneMap*/
-	map.names = names;
-	map.used_names = used_names; 
-	map.size = NUM_NAMES;
-
-	/* Create an array of 7 rooms, initialize each of them*/
-	for(i = 0; i < NUM_ROOMS; i++) {
-		initRoom(rooms + i);	
-	}		
+	/* Create the graph of rooms, with no connections yet*/
+	if(initRoomGraph(&graph, numRooms, minDegree, maxDegree) != 0) {
+		fprintf(stderr, "Could not allocate %i rooms\n", numRooms);
+		return 1;
+	}
 
-	/*Assign the rooms random names */
-	assignRandomNames(rooms, NUM_ROOMS, &map);
+	/*Assign the rooms random names, then generated names to the rest */
+	assignRandomNames(graph.names, numPicked, &map, &rng);
+	assignGeneratedNames(graph.names + numPicked, numRooms - numPicked, &generated);
 
 	/*Assign the rooms random types*/
-	assignRandomTypes(rooms, NUM_ROOMS);
+	assignRandomTypes(&graph, &rng);
 
-	/*while the graph of Rooms isn't full, randomly connect a new pair of rooms
- * 		if it is valid to do so */
-	while( graphIsFull(rooms, NUM_ROOMS) == 0) {
-		addRandomConnection(rooms, NUM_ROOMS);
+	/*Connect the rooms, serially or one shard per thread */
+	if(connectRandomRooms(&graph, genThreads, &rng) != 0) {
+		fprintf(stderr, "Could not connect the rooms\n");
+		return 1;
+	}
+	assert(graphIsFull(&graph) == 1);
+
+	/*Turn the rooms into a maze, and make sure it is connected and within bounds.
+ * 	Sorting its names finds any name a dictionary repeats, or one it shares with a generated room */
+	if(graphToMaze(&graph, &maze) != 0) {
+		fprintf(stderr, "Could not build the maze file\n");
+		return 1;
+	}
+	if(validateMaze(&maze, minDegree, maxDegree, threads, reportValidation) != 0) {
+		return 1;
 	}
 
 
@@ -339,26 +551,37 @@ int main() {
 	}
 
 
-	/*For each of the NUM_ROOM rooms, create and open a file named after the room
-  		and write the contents of the room to a file within the new directory*/
-	for(i = 0; i < NUM_ROOMS; i++) {
-		memset(dirname, 0, sizeof(dirname)); /*zero out the directory name array*/
-		sprintf(dirname, "./chenhowa.rooms.%i/%s", pid, rooms[i].name);
-		fd = fopen(dirname, "w");
+	/*Write every room into a single binary maze file in the new directory */
+	if(formats & FORMAT_BINARY) {
+		sprintf(dirname, "./chenhowa.rooms.%i/%s", pid, MAZE_FILE_NAME);
+		if(writeMaze(&maze, dirname) != 0) {
+			return 1;
+		}
+	}
 
-		if(!fd) {
-			fprintf(stderr, "Could not open %s\n", dirname);
+	/*For each of the rooms, create a file named after the room
+  		and write the contents of the room to it within the new directory*/
+	if(formats & FORMAT_TEXT) {
+		sprintf(dirname, "./chenhowa.rooms.%i", pid);
+		if(writeRoomFiles(dirname, &graph) != 0) {
 			return 1;
 		}
-		
-		printRoom(fd, rooms + i);
+	}
 
-		/*When finished, close the file */
-		fclose(fd);
+	/*Point the latest link at the finished directory, so the game can find it
+ * 	without scanning every rooms directory */
+	sprintf(dirname, "%s%i", ROOMS_DIR_PREFIX, pid);
+	if(updateLatestLink(dirname) != 0) {
+		return 1;
 	}
 
 	/*Done! */
-
+	closeMaze(&maze);
+	freeRoomGraph(&graph);
+	if(map.storage != NULL) {
+		freeNameMap(&map);
+	}
+	freeNameMap(&generated);
 
 	return 0;
 }
@@ -0,0 +1,832 @@
+/* Filename: chenhowa.edit.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Incremental edits to a maze in a rooms directory.
+ *
+ * 	An edit reads only the rooms it names, plus the neighbours it has to
+ * 	change, into a small RoomGraph, and checks the degree bounds there. On
+ * 	commit, each changed room's file is rewritten and each removed room's file
+ * 	deleted. In the binary maze file, rooms are found by a binary search of its
+ * 	name index, and each changed room's type, degree and link block are written
+ * 	where they are, with pwrite; a room that gains connections gets a new link
+ * 	block appended to the end of the file, where links is the last array. So an
+ * 	edit costs O(changed rooms), however big the maze.
+ * 	The edit holds an exclusive flock on the file, which every reader waits
+ * 	out, so none sees a room half written. If a reader already has the file
+ * 	mapped, the file is copied to maze.bin.new instead, the copy is patched,
+ * 	and then renamed over the original, which costs O(rooms). Only adding or
+ * 	removing a room changes the size of the per-room arrays, so only then is
+ * 	the binary maze repacked as a whole.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "chenhowa.edit.h"
+#include "chenhowa.loader.h"
+
+#define EDIT_CAPACITY 64 /*rooms a new edit has space for */
+#define FILE_LEN 4096 /*initial size of the buffer a room file is read into */
+
+/*Doubles the space an edit has for rooms. Returns 0 on success, 1 if memory ran out */
+static int growRooms(struct MazeEdit* edit) {
+	struct RoomGraph* rooms = &edit->rooms;
+	uint32_t capacity = 2 * edit->capacity;
+	void* grown[7];
+	int i;
+
+	grown[0] = realloc(rooms->names, (capacity + 1) * sizeof(char*));
+	grown[1] = realloc(rooms->types, capacity + 1);
+	grown[2] = realloc(rooms->degrees, capacity + 1);
+	grown[3] = realloc(rooms->links, ((size_t)capacity * rooms->maxDegree + 1) * sizeof(uint32_t));
+	grown[4] = realloc(edit->states, capacity);
+	grown[5] = realloc(edit->dirty, capacity);
+	grown[6] = realloc(edit->indices, capacity * sizeof(uint32_t));
+
+	/*Keep whichever arrays did grow, so nothing is lost if another failed */
+	if(grown[0] != NULL) rooms->names = grown[0];
+	if(grown[1] != NULL) rooms->types = grown[1];
+	if(grown[2] != NULL) rooms->degrees = grown[2];
+	if(grown[3] != NULL) rooms->links = grown[3];
+	if(grown[4] != NULL) edit->states = grown[4];
+	if(grown[5] != NULL) edit->dirty = grown[5];
+	if(grown[6] != NULL) edit->indices = grown[6];
+	for(i = 0; i < 7; i++) {
+		if(grown[i] == NULL) {
+			return 1;
+		}
+	}
+	edit->capacity = capacity;
+	return 0;
+}
+
+/*Returns the edit's room with the given name, or NO_ROOM if it has none */
+static uint32_t findRoom(const struct MazeEdit* edit, const char* name) {
+	uint32_t i;
+
+	for(i = 0; i < edit->rooms.numRooms; i++) {
+		if(strcmp(edit->rooms.names[i], name) == 0) {
+			return i;
+		}
+	}
+	return NO_ROOM;
+}
+
+/* Adds a room the edit knows only the name of
+ * args: [1] edit, the MazeEdit
+ * 	[2] name, the room's name, which is copied
+ * 	[3] index, the room's index in the binary maze, or NO_ROOM
+ * ret: the new room, or NO_ROOM if memory could not be allocated
+ */
+static uint32_t addStub(struct MazeEdit* edit, const char* name, uint32_t index) {
+	uint32_t room = edit->rooms.numRooms;
+	size_t length = strlen(name) + 1;
+
+	if(room == edit->capacity && growRooms(edit) != 0) {
+		return NO_ROOM;
+	}
+	edit->rooms.names[room] = malloc(length);
+	if(edit->rooms.names[room] == NULL) {
+		return NO_ROOM;
+	}
+	memcpy(edit->rooms.names[room], name, length);
+	edit->rooms.types[room] = 0;
+	edit->rooms.degrees[room] = 0;
+	edit->states[room] = EDIT_STUB;
+	edit->dirty[room] = 0;
+	edit->indices[room] = index;
+	edit->rooms.numRooms++;
+	return room;
+}
+
+/*Returns the edit's room with the given name, adding it as a stub if it is new, or NO_ROOM if memory ran out */
+static uint32_t stubRoom(struct MazeEdit* edit, const char* name, uint32_t index) {
+	uint32_t room = findRoom(edit, name);
+
+	return room != NO_ROOM ? room : addStub(edit, name, index);
+}
+
+/*Reads a whole room file into a growing buffer. Returns its length, or -1 if it could not be read */
+static ssize_t readFile(int fd, char** buffer, size_t* size) {
+	size_t length = 0;
+	ssize_t result;
+	char* grown;
+
+	while(1) {
+		if(length == *size) {
+			grown = realloc(*buffer, *size ? 2 * *size : FILE_LEN);
+			if(grown == NULL) {
+				return -1;
+			}
+			*buffer = grown;
+			*size = *size ? 2 * *size : FILE_LEN;
+		}
+		result = read(fd, *buffer + length, *size - length);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result <= 0) {
+			return result < 0 ? -1 : (ssize_t)length;
+		}
+		length += result;
+	}
+}
+
+/* Reads a room's type and connections from its room file
+ * args: [1] edit, the MazeEdit
+ * 	[2] room, a stub of the edit
+ * post: every connection of the room is a room of the edit, and linked to from room
+ * ret: 0 on success, 1 if the file is missing or bad (a message is printed),
+ * 	or memory could not be allocated
+ */
+static int loadTextRoom(struct MazeEdit* edit, uint32_t room) {
+	struct MazeBuilder builder;
+	char* text = NULL;
+	size_t size = 0;
+	ssize_t length;
+	uint32_t other;
+	int fd;
+	int i;
+	int result = 0;
+
+	fd = openat(edit->dirFd, edit->rooms.names[room], O_RDONLY);
+	if(fd < 0) {
+		fprintf(stderr, "Error. There is no room named %s\n", edit->rooms.names[room]);
+		return 1;
+	}
+	length = readFile(fd, &text, &size);
+	close(fd);
+
+	initMazeBuilder(&builder);
+	if(length < 0 || parseRoom(text, length, edit->rooms.names[room], &builder) != 0) {
+		fprintf(stderr, "Error. Couldn't read room file %s/%s\n", edit->dirName, edit->rooms.names[room]);
+		result = 1;
+	} else if(builder.degrees[0] > edit->rooms.maxDegree) {
+		fprintf(stderr, "Error. %s already has %i connections, more than %i\n", edit->rooms.names[room],
+			builder.degrees[0], edit->rooms.maxDegree);
+		result = 1;
+	} else {
+		edit->rooms.types[room] = builder.types[0];
+		for(i = 0; i < builder.degrees[0] && result == 0; i++) {
+			other = stubRoom(edit, builder.text + builder.connections[i], NO_ROOM);
+			if(other == NO_ROOM) {
+				result = 1;
+			} else {
+				connectRoom(&edit->rooms, room, other);
+			}
+		}
+	}
+
+	freeMazeBuilder(&builder);
+	free(text);
+	return result;
+}
+
+/* Reads a room's type and connections from the binary maze
+ * args: [1] edit, the MazeEdit
+ * 	[2] room, a stub of the edit
+ * post: every connection of the room is a room of the edit, and linked to from room
+ * ret: 0 on success, 1 if the maze has no such room (a message is printed),
+ * 	or memory could not be allocated
+ */
+static int loadBinaryRoom(struct MazeEdit* edit, uint32_t room) {
+	const struct Maze* maze = &edit->maze;
+	uint32_t index = edit->indices[room];
+	uint32_t other;
+	int i;
+
+	if(index == NO_ROOM) {
+		index = findMazeRoom(maze, edit->rooms.names[room]);
+		edit->indices[room] = index;
+	}
+	if(index == NO_ROOM) {
+		fprintf(stderr, "Error. There is no room named %s\n", edit->rooms.names[room]);
+		return 1;
+	}
+	if(!mazeRoomFits(maze, index)) {
+		fprintf(stderr, "Error. Room %s of %s/%s is damaged\n", edit->rooms.names[room], edit->dirName,
+			MAZE_FILE_NAME);
+		return 1;
+	}
+	if(maze->degrees[index] > edit->rooms.maxDegree) {
+		fprintf(stderr, "Error. %s already has %i connections, more than %i\n", edit->rooms.names[room],
+			maze->degrees[index], edit->rooms.maxDegree);
+		return 1;
+	}
+
+	edit->rooms.types[room] = maze->types[index];
+	for(i = 0; i < maze->degrees[index]; i++) {
+		other = mazeConnections(maze, index)[i];
+		if(!mazeRoomFits(maze, other)) {
+			fprintf(stderr, "Error. A neighbour of %s in %s/%s is damaged\n", edit->rooms.names[room],
+				edit->dirName, MAZE_FILE_NAME);
+			return 1;
+		}
+		other = stubRoom(edit, mazeRoomName(maze, other), other);
+		if(other == NO_ROOM) {
+			return 1;
+		}
+		connectRoom(&edit->rooms, room, other);
+	}
+	return 0;
+}
+
+/* Makes sure the edit has read a room's type and connections
+ * args: [1] edit, the MazeEdit
+ * 	[2] room, a room of the edit
+ * ret: 0 on success, 1 if the room does not exist or could not be read
+ */
+static int loadRoom(struct MazeEdit* edit, uint32_t room) {
+	int result;
+
+	if(edit->states[room] == EDIT_REMOVED) {
+		fprintf(stderr, "Error. %s has been removed\n", edit->rooms.names[room]);
+		return 1;
+	}
+	if(edit->states[room] != EDIT_STUB) {
+		return 0;
+	}
+	if(edit->hasBinary) {
+		result = loadBinaryRoom(edit, room);
+	} else {
+		result = loadTextRoom(edit, room);
+	}
+	if(result == 0) {
+		edit->states[room] = EDIT_LOADED;
+	}
+	return result;
+}
+
+/*Returns the edit's room with the given name, after reading it, or NO_ROOM if it
+ * does not exist or could not be read */
+static uint32_t getRoom(struct MazeEdit* edit, const char* name) {
+	uint32_t room = stubRoom(edit, name, NO_ROOM);
+
+	if(room == NO_ROOM) {
+		fprintf(stderr, "Error. Couldn't allocate room %s\n", name);
+		return NO_ROOM;
+	}
+	return loadRoom(edit, room) == 0 ? room : NO_ROOM;
+}
+
+/*Returns 1 if the maze already has a room with the given name, whether or not the edit has read it */
+static int roomExists(struct MazeEdit* edit, const char* name) {
+	if(findRoom(edit, name) != NO_ROOM) {
+		return 1;
+	}
+	if(edit->hasBinary) {
+		return findMazeRoom(&edit->maze, name) != NO_ROOM;
+	}
+	return faccessat(edit->dirFd, name, F_OK, 0) == 0;
+}
+
+/* Opens the maze in a rooms directory for editing
+ * args: [1] edit, the MazeEdit to set up
+ * 	[2] dirName, the rooms directory
+ * 	[3] minDegree, the fewest connections an edit may leave a room with
+ * 	[4] maxDegree, the most connections an edit may give a room
+ * pre: the bounds pass checkDegreeBounds
+ * post: edit must be released with closeMazeEdit. If the directory has a binary
+ * 	maze file, it is opened with openMazeForUpdate; only its header is read,
+ * 	and it stays locked until closeMazeEdit
+ * ret: 0 on success, 1 if the directory holds no maze or memory could not be allocated
+ */
+int openMazeEdit(struct MazeEdit* edit, const char* dirName, int minDegree, int maxDegree) {
+	char path[512];
+	struct dirent* entry;
+	DIR* dir;
+	int fd;
+
+	memset(edit, 0, sizeof(*edit));
+	edit->dirName = dirName;
+	edit->dirFd = open(dirName, O_RDONLY | O_DIRECTORY);
+	if(edit->dirFd < 0) {
+		fprintf(stderr, "Error. Could not open %s\n", dirName);
+		return 1;
+	}
+
+	/*One room file is enough to know the directory has them; the rest are never listed */
+	fd = dup(edit->dirFd);
+	dir = fd >= 0 ? fdopendir(fd) : NULL;
+	for(entry = dir ? readdir(dir) : NULL; entry != NULL && !edit->hasText; entry = readdir(dir)) {
+		edit->hasText = entry->d_name[0] != '.' && strncmp(entry->d_name, MAZE_FILE_NAME,
+			strlen(MAZE_FILE_NAME)) != 0;
+	}
+	if(dir != NULL) {
+		closedir(dir);
+	} else if(fd >= 0) {
+		close(fd);
+	}
+
+	if(faccessat(edit->dirFd, MAZE_FILE_NAME, F_OK, 0) == 0) {
+		snprintf(path, sizeof(path), "%s/%s", dirName, MAZE_FILE_NAME);
+		if(openMazeForUpdate(&edit->maze, path, &edit->exclusive) != 0) {
+			closeMazeEdit(edit);
+			return 1;
+		}
+		edit->hasBinary = 1;
+	}
+	if(!edit->hasText && !edit->hasBinary) {
+		fprintf(stderr, "Error. %s holds no maze\n", dirName);
+		closeMazeEdit(edit);
+		return 1;
+	}
+
+	edit->capacity = EDIT_CAPACITY;
+	edit->states = malloc(EDIT_CAPACITY);
+	edit->dirty = malloc(EDIT_CAPACITY);
+	edit->indices = malloc(EDIT_CAPACITY * sizeof(uint32_t));
+	if(edit->states == NULL || edit->dirty == NULL || edit->indices == NULL
+			|| initRoomGraph(&edit->rooms, EDIT_CAPACITY, minDegree, maxDegree) != 0) {
+		fprintf(stderr, "Error. Couldn't allocate the edit\n");
+		closeMazeEdit(edit);
+		return 1;
+	}
+	edit->rooms.numRooms = 0;
+	return 0;
+}
+
+/* Connects two existing rooms
+ * args: [1] edit, the MazeEdit
+ * 	[2] a, [3] b, the names of the rooms
+ * ret: 0 on success, 1 if a room does not exist, the rooms are the same or
+ * 	already connected, or either room already has maxDegree connections
+ */
+int editLink(struct MazeEdit* edit, const char* a, const char* b) {
+	uint32_t x = getRoom(edit, a);
+	uint32_t y = x == NO_ROOM ? NO_ROOM : getRoom(edit, b);
+
+	if(y == NO_ROOM) {
+		return 1;
+	}
+	if(x == y || isConnected(&edit->rooms, x, y)) {
+		fprintf(stderr, "Error. %s and %s are already connected\n", a, b);
+		return 1;
+	}
+	if(!canAddConnection(&edit->rooms, x) || !canAddConnection(&edit->rooms, y)) {
+		fprintf(stderr, "Error. %s already has %i connections\n", canAddConnection(&edit->rooms, x) ? b : a,
+			edit->rooms.maxDegree);
+		return 1;
+	}
+
+	connectRoom(&edit->rooms, x, y);
+	connectRoom(&edit->rooms, y, x);
+	edit->dirty[x] = 1;
+	edit->dirty[y] = 1;
+	return 0;
+}
+
+/* Disconnects two connected rooms
+ * args: [1] edit, the MazeEdit
+ * 	[2] a, [3] b, the names of the rooms
+ * ret: 0 on success, 1 if a room does not exist, the rooms are not connected,
+ * 	or either room would be left with fewer than minDegree connections
+ */
+int editUnlink(struct MazeEdit* edit, const char* a, const char* b) {
+	uint32_t x = getRoom(edit, a);
+	uint32_t y = x == NO_ROOM ? NO_ROOM : getRoom(edit, b);
+
+	if(y == NO_ROOM) {
+		return 1;
+	}
+	if(!isConnected(&edit->rooms, x, y)) {
+		fprintf(stderr, "Error. %s and %s are not connected\n", a, b);
+		return 1;
+	}
+	if(edit->rooms.degrees[x] <= edit->rooms.minDegree || edit->rooms.degrees[y] <= edit->rooms.minDegree) {
+		fprintf(stderr, "Error. %s would have fewer than %i connections\n",
+			edit->rooms.degrees[x] <= edit->rooms.minDegree ? a : b, edit->rooms.minDegree);
+		return 1;
+	}
+
+	disconnectRoom(&edit->rooms, x, y);
+	disconnectRoom(&edit->rooms, y, x);
+	edit->dirty[x] = 1;
+	edit->dirty[y] = 1;
+	return 0;
+}
+
+/* Changes the type of a room
+ * args: [1] edit, the MazeEdit
+ * 	[2] name, the name of the room
+ * 	[3] type, START_ROOM, MID_ROOM or END_ROOM
+ * post: no other room is changed; a maze needs exactly one START_ROOM and one
+ * 	END_ROOM, so moving either takes two edits
+ * ret: 0 on success, 1 if the room does not exist
+ */
+int editSetType(struct MazeEdit* edit, const char* name, int type) {
+	uint32_t room = getRoom(edit, name);
+
+	if(room == NO_ROOM) {
+		return 1;
+	}
+	edit->rooms.types[room] = type;
+	edit->dirty[room] = 1;
+	return 0;
+}
+
+/* Adds a new MID_ROOM connected to existing rooms
+ * args: [1] edit, the MazeEdit
+ * 	[2] name, the name of the new room
+ * 	[3] neighbours, the names of the rooms to connect it to
+ * 	[4] count, the number of neighbours
+ * ret: 0 on success, 1 if the name is taken or can't be a room name, count is
+ * 	outside the degree bounds, a neighbour does not exist or is repeated, or a
+ * 	neighbour already has maxDegree connections
+ */
+int editAddRoom(struct MazeEdit* edit, const char* name, char** neighbours, int count) {
+	uint32_t room;
+	uint32_t other;
+	int i;
+	int j;
+
+	if(!isRoomName(name, strlen(name)) || roomExists(edit, name)) {
+		fprintf(stderr, "Error. %s can't be the name of a new room\n", name);
+		return 1;
+	}
+	if(count < edit->rooms.minDegree || count > edit->rooms.maxDegree) {
+		fprintf(stderr, "Error. %s needs %i to %i connections, not %i\n", name, edit->rooms.minDegree,
+			edit->rooms.maxDegree, count);
+		return 1;
+	}
+
+	/*Check every neighbour before connecting any, so a failed edit changes nothing */
+	for(i = 0; i < count; i++) {
+		for(j = 0; j < i; j++) {
+			if(strcmp(neighbours[i], neighbours[j]) == 0) {
+				fprintf(stderr, "Error. %s is repeated\n", neighbours[i]);
+				return 1;
+			}
+		}
+		other = getRoom(edit, neighbours[i]);
+		if(other == NO_ROOM) {
+			return 1;
+		}
+		if(!canAddConnection(&edit->rooms, other)) {
+			fprintf(stderr, "Error. %s already has %i connections\n", neighbours[i], edit->rooms.maxDegree);
+			return 1;
+		}
+	}
+
+	room = addStub(edit, name, NO_ROOM);
+	if(room == NO_ROOM) {
+		fprintf(stderr, "Error. Couldn't allocate room %s\n", name);
+		return 1;
+	}
+	edit->states[room] = EDIT_ADDED;
+	edit->rooms.types[room] = MID_ROOM;
+	edit->dirty[room] = 1;
+	for(i = 0; i < count; i++) {
+		other = findRoom(edit, neighbours[i]);
+		connectRoom(&edit->rooms, room, other);
+		connectRoom(&edit->rooms, other, room);
+		edit->dirty[other] = 1;
+	}
+	edit->resized = 1;
+	return 0;
+}
+
+/* Removes a MID_ROOM and its connections
+ * args: [1] edit, the MazeEdit
+ * 	[2] name, the name of the room
+ * ret: 0 on success, 1 if the room does not exist, is the START_ROOM or
+ * 	END_ROOM, or a neighbour would be left with fewer than minDegree connections
+ */
+int editRemoveRoom(struct MazeEdit* edit, const char* name) {
+	uint32_t room = getRoom(edit, name);
+	uint32_t other;
+	int i;
+
+	if(room == NO_ROOM) {
+		return 1;
+	}
+	if(edit->rooms.types[room] == START_ROOM || edit->rooms.types[room] == END_ROOM) {
+		fprintf(stderr, "Error. %s is the START_ROOM or END_ROOM\n", name);
+		return 1;
+	}
+	for(i = 0; i < edit->rooms.degrees[room]; i++) {
+		other = roomLinks(&edit->rooms, room)[i];
+		if(loadRoom(edit, other) != 0) {
+			return 1;
+		}
+		if(edit->rooms.degrees[other] <= edit->rooms.minDegree) {
+			fprintf(stderr, "Error. %s would have fewer than %i connections\n", edit->rooms.names[other],
+				edit->rooms.minDegree);
+			return 1;
+		}
+	}
+
+	for(i = 0; i < edit->rooms.degrees[room]; i++) {
+		other = roomLinks(&edit->rooms, room)[i];
+		disconnectRoom(&edit->rooms, other, room);
+		edit->dirty[other] = 1;
+	}
+	edit->rooms.degrees[room] = 0;
+
+	/*A room added by this edit has no file to remove yet */
+	edit->dirty[room] = edit->states[room] != EDIT_ADDED;
+	edit->states[room] = EDIT_REMOVED;
+	edit->resized = 1;
+	return 0;
+}
+
+/* Writes the changed rooms into a binary maze file
+ * args: [1] edit, a MazeEdit with no rooms added or removed
+ * 	[2] maze, the edit's maze, or a copy of it, with an exclusive flock
+ * post: each changed room's links are stored over its old block if they fit,
+ * 	and otherwise in a new block appended to the file, and then its type and
+ * 	degree. Nothing else in the file is read or written
+ * ret: 0 on success, 1 if the file could not be grown or written
+ */
+static int patchRooms(struct MazeEdit* edit, struct Maze* maze) {
+	uint32_t links[MAX_DEGREE_LIMIT];
+	uint64_t needed = 0;
+	uint64_t block = 0;
+	uint64_t start;
+	uint32_t index;
+	uint32_t room;
+	int i;
+
+	/*Grow the file once, for every room that outgrew its block */
+	for(room = 0; room < edit->rooms.numRooms; room++) {
+		if(edit->dirty[room] && edit->rooms.degrees[room] > maze->degrees[edit->indices[room]]) {
+			needed += edit->rooms.degrees[room];
+		}
+	}
+	if(needed > 0 && appendMazeLinks(maze, needed, &block) != 0) {
+		return 1;
+	}
+
+	for(room = 0; room < edit->rooms.numRooms; room++) {
+		if(!edit->dirty[room]) {
+			continue;
+		}
+		index = edit->indices[room];
+		start = maze->linkStart[index];
+		if(edit->rooms.degrees[room] > maze->degrees[index]) {
+			start = block;
+			block += edit->rooms.degrees[room];
+			edit->blocksMoved++;
+		}
+		for(i = 0; i < edit->rooms.degrees[room]; i++) {
+			links[i] = edit->indices[roomLinks(&edit->rooms, room)[i]];
+		}
+		if(writeMazeRoom(maze, index, edit->rooms.types[room], edit->rooms.degrees[room], start, links) != 0) {
+			return 1;
+		}
+		edit->roomsPatched++;
+	}
+	return 0;
+}
+
+/* Patches the changed rooms into the binary maze, in place if the edit holds
+ * 	its only flock
+ * args: [1] edit, a MazeEdit with no rooms added or removed
+ * post: see patchRooms. If a reader has the maze mapped, the maze is copied,
+ * 	the copy patched, and renamed over the maze only once it is complete, so
+ * 	the reader keeps the old maze
+ * ret: 0 on success, 1 if the maze or its copy could not be written
+ */
+static int patchMaze(struct MazeEdit* edit) {
+	struct Maze copy;
+	char path[512];
+	char newPath[512];
+	int exclusive;
+	int result;
+
+	if(edit->exclusive) {
+		return patchRooms(edit, &edit->maze);
+	}
+
+	snprintf(path, sizeof(path), "%s/%s", edit->dirName, MAZE_FILE_NAME);
+	snprintf(newPath, sizeof(newPath), "%s/%s.new", edit->dirName, MAZE_FILE_NAME);
+	if(writeMaze(&edit->maze, newPath) != 0 || openMazeForUpdate(&copy, newPath, &exclusive) != 0) {
+		unlink(newPath);
+		return 1;
+	}
+	edit->copied = 1;
+	result = patchRooms(edit, &copy);
+	closeMaze(&copy);
+	if(result == 0 && rename(newPath, path) != 0) {
+		fprintf(stderr, "Error. Could not replace %s: %s\n", path, strerror(errno));
+		result = 1;
+	}
+	if(result != 0) {
+		unlink(newPath);
+	}
+	return result;
+}
+
+/* Writes the binary maze again with rooms added or removed. Rooms keep their
+ * 	order; added rooms go at the end
+ * args: [1] edit, the MazeEdit
+ * post: the new maze, with its name index sorted again, replaces the old file
+ * 	with a rename, so a reader sees either the old maze or the new one
+ * ret: 0 on success, 1 if memory could not be allocated, a room of the old maze
+ * 	is damaged, or the file could not be written
+ */
+static int repackMaze(struct MazeEdit* edit) {
+	const struct Maze* old = &edit->maze;
+	struct Maze maze;
+	char path[512];
+	char newPath[512];
+	uint32_t* roomOf; /*edit room of each old room, or NO_ROOM */
+	uint32_t* newIndex; /*new index of each old room, or NO_ROOM if it is removed */
+	uint32_t* newIndexOf; /*new index of each edit room */
+	uint32_t added = 0; /*next edit room to look at for added rooms */
+	uint32_t numRooms = 0;
+	uint64_t numLinks = 0;
+	uint64_t namesSize = 0;
+	uint64_t link = 0;
+	uint64_t nameOffset = 0;
+	uint32_t room;
+	uint32_t i;
+	uint32_t j;
+	const char* name;
+	size_t length;
+	int degree;
+	int k;
+	int result;
+
+	roomOf = malloc(((size_t)old->numRooms + 1) * sizeof(uint32_t));
+	newIndex = malloc(((size_t)old->numRooms + 1) * sizeof(uint32_t));
+	newIndexOf = malloc(((size_t)edit->rooms.numRooms + 1) * sizeof(uint32_t));
+	if(roomOf == NULL || newIndex == NULL || newIndexOf == NULL) {
+		free(roomOf);
+		free(newIndex);
+		free(newIndexOf);
+		return 1;
+	}
+
+	/*Number the rooms that stay, then the added ones */
+	for(i = 0; i < old->numRooms; i++) {
+		roomOf[i] = NO_ROOM;
+	}
+	for(room = 0; room < edit->rooms.numRooms; room++) {
+		if(edit->indices[room] != NO_ROOM) {
+			roomOf[edit->indices[room]] = room;
+		}
+	}
+	for(i = 0; i < old->numRooms; i++) {
+		if(!mazeRoomFits(old, i)) {
+			fprintf(stderr, "Error. Room %u of %s/%s is damaged\n", i, edit->dirName, MAZE_FILE_NAME);
+			free(roomOf);
+			free(newIndex);
+			free(newIndexOf);
+			return 1;
+		}
+		if(roomOf[i] != NO_ROOM && edit->states[roomOf[i]] == EDIT_REMOVED) {
+			newIndex[i] = NO_ROOM;
+			continue;
+		}
+		newIndex[i] = numRooms;
+		numRooms++;
+		numLinks += roomOf[i] != NO_ROOM && edit->states[roomOf[i]] != EDIT_STUB
+			? edit->rooms.degrees[roomOf[i]] : old->degrees[i];
+		namesSize += strlen(mazeRoomName(old, i)) + 1;
+	}
+	for(room = 0; room < edit->rooms.numRooms; room++) {
+		if(edit->states[room] == EDIT_ADDED) {
+			newIndexOf[room] = numRooms;
+			numRooms++;
+			numLinks += edit->rooms.degrees[room];
+			namesSize += strlen(edit->rooms.names[room]) + 1;
+		} else {
+			newIndexOf[room] = edit->indices[room] == NO_ROOM ? NO_ROOM : newIndex[edit->indices[room]];
+		}
+	}
+
+	result = createMaze(&maze, numRooms, numLinks, namesSize);
+	for(j = 0, i = 0; result == 0 && j < numRooms; j++) {
+		/*The next old room that stays, or else the next added room */
+		while(i < old->numRooms && newIndex[i] == NO_ROOM) {
+			i++;
+		}
+		if(i < old->numRooms) {
+			room = roomOf[i];
+			name = mazeRoomName(old, i);
+		} else {
+			while(edit->states[added] != EDIT_ADDED) {
+				added++;
+			}
+			room = added;
+			name = edit->rooms.names[room];
+		}
+
+		length = strlen(name) + 1;
+		memcpy(maze.names + nameOffset, name, length);
+		maze.nameOffsets[j] = nameOffset;
+		nameOffset += length;
+		maze.linkStart[j] = link;
+
+		/*A room the edit read takes its links from the edit; any other keeps its own */
+		if(room != NO_ROOM && edit->states[room] != EDIT_STUB) {
+			degree = edit->rooms.degrees[room];
+			maze.types[j] = edit->rooms.types[room];
+			for(k = 0; k < degree; k++) {
+				maze.links[link + k] = newIndexOf[roomLinks(&edit->rooms, room)[k]];
+			}
+		} else {
+			degree = old->degrees[i];
+			maze.types[j] = old->types[i];
+			for(k = 0; k < degree; k++) {
+				maze.links[link + k] = newIndex[mazeConnections(old, i)[k]];
+			}
+		}
+		maze.degrees[j] = degree;
+		link += degree;
+
+		if(i < old->numRooms) {
+			i++;
+		} else {
+			added++;
+		}
+	}
+
+	if(result == 0) {
+		result = sortMazeNames(&maze);
+	}
+	if(result == 0) {
+		snprintf(path, sizeof(path), "%s/%s", edit->dirName, MAZE_FILE_NAME);
+		snprintf(newPath, sizeof(newPath), "%s/%s.new", edit->dirName, MAZE_FILE_NAME);
+		result = writeMaze(&maze, newPath);
+		if(result == 0 && rename(newPath, path) != 0) {
+			fprintf(stderr, "Error. Could not replace %s: %s\n", path, strerror(errno));
+			result = 1;
+		}
+	}
+	closeMaze(&maze);
+
+	free(roomOf);
+	free(newIndex);
+	free(newIndexOf);
+	return result;
+}
+
+/* Writes the changed rooms back to the rooms directory
+ * args: [1] edit, a MazeEdit whose edits all succeeded
+ * post: the room file of every changed room is rewritten, and the room file
+ * 	of every removed room deleted. The binary maze, if there is one, has its
+ * 	changed rooms patched by patchMaze, or is repacked if rooms were added or
+ * 	removed. The counts in edit say how much was written
+ * ret: 0 on success, 1 if a file could not be written
+ */
+int commitMazeEdit(struct MazeEdit* edit) {
+	char* text;
+	uint32_t room;
+	int result = 0;
+
+	if(edit->hasBinary && edit->resized) {
+		result = repackMaze(edit);
+	} else if(edit->hasBinary) {
+		result = patchMaze(edit);
+	}
+
+	if(result == 0 && edit->hasText) {
+		text = malloc(roomTextLength(&edit->rooms));
+		if(text == NULL) {
+			return 1;
+		}
+		for(room = 0; room < edit->rooms.numRooms && result == 0; room++) {
+			if(!edit->dirty[room]) {
+				continue;
+			}
+			if(edit->states[room] == EDIT_REMOVED) {
+				result = unlinkat(edit->dirFd, edit->rooms.names[room], 0) != 0;
+				edit->filesRemoved += result == 0;
+			} else {
+				result = writeRoomFile(edit->dirFd, &edit->rooms, room, text);
+				edit->filesWritten += result == 0;
+			}
+			if(result != 0) {
+				fprintf(stderr, "Error. Could not write %s/%s\n", edit->dirName, edit->rooms.names[room]);
+			}
+		}
+		free(text);
+	}
+	return result;
+}
+
+/*Frees the memory held by a MazeEdit, without writing anything */
+void closeMazeEdit(struct MazeEdit* edit) {
+	uint32_t room;
+
+	for(room = 0; room < edit->rooms.numRooms; room++) {
+		free(edit->rooms.names[room]);
+	}
+	freeRoomGraph(&edit->rooms);
+	free(edit->states);
+	free(edit->dirty);
+	free(edit->indices);
+	closeMaze(&edit->maze);
+	if(edit->dirFd >= 0) {
+		close(edit->dirFd);
+	}
+	memset(edit, 0, sizeof(*edit));
+}
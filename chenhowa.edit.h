@@ -0,0 +1,59 @@
+/* Filename: chenhowa.edit.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Edits an existing maze in its rooms directory without
+ * 	regenerating it: rooms can be added and removed, rooms linked and
+ * 	unlinked, and room types changed. Only the rooms an edit touches are read,
+ * 	checked and written back.
+ */
+
+#ifndef CHENHOWA_EDIT_H
+#define CHENHOWA_EDIT_H
+
+#include <stdint.h>
+
+#include "chenhowa.maze.h"
+#include "chenhowa.roomgraph.h"
+
+/*States of a room known to a MazeEdit */
+#define EDIT_STUB 0 /*only the room's name is known; it is the neighbour of a loaded room */
+#define EDIT_LOADED 1 /*the room's type and connections have been read */
+#define EDIT_ADDED 2 /*the room is new */
+#define EDIT_REMOVED 3 /*the room is being removed */
+
+/*A batch of edits to the maze in one rooms directory. The rooms the edits touch,
+ * and their neighbours, are kept in a small RoomGraph of their own until the
+ * batch is committed */
+struct MazeEdit {
+	const char* dirName;
+	int dirFd; /*the rooms directory */
+	int hasText; /*1 if the directory has room files */
+	int hasBinary; /*1 if the directory has a binary maze file */
+	struct Maze maze; /*the binary maze, from openMazeForUpdate. Only its header has
+			    been read; each room is checked as the edit reads it */
+	int exclusive; /*1 if maze has an exclusive flock, held until closeMazeEdit,
+			 so it can be patched in place */
+	struct RoomGraph rooms; /*every room the edits have touched, and their neighbours.
+				  Its degree bounds are the ones the edits must keep */
+	uint32_t capacity; /*rooms the arrays have space for */
+	uint8_t* states; /*EDIT_ state of each room */
+	uint8_t* dirty; /*1 for each room that must be written back */
+	uint32_t* indices; /*index of each room in maze, or NO_ROOM */
+	int resized; /*1 once a room has been added or removed */
+	uint32_t filesWritten; /*room files written by commitMazeEdit */
+	uint32_t filesRemoved; /*room files removed by commitMazeEdit */
+	uint32_t roomsPatched; /*rooms of maze patched by commitMazeEdit */
+	uint32_t blocksMoved; /*rooms whose links moved to the end of maze */
+	int copied; /*1 if maze was patched in a copy, since a reader had it mapped */
+};
+
+int openMazeEdit(struct MazeEdit* edit, const char* dirName, int minDegree, int maxDegree);
+int editLink(struct MazeEdit* edit, const char* a, const char* b);
+int editUnlink(struct MazeEdit* edit, const char* a, const char* b);
+int editSetType(struct MazeEdit* edit, const char* name, int type);
+int editAddRoom(struct MazeEdit* edit, const char* name, char** neighbours, int count);
+int editRemoveRoom(struct MazeEdit* edit, const char* name);
+int commitMazeEdit(struct MazeEdit* edit);
+void closeMazeEdit(struct MazeEdit* edit);
+
+#endif
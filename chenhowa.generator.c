@@ -0,0 +1,747 @@
+/* Filename: chenhowa.generator.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Random maze generation over a RoomGraph: random room types, and
+ * 	random two-way connections until every room is within its degree bounds,
+ * 	either serially or in parallel shards, or one shard at a time for the
+ * 	streaming generator.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "chenhowa.generator.h"
+
+#define MAX_ATTEMPTS 64 /*random pairings tried before the generator rewires an edge */
+#define MIN_SHARD_ROOMS 1024 /*fewest rooms in a shard of a parallel generation */
+#define CROSS_LINK_RATIO 16 /*rooms per extra link from a shard to a random other shard */
+
+
+/*Struct for tracking which rooms of a range can still accept connections, so
+ * that the generator never has to rescan every room to find one */
+struct OpenSlots {
+	int first; /*first room of the range */
+	int* open; /*indices of the rooms with fewer than maxDegree connections */
+	int* position; /*position of each room (less first) in open, or -1 if the room is full */
+	int openCount; /*number of rooms in open */
+	int unsatisfied; /*number of rooms with fewer than minDegree connections */
+};
+
+/*One shard of a parallel generation: a contiguous range of rooms whose
+ * connections to each other are made by one thread */
+struct Shard {
+	struct RoomGraph* graph; /*the graph the shard's rooms are in */
+	int first; /*first room of the shard */
+	int count; /*number of rooms in the shard */
+	struct OpenSlots slots; /*open slot bookkeeping for the shard's rooms */
+	struct Rng rng; /*the shard's own random stream */
+	int result; /*0 once the shard is built, 1 if its bookkeeping could not be allocated */
+	pthread_t thread;
+};
+
+/* Assigns random room types to the rooms of a graph
+ * Arguments: [1] graph, the RoomGraph
+ * 		[2] rng, the random stream to draw from
+ * post: rooms will have been assigned random room types. Exactly 1 room will  be a 
+ * 	START_ROOM. Exactly 1 room will be an END_ROOM
+ * ret: none
+ *
+ */
+void assignRandomTypes(struct RoomGraph* graph, struct Rng* rng) {
+	int count = graph->numRooms;
+	int startRoom = -1;
+	int endRoom = -1;
+
+	/*Every room execpt the start room and end room must be MID_ROOMs.
+		So assign the midrooms first, and 
+		then randomly generate two different indices to be
+		START_ROOM and END_ROOM */
+	memset(graph->types, MID_ROOM, count);
+
+	startRoom = rngBounded(rng, count);
+	do {
+		endRoom = rngBounded(rng, count);
+
+	} while(endRoom == startRoom);
+
+	graph->types[startRoom] = START_ROOM;
+	graph->types[endRoom] = END_ROOM;
+}
+
+/*Returns a random room of the range of an OpenSlots */
+static int getRandomRoom(struct OpenSlots* slots, int count, struct Rng* rng) {
+	return slots->first + rngBounded(rng, count);
+}
+
+/* Sets up the open slot bookkeeping for a range of rooms
+ * Args: [1] slots, the OpenSlots struct to fill in
+ *	[2] graph, the RoomGraph the rooms are in
+ *	[3] first, the first room of the range
+ *	[4] count, the number of rooms in the range
+ * post: every room that can still take a connection is in the open set
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+static int initOpenSlots(struct OpenSlots* slots, const struct RoomGraph* graph, int first, int count) {
+	int i;
+
+	slots->first = first;
+	slots->open = malloc(count * sizeof(int));
+	slots->position = malloc(count * sizeof(int));
+	if(slots->open == NULL || slots->position == NULL) {
+		free(slots->open);
+		free(slots->position);
+		return 1;
+	}
+
+	slots->openCount = 0;
+	slots->unsatisfied = 0;
+	for(i = 0; i < count; i++) {
+		slots->position[i] = -1;
+		if(canAddConnection(graph, first + i)) {
+			slots->position[i] = slots->openCount;
+			slots->open[slots->openCount] = first + i;
+			slots->openCount++;
+		}
+		if(graph->degrees[first + i] < graph->minDegree) {
+			slots->unsatisfied++;
+		}
+	}
+
+	return 0;
+}
+
+/*Frees the memory held by an OpenSlots struct */
+static void freeOpenSlots(struct OpenSlots* slots) {
+	free(slots->open);
+	free(slots->position);
+	slots->open = NULL;
+	slots->position = NULL;
+	slots->openCount = 0;
+}
+
+/* Updates the open slot bookkeeping after a room's number of connections changed
+ * Args: [1] slots, the OpenSlots struct for the room's range
+ *	[2] graph, the RoomGraph the rooms are in
+ *	[3] room, the room that changed
+ *	[4] oldConnections, the degree of the room before it changed
+ * post: the room is in the open set if and only if it can take another connection,
+ * 	and the unsatisfied count reflects the room's new degree
+ * ret: none
+ */
+static void updateOpenSlots(struct OpenSlots* slots, const struct RoomGraph* graph, int room, int oldConnections) {
+	int newConnections = graph->degrees[room];
+	int index = room - slots->first;
+	int pos;
+	int last;
+
+	if(oldConnections < graph->minDegree && newConnections >= graph->minDegree) {
+		slots->unsatisfied--;
+	} else if(oldConnections >= graph->minDegree && newConnections < graph->minDegree) {
+		slots->unsatisfied++;
+	}
+
+	pos = slots->position[index];
+	if(canAddConnection(graph, room) && pos == -1) {
+		/*Room just opened up, so append it to the open set */
+		slots->position[index] = slots->openCount;
+		slots->open[slots->openCount] = room;
+		slots->openCount++;
+	} else if(!canAddConnection(graph, room) && pos != -1) {
+		/*Room just filled up, so swap the last open room into its place */
+		slots->openCount--;
+		last = slots->open[slots->openCount];
+		slots->open[pos] = last;
+		slots->position[last - slots->first] = pos;
+		slots->position[index] = -1;
+	}
+}
+
+/*Returns a random room that can still add a connection.
+ * There must be at least one open room */
+static int getRandomOpenRoom(struct OpenSlots* slots, struct Rng* rng) {
+	return slots->open[rngBounded(rng, slots->openCount)];
+}
+
+/*Connects two rooms in both directions and updates the open slot bookkeeping
+ * of their ranges, which may be the same. WARNING: Does not check if this
+ * connection is legal */
+static void linkRooms(struct RoomGraph* graph, struct OpenSlots* xSlots, struct OpenSlots* ySlots, int x, int y) {
+	int xOld = graph->degrees[x];
+	int yOld = graph->degrees[y];
+
+	connectRoom(graph, x, y);
+	connectRoom(graph, y, x);
+	updateOpenSlots(xSlots, graph, x, xOld);
+	updateOpenSlots(ySlots, graph, y, yOld);
+}
+
+/*Returns 1 if a room is connected to a room outside the range of slots. Only
+ * the placeholders of a streamed shard are ever outside it */
+static int hasOutsideLink(const struct RoomGraph* graph, const struct OpenSlots* slots, int count, uint32_t room) {
+	const uint32_t* links = roomLinks(graph, room);
+	int i;
+
+	for(i = 0; i < graph->degrees[room]; i++) {
+		if(links[i] - slots->first >= (uint32_t)count) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Gives an unsatisfied room a new connection when random pairing keeps failing,
+ * which happens once the only open rooms are already connected to each other
+ * Args: [1] graph, the RoomGraph the rooms are in
+ *	[2] count, the number of rooms in the range of slots
+ *	[3] slots, the open slot bookkeeping for the range
+ *	[4] rng, the random stream to draw from
+ * pre: at least one room is unsatisfied, and count > minDegree
+ * post: an unsatisfied room x gains at least one connection. If the room u chosen
+ * 	for it is full, one of u's connections v is handed over to x instead:
+ * 	u-v is replaced by x-u and x-v, so u and v keep their number of connections.
+ * 	Because x has fewer than minDegree, a full u always has such a v, and
+ * 	because maxDegree > minDegree, x has room for both. A placeholder v outside
+ * 	the range is only handed to an x without one, so no room ever holds two
+ * ret: none
+ */
+static void rewireUnsatisfiedRoom(struct RoomGraph* graph, int count, struct OpenSlots* slots, struct Rng* rng) {
+	int x = -1;
+	int u;
+	int v = -1;
+	const uint32_t* uLinks;
+	int i;
+	int start;
+	int xOld;
+
+	/*Unsatisfied rooms are always open, so the open set holds one */
+	for(i = 0; i < slots->openCount; i++) {
+		if(graph->degrees[slots->open[i]] < graph->minDegree) {
+			x = slots->open[i];
+			break;
+		}
+	}
+	assert(x != -1);
+
+	/*Find any other room that x is not connected to yet */
+	do {
+		u = getRandomRoom(slots, count, rng);
+	} while(x == u || isConnected(graph, x, u));
+
+	if(canAddConnection(graph, u)) {
+		linkRooms(graph, slots, slots, x, u);
+		return;
+	}
+
+	/*u is full, so take over one of its connections that x can also accept */
+	uLinks = roomLinks(graph, u);
+	start = rngBounded(rng, graph->degrees[u]);
+	for(i = 0; i < graph->degrees[u]; i++) {
+		v = uLinks[(start + i) % graph->degrees[u]];
+		if(x != v && !isConnected(graph, x, v)
+				&& ((uint32_t)(v - slots->first) < (uint32_t)count || !hasOutsideLink(graph, slots, count, x))) {
+			break;
+		}
+	}
+	assert(i < graph->degrees[u]);
+
+	xOld = graph->degrees[x];
+	disconnectRoom(graph, u, v);
+	disconnectRoom(graph, v, u);
+	connectRoom(graph, u, x);
+	connectRoom(graph, v, x);
+	connectRoom(graph, x, u);
+	connectRoom(graph, x, v);
+	updateOpenSlots(slots, graph, x, xOld);
+}
+
+/* Adds a random connection between two rooms of a range
+ * Args: [1] graph, the RoomGraph the rooms are in
+ *	[2] count, the number of rooms in the range of slots
+ *	[3] slots, the open slot bookkeeping for the range, from initOpenSlots
+ *	[4] rng, the random stream to draw from
+ * post: one new connection has been added between two open rooms. Call
+ * 	repeatedly until slots->unsatisfied is 0 to make the range full:
+ * 	that is, every room has a valid number of connections to other rooms,
+ * 	between minDegree and maxDegree, inclusive
+ * ret: none
+ *
+ * Both rooms are drawn only from the open set, so every attempt costs O(1)
+ * no matter how many rooms are already full.
+ */
+static void addRandomConnection(struct RoomGraph* graph, int count, struct OpenSlots* slots, struct Rng* rng) {
+	int x;
+	int y;
+	int attempt;
+
+	for(attempt = 0; attempt < MAX_ATTEMPTS && slots->openCount > 1; attempt++) {
+		/*Get two random rooms that can still add a connection */
+		x = getRandomOpenRoom(slots, rng);
+		y = getRandomOpenRoom(slots, rng);
+
+		/*Connect them if they are different and haven't been connected before*/
+		if(x != y && !isConnected(graph, x, y)) {
+			linkRooms(graph, slots, slots, x, y);
+			return;
+		}
+	}
+
+	/*The open rooms are (nearly) all connected to each other already */
+	rewireUnsatisfiedRoom(graph, count, slots, rng);
+}
+
+/* Joins a range of rooms into a random tree, so the range is connected before
+ * 	any random connections are added
+ * Args: [1] graph, the RoomGraph the rooms are in
+ * 	[2] first, the first room of the range
+ * 	[3] count, the number of rooms in the range, at least 1
+ * 	[4] rng, the random stream to draw from
+ * pre: no room of the range has a connection yet, and maxDegree >= 2
+ * post: every room of the range is connected to every other through rooms of
+ * 	the range, and has at least one connection if count > 1
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+static int connectRandomTree(struct RoomGraph* graph, uint32_t first, uint32_t count, struct Rng* rng) {
+	uint32_t* order;
+	uint32_t* open; /*rooms already in the tree that can take another connection */
+	uint32_t numOpen = 1;
+	uint32_t parent;
+	uint32_t swap;
+	uint32_t i, j;
+
+	/*Take the rooms in a random order (a Fisher-Yates shuffle), and hang each
+ * 	from a random room already in the tree that isn't full. A path would be
+ * 	enough to connect the range, but with a low minDegree it would be most of
+ * 	the maze; a random tree is only logarithmically deep */
+	order = malloc(count * sizeof(uint32_t));
+	open = malloc(count * sizeof(uint32_t));
+	if(order == NULL || open == NULL) {
+		free(order);
+		free(open);
+		return 1;
+	}
+	for(i = 0; i < count; i++) {
+		order[i] = first + i;
+	}
+	for(i = count - 1; i > 0; i--) {
+		j = rngBounded(rng, i + 1);
+		swap = order[i];
+		order[i] = order[j];
+		order[j] = swap;
+	}
+	open[0] = order[0];
+	for(i = 1; i < count; i++) {
+		j = rngBounded(rng, numOpen);
+		parent = open[j];
+		connectRoom(graph, parent, order[i]);
+		connectRoom(graph, order[i], parent);
+		if(!canAddConnection(graph, parent)) {
+			numOpen--;
+			open[j] = open[numOpen];
+		}
+		open[numOpen] = order[i];
+		numOpen++;
+	}
+	free(order);
+	free(open);
+	return 0;
+}
+
+/* Description: body of every shard thread. Connects the rooms of one shard to
+ * 	each other exactly the way the serial generator connects every room
+ * Args: [1] arg, the Shard to build
+ * Post: every room in the shard has minDegree to maxDegree connections,
+ * 	all of them inside the shard, and the shard is connected. The shard's slots
+ * 	stay allocated for stitching
+ * ret: NULL
+ */
+static void* buildShard(void* arg) {
+	struct Shard* shard = arg;
+
+	shard->result = connectRandomTree(shard->graph, shard->first, shard->count, &shard->rng);
+	if(shard->result == 0) {
+		shard->result = initOpenSlots(&shard->slots, shard->graph, shard->first, shard->count);
+	}
+	if(shard->result != 0) {
+		return NULL;
+	}
+	while(shard->slots.unsatisfied > 0) {
+		addRandomConnection(shard->graph, shard->count, &shard->slots, &shard->rng);
+	}
+	return NULL;
+}
+
+/* Hands one connection of a room in one shard over to a room of another shard
+ * 	that has two free slots, the way rewireUnsatisfiedRoom does
+ * Args: [1] to, the shard of the room that gains the connections
+ * 	[2] from, the shard whose connection is handed over
+ * 	[3] rng, the random stream to draw from
+ * post: if to has a room x with two free slots, and a room u of from has a
+ * 	connection inside from to a room v that x isn't connected to either, u-v is
+ * 	replaced by x-u and x-v. u and v keep their number of connections, and
+ * 	anything that was connected through u-v still is, through x
+ * ret: 0 if a connection was handed over, 1 otherwise
+ */
+static int handOverLink(struct Shard* to, struct Shard* from, struct Rng* rng) {
+	struct RoomGraph* graph = to->graph;
+	const uint32_t* uLinks;
+	int x = -1;
+	int u;
+	int v;
+	int xOld;
+	int attempt;
+	int i;
+
+	for(i = 0; i < to->slots.openCount; i++) {
+		if(graph->degrees[to->slots.open[i]] + 2 <= graph->maxDegree) {
+			x = to->slots.open[i];
+			break;
+		}
+	}
+	if(x == -1) {
+		return 1;
+	}
+
+	for(attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+		u = from->first + rngBounded(rng, from->count);
+		if(isConnected(graph, x, u)) {
+			continue;
+		}
+		uLinks = roomLinks(graph, u);
+		for(i = 0; i < graph->degrees[u]; i++) {
+			v = uLinks[i];
+			if((uint32_t)(v - from->first) < (uint32_t)from->count && !isConnected(graph, x, v)) {
+				xOld = graph->degrees[x];
+				disconnectRoom(graph, u, v);
+				disconnectRoom(graph, v, u);
+				connectRoom(graph, u, x);
+				connectRoom(graph, v, x);
+				connectRoom(graph, x, u);
+				connectRoom(graph, x, v);
+				updateOpenSlots(&to->slots, graph, x, xOld);
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/* Checks whether a connection inside a shard lies on a cycle of the shard
+ * Args: [1] shard, the Shard
+ * 	[2] x, [3] y, two connected rooms of the shard
+ * 	[4] queue, space for count rooms
+ * 	[5] seen, count bytes, all zero
+ * post: seen is left dirty
+ * ret: 1 if y can be reached from x through rooms of the shard without the
+ * 	connection x-y, 0 otherwise
+ */
+static int onShardCycle(const struct Shard* shard, int x, int y, int* queue, uint8_t* seen) {
+	const struct RoomGraph* graph = shard->graph;
+	const uint32_t* links;
+	int head = 0;
+	int tail = 1;
+	int room;
+	int i;
+
+	queue[0] = x;
+	seen[x - shard->first] = 1;
+	while(head < tail) {
+		room = queue[head];
+		head++;
+		links = roomLinks(graph, room);
+		for(i = 0; i < graph->degrees[room]; i++) {
+			if((uint32_t)(links[i] - shard->first) >= (uint32_t)shard->count
+					|| (room == x && (int)links[i] == y) || seen[links[i] - shard->first]) {
+				continue;
+			}
+			if((int)links[i] == y) {
+				return 1;
+			}
+			seen[links[i] - shard->first] = 1;
+			queue[tail] = links[i];
+			tail++;
+		}
+	}
+	return 0;
+}
+
+/* Links two shards that have no free slots to spare by swapping connections:
+ * 	x-x2 in a and y-y2 in b are replaced by x-y and x2-y2
+ * Args: [1] a, one shard
+ * 	[2] b, a different shard
+ * 	[3] rng, the random stream to draw from
+ * post: if a connection x-x2 on a cycle of a was found, the swap is made. Every
+ * 	room keeps its number of connections. x and x2 stay connected through the
+ * 	cycle, and both halves of anything split by dropping y-y2 hang from them
+ * ret: 0 if the connections were swapped, 1 otherwise
+ */
+static int swapShardLinks(struct Shard* a, struct Shard* b, struct Rng* rng) {
+	struct RoomGraph* graph = a->graph;
+	int* queue;
+	uint8_t* seen;
+	int x, x2 = -1;
+	int y, y2;
+	int attempt;
+	int found = 0;
+
+	queue = malloc(a->count * sizeof(int));
+	seen = malloc(a->count);
+	if(queue == NULL || seen == NULL) {
+		free(queue);
+		free(seen);
+		return 1;
+	}
+
+	/*Every room has at least minDegree connections, so a room whose connection
+ * 	is a bridge is rare unless minDegree is 1 */
+	for(attempt = 0; attempt < MAX_ATTEMPTS && !found; attempt++) {
+		x = a->first + rngBounded(rng, a->count);
+		x2 = roomLinks(graph, x)[rngBounded(rng, graph->degrees[x])];
+		if((uint32_t)(x2 - a->first) < (uint32_t)a->count) {
+			memset(seen, 0, a->count);
+			found = onShardCycle(a, x, x2, queue, seen);
+		}
+	}
+	free(queue);
+	free(seen);
+	if(!found) {
+		return 1;
+	}
+
+	for(attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
+		y = b->first + rngBounded(rng, b->count);
+		y2 = roomLinks(graph, y)[rngBounded(rng, graph->degrees[y])];
+		if((uint32_t)(y2 - b->first) < (uint32_t)b->count
+				&& !isConnected(graph, x, y) && !isConnected(graph, x2, y2)) {
+			disconnectRoom(graph, x, x2);
+			disconnectRoom(graph, x2, x);
+			disconnectRoom(graph, y, y2);
+			disconnectRoom(graph, y2, y);
+			connectRoom(graph, x, y);
+			connectRoom(graph, y, x);
+			connectRoom(graph, x2, y2);
+			connectRoom(graph, y2, x2);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Connects a room of one shard to a room of another
+ * Args: [1] a, one shard
+ * 	[2] b, a different shard
+ * 	[3] rng, the random stream to draw from
+ * 	[4] rewire, 1 to rewire connections if no two open rooms can be connected
+ * post: two open rooms that aren't connected yet are connected, or failing
+ * 	that, if rewire is 1, a connection is handed over with handOverLink, or
+ * 	failing that, connections are swapped with swapShardLinks. Nobody loses a connection, so
+ * 	every room stays within minDegree and maxDegree, and nothing that was
+ * 	connected is split, so the rooms of a and b end up connected to each other
+ * ret: 0 if the shards were linked, 1 otherwise
+ */
+static int connectShards(struct Shard* a, struct Shard* b, struct Rng* rng, int rewire) {
+	int x;
+	int y;
+	int attempt;
+	int i, j;
+
+	for(attempt = 0; attempt < MAX_ATTEMPTS && a->slots.openCount > 0 && b->slots.openCount > 0; attempt++) {
+		x = getRandomOpenRoom(&a->slots, rng);
+		y = getRandomOpenRoom(&b->slots, rng);
+		if(!isConnected(a->graph, x, y)) {
+			linkRooms(a->graph, &a->slots, &b->slots, x, y);
+			return 0;
+		}
+	}
+
+	/*Random pairing only fails when few rooms are open. Each open room of a is
+ * 	connected to at most maxDegree open rooms of b, so this scan is short */
+	for(i = 0; i < a->slots.openCount; i++) {
+		for(j = 0; j < b->slots.openCount; j++) {
+			x = a->slots.open[i];
+			y = b->slots.open[j];
+			if(!isConnected(a->graph, x, y)) {
+				linkRooms(a->graph, &a->slots, &b->slots, x, y);
+				return 0;
+			}
+		}
+	}
+
+	if(!rewire) {
+		return 1;
+	}
+	if(handOverLink(a, b, rng) == 0 || handOverLink(b, a, rng) == 0) {
+		return 0;
+	}
+	return swapShardLinks(a, b, rng) != 0 && swapShardLinks(b, a, rng) != 0;
+}
+
+/* Connects the rooms of a graph in parallel, one shard of rooms per thread
+ * Args: [1] graph, a RoomGraph
+ * 	[2] threads, the number of shards and threads to use
+ * 	[3] rng, the seeded random stream; left unchanged
+ * pre: every room has no connections yet
+ * post: every room has minDegree to maxDegree connections.
+ * 	Each shard is connected internally by its own thread and its own stream
+ * 	split from rng, and is connected. Then, serially, every shard is linked to
+ * 	the next one in a ring, which connects the maze, and then gets one more link
+ * 	to a random other shard for every CROSS_LINK_RATIO of its rooms where there
+ * 	is room for one. The result depends only on rng, the graph's size and
+ * 	bounds, and threads
+ * ret: 0 on success, 1 if memory could not be allocated or two shards of the
+ * 	ring could not be linked
+ */
+static int generateShards(struct RoomGraph* graph, int threads, const struct Rng* rng) {
+	struct Shard* shards;
+	struct Rng stitchRng;
+	long long count = graph->numRooms;
+	int numShards = threads;
+	int result = 0;
+	int started;
+	int i, j;
+	int link;
+
+	/*Every shard must be big enough to satisfy its rooms on its own */
+	if(numShards > count / MIN_SHARD_ROOMS) {
+		numShards = count / MIN_SHARD_ROOMS;
+	}
+	if(numShards < 1) {
+		numShards = 1;
+	}
+	shards = calloc(numShards, sizeof(struct Shard));
+	if(shards == NULL) {
+		return 1;
+	}
+	for(i = 0; i < numShards; i++) {
+		shards[i].graph = graph;
+		shards[i].first = count * i / numShards;
+		shards[i].count = count * (i + 1) / numShards - count * i / numShards;
+		splitRng(&shards[i].rng, rng, i);
+	}
+
+	/*The calling thread builds shard 0 */
+	for(started = 1; started < numShards; started++) {
+		if(pthread_create(&shards[started].thread, NULL, buildShard, shards + started) != 0) {
+			break;
+		}
+	}
+	buildShard(shards);
+	for(i = 1; i < numShards; i++) {
+		if(i < started) {
+			pthread_join(shards[i].thread, NULL);
+		} else {
+			buildShard(shards + i);
+		}
+		result |= shards[i].result;
+	}
+	result |= shards[0].result;
+
+	/*Stitch the shards together, serially so the result doesn't depend on timing.
+ * 	The ring goes first, while every shard still has its free slots; the
+ * 	cross links only add shortcuts, so one that doesn't fit is skipped */
+	if(result == 0 && numShards > 1) {
+		splitRng(&stitchRng, rng, numShards);
+		for(i = 0; i < numShards && result == 0; i++) {
+			result = connectShards(shards + i, shards + (i + 1) % numShards, &stitchRng, 1);
+		}
+		for(i = 0; i < numShards && result == 0; i++) {
+			for(link = 0; link < shards[i].count / CROSS_LINK_RATIO; link++) {
+				j = rngBounded(&stitchRng, numShards - 1);
+				if(j >= i) {
+					j++;
+				}
+				connectShards(shards + i, shards + j, &stitchRng, 0);
+			}
+		}
+	}
+
+	for(i = 0; i < numShards; i++) {
+		if(shards[i].result == 0) {
+			freeOpenSlots(&shards[i].slots);
+		}
+	}
+	free(shards);
+	return result;
+}
+
+/* Connects the rooms of a graph at random until every room has minDegree to
+ * 	maxDegree connections
+ * Args: [1] graph, a RoomGraph with no connections yet
+ * 	[2] threads, 1 for the serial generator, or the number of shards and
+ * 	threads to use (see generateShards)
+ * 	[3] rng, the random stream. The serial generator draws from it; a parallel
+ * 	generation only splits streams from it and leaves it unchanged
+ * post: graphIsFull(graph) holds and every room is reachable from every
+ * 	other. The result depends only on the stream, the graph's size and bounds,
+ * 	and threads
+ * ret: 0 on success, 1 if memory could not be allocated or the shards of a
+ * 	parallel generation could not be linked
+ */
+int connectRandomRooms(struct RoomGraph* graph, int threads, struct Rng* rng) {
+	struct OpenSlots slots;
+
+	if(threads > 1) {
+		return generateShards(graph, threads, rng);
+	}
+
+	/*Hang the rooms on a random tree first, so the maze is connected even when
+ * 		the bounds are too low for random pairing to join it up. Then, while
+ * 		the graph of rooms isn't full, randomly connect a new pair of rooms if
+ * 		it is valid to do so. Rewiring never disconnects the tree */
+	if(connectRandomTree(graph, 0, graph->numRooms, rng) != 0
+			|| initOpenSlots(&slots, graph, 0, graph->numRooms) != 0) {
+		return 1;
+	}
+	while(slots.unsatisfied > 0) {
+		addRandomConnection(graph, graph->numRooms, &slots, rng);
+	}
+	freeOpenSlots(&slots);
+	return 0;
+}
+
+/* Connects the rooms of one shard of a streamed maze (see chenhowa.stream.c),
+ * 	keeping connections free for the links to other shards
+ * Args: [1] graph, a RoomGraph with no connections yet. Its last ports rooms are
+ * 	placeholders, each standing for a room in another shard
+ * 	[2] ports, the number of placeholders
+ * 	[3] rng, the random stream to draw from
+ * pre: the shard has more rooms than minDegree and ports. If ports > 0, maxDegree >= 3
+ * post: the shard's rooms are joined into a random tree, so the shard is
+ * 	connected, then connected at random as in connectRandomRooms
+ * 	until each has minDegree to maxDegree connections, counting placeholders.
+ * 	Every placeholder is connected to exactly one room, both ways, and no room
+ * 	to more than one placeholder. A rewire may hand a placeholder to another
+ * 	room, but it never disconnects the shard
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+int connectStreamShard(struct RoomGraph* graph, int ports, struct Rng* rng) {
+	struct OpenSlots slots;
+	uint32_t count = graph->numRooms - ports;
+	uint32_t room;
+	int port;
+
+	if(connectRandomTree(graph, 0, count, rng) != 0) {
+		return 1;
+	}
+
+	/*About half the tree is leaves, so rooms with a slot for a placeholder are
+ * 	easy to find. The last link of a room holding one is it */
+	for(port = 0; port < ports; port++) {
+		do {
+			room = rngBounded(rng, count);
+		} while(!canAddConnection(graph, room) || roomLinks(graph, room)[graph->degrees[room] - 1] >= count);
+		connectRoom(graph, room, count + port);
+		connectRoom(graph, count + port, room);
+	}
+
+	/*Placeholders are outside the range, so they are never picked for a new connection */
+	if(initOpenSlots(&slots, graph, 0, count) != 0) {
+		return 1;
+	}
+	while(slots.unsatisfied > 0) {
+		addRandomConnection(graph, count, &slots, rng);
+	}
+	freeOpenSlots(&slots);
+	return 0;
+}
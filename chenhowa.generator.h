@@ -0,0 +1,18 @@
+/* Filename: chenhowa.generator.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Fills a RoomGraph with a random maze: one START_ROOM, one END_ROOM,
+ * 	and random two-way connections within the graph's degree bounds.
+ */
+
+#ifndef CHENHOWA_GENERATOR_H
+#define CHENHOWA_GENERATOR_H
+
+#include "chenhowa.roomgraph.h"
+#include "chenhowa.rng.h"
+
+void assignRandomTypes(struct RoomGraph* graph, struct Rng* rng);
+int connectRandomRooms(struct RoomGraph* graph, int threads, struct Rng* rng);
+int connectStreamShard(struct RoomGraph* graph, int ports, struct Rng* rng);
+
+#endif
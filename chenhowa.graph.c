@@ -0,0 +1,325 @@
+/* Filename: chenhowa.graph.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Breadth-first searches over the rooms of a Maze: a plain BFS, a
+ * 	bidirectional BFS that grows whichever side has the smaller frontier, and
+ * 	all-pairs distances for small mazes.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "chenhowa.graph.h"
+
+/* Allocates a bitset with every bit clear
+ * args: [1] bits, the Bitset to set up
+ * 	[2] numBits, the number of bits
+ * post: bits must be released with freeBitset
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+int initBitset(struct Bitset* bits, uint64_t numBits) {
+	bits->numBits = numBits;
+	bits->words = calloc((numBits + 63) / 64 + 1, sizeof(uint64_t));
+	return bits->words == NULL;
+}
+
+/*Frees the memory held by a Bitset */
+void freeBitset(struct Bitset* bits) {
+	free(bits->words);
+	bits->words = NULL;
+}
+
+/*Frees the memory held by a SearchSide */
+static void freeSearchSide(struct SearchSide* side) {
+	free(side->queue);
+	free(side->parent);
+	free(side->depth);
+	freeBitset(&side->reached);
+}
+
+/* Allocates the memory to search a maze
+ * args: [1] search, the GraphSearch to set up
+ * 	[2] maze, the maze to search. It must not change while search is used
+ * post: search must be released with freeGraphSearch
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+int initGraphSearch(struct GraphSearch* search, const struct Maze* maze) {
+	struct SearchSide* side;
+	int i;
+
+	memset(search, 0, sizeof(*search));
+	search->maze = maze;
+	for(i = 0; i < 2; i++) {
+		side = &search->sides[i];
+		side->queue = malloc((maze->numRooms + 1) * sizeof(uint32_t));
+		side->parent = malloc((maze->numRooms + 1) * sizeof(uint32_t));
+		side->depth = malloc((maze->numRooms + 1) * sizeof(uint32_t));
+		if(side->queue == NULL || side->parent == NULL || side->depth == NULL
+				|| initBitset(&side->reached, maze->numRooms) != 0) {
+			freeGraphSearch(search);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*Frees the memory held by a GraphSearch */
+void freeGraphSearch(struct GraphSearch* search) {
+	freeSearchSide(&search->sides[0]);
+	freeSearchSide(&search->sides[1]);
+}
+
+/*Sets up an empty Path */
+void initPath(struct Path* path) {
+	path->rooms = NULL;
+	path->length = NO_PATH;
+	path->capacity = 0;
+}
+
+/*Frees the memory held by a Path */
+void freePath(struct Path* path) {
+	free(path->rooms);
+	initPath(path);
+}
+
+/*Makes room in a path for a route of length steps. Returns 0 on success, 1 if
+ * memory could not be allocated */
+static int sizePath(struct Path* path, uint32_t length) {
+	uint32_t* grown;
+
+	if(length + 1 > path->capacity) {
+		grown = realloc(path->rooms, (length + 1) * sizeof(uint32_t));
+		if(grown == NULL) {
+			return 1;
+		}
+		path->rooms = grown;
+		path->capacity = length + 1;
+	}
+	path->length = length;
+	return 0;
+}
+
+/*Forgets every room a side reached in its last search. This costs as much as
+ * that search did, not as much as the whole maze */
+static void resetSide(struct SearchSide* side) {
+	uint32_t i;
+
+	for(i = 0; i < side->tail; i++) {
+		clearBit(&side->reached, side->queue[i]);
+	}
+	side->head = 0;
+	side->tail = 0;
+}
+
+/*Marks a room reached by a side, and queues it to be expanded */
+static void reachRoom(struct SearchSide* side, uint32_t room, uint32_t parent, uint32_t depth) {
+	setBit(&side->reached, room);
+	side->parent[room] = parent;
+	side->depth[room] = depth;
+	side->queue[side->tail] = room;
+	side->tail++;
+}
+
+/* Finds a shortest route between two rooms with a breadth-first search
+ * args: [1] search, memory set up for the maze to search
+ * 	[2] from, the room to start in
+ * 	[3] to, the room to reach
+ * 	[4] path, where to store the route
+ * post: path holds a shortest route from from to to, or has length NO_PATH if
+ * 	to can't be reached. search->reached counts the rooms the search reached
+ * ret: 0 on success, 1 if a room doesn't exist or memory could not be allocated
+ */
+int shortestPath(struct GraphSearch* search, uint32_t from, uint32_t to, struct Path* path) {
+	const struct Maze* maze = search->maze;
+	struct SearchSide* side = &search->sides[0];
+	const uint32_t* connections;
+	uint32_t room;
+	uint32_t next;
+	uint32_t step;
+	int i;
+
+	if(from >= maze->numRooms || to >= maze->numRooms) {
+		return 1;
+	}
+	resetSide(side);
+	reachRoom(side, from, NO_ROOM, 0);
+
+	/*Expand rooms in the order they were reached, until the target is reached */
+	while(side->head < side->tail && !testBit(&side->reached, to)) {
+		room = side->queue[side->head];
+		side->head++;
+		connections = mazeConnections(maze, room);
+		for(i = 0; i < maze->degrees[room]; i++) {
+			next = connections[i];
+			if(!testBit(&side->reached, next)) {
+				reachRoom(side, next, room, side->depth[room] + 1);
+			}
+		}
+	}
+	search->reached = side->tail;
+
+	if(!testBit(&side->reached, to)) {
+		path->length = NO_PATH;
+		return 0;
+	}
+
+	/*Follow the parents back from the target */
+	if(sizePath(path, side->depth[to]) != 0) {
+		return 1;
+	}
+	room = to;
+	for(step = path->length + 1; step > 0; step--) {
+		path->rooms[step - 1] = room;
+		room = side->parent[room];
+	}
+	return 0;
+}
+
+/* Finds a shortest route between two rooms by searching forward from one and
+ * 	backward from the other, one whole level at a time, always growing the side
+ * 	whose frontier is smaller
+ * args: [1] search, memory set up for the maze to search
+ * 	[2] from, the room to start in
+ * 	[3] to, the room to reach
+ * 	[4] path, where to store the route
+ * post: path holds a shortest route from from to to, or has length NO_PATH if
+ * 	to can't be reached. search->reached counts the rooms both sides reached
+ * ret: 0 on success, 1 if a room doesn't exist or memory could not be allocated
+ */
+int bidirectionalPath(struct GraphSearch* search, uint32_t from, uint32_t to, struct Path* path) {
+	const struct Maze* maze = search->maze;
+	struct SearchSide* forward = &search->sides[0];
+	struct SearchSide* backward = &search->sides[1];
+	struct SearchSide* side;
+	struct SearchSide* other;
+	const uint32_t* connections;
+	uint32_t levelEnd;
+	uint32_t room;
+	uint32_t next;
+	uint32_t best = NO_PATH;
+	uint32_t meetForward = NO_ROOM; /*last room on the forward half of the best route */
+	uint32_t meetBackward = NO_ROOM; /*first room on the backward half of the best route */
+	uint32_t step;
+	int i;
+
+	if(from >= maze->numRooms || to >= maze->numRooms) {
+		return 1;
+	}
+	resetSide(forward);
+	resetSide(backward);
+	reachRoom(forward, from, NO_ROOM, 0);
+	reachRoom(backward, to, NO_ROOM, 0);
+	if(from == to) {
+		best = 0;
+		meetForward = from;
+	}
+
+	while(best == NO_PATH && forward->head < forward->tail && backward->head < backward->tail) {
+		if(forward->tail - forward->head <= backward->tail - backward->head) {
+			side = forward;
+			other = backward;
+		} else {
+			side = backward;
+			other = forward;
+		}
+
+		/*Expand the whole level, so the shortest of the routes that meet in it is kept */
+		levelEnd = side->tail;
+		while(side->head < levelEnd) {
+			room = side->queue[side->head];
+			side->head++;
+			connections = mazeConnections(maze, room);
+			for(i = 0; i < maze->degrees[room]; i++) {
+				next = connections[i];
+				if(testBit(&other->reached, next)
+						&& side->depth[room] + 1 + other->depth[next] < best) {
+					best = side->depth[room] + 1 + other->depth[next];
+					meetForward = side == forward ? room : next;
+					meetBackward = side == forward ? next : room;
+				}
+				if(!testBit(&side->reached, next)) {
+					reachRoom(side, next, room, side->depth[room] + 1);
+				}
+			}
+		}
+	}
+	search->reached = forward->tail + backward->tail;
+
+	if(best == NO_PATH) {
+		path->length = NO_PATH;
+		return 0;
+	}
+	if(sizePath(path, best) != 0) {
+		return 1;
+	}
+
+	/*Follow the forward parents back to the start, then the backward parents on to the target */
+	room = meetForward;
+	for(step = forward->depth[meetForward] + 1; step > 0; step--) {
+		path->rooms[step - 1] = room;
+		room = forward->parent[room];
+	}
+	room = meetBackward;
+	for(step = forward->depth[meetForward] + 1; step <= best; step++) {
+		path->rooms[step] = room;
+		room = backward->parent[room];
+	}
+	return 0;
+}
+
+/* Finds the distance between every pair of rooms, with one BFS from each room
+ * args: [1] maze, a maze of at most ALL_PAIRS_LIMIT rooms
+ * 	[2] distances, where to store the table
+ * post: (*distances)[a * maze->numRooms + b] is the number of steps from room a to
+ * 	room b, or UNREACHABLE. The table must be freed
+ * ret: 0 on success, 1 if the maze is too large or memory could not be allocated
+ */
+int allPairsDistances(const struct Maze* maze, uint16_t** distances) {
+	uint32_t count = maze->numRooms;
+	uint16_t* table;
+	uint16_t* row;
+	uint32_t* queue;
+	const uint32_t* connections;
+	uint32_t head, tail;
+	uint32_t start;
+	uint32_t room;
+	int i;
+
+	*distances = NULL;
+	if(count > ALL_PAIRS_LIMIT) {
+		return 1;
+	}
+	table = malloc((size_t)count * count * sizeof(uint16_t) + 1);
+	queue = malloc((count + 1) * sizeof(uint32_t));
+	if(table == NULL || queue == NULL) {
+		free(table);
+		free(queue);
+		return 1;
+	}
+	memset(table, 0xFF, (size_t)count * count * sizeof(uint16_t));
+
+	/*Each row doubles as the visited set of its own search */
+	for(start = 0; start < count; start++) {
+		row = table + (size_t)start * count;
+		row[start] = 0;
+		queue[0] = start;
+		head = 0;
+		tail = 1;
+		while(head < tail) {
+			room = queue[head];
+			head++;
+			connections = mazeConnections(maze, room);
+			for(i = 0; i < maze->degrees[room]; i++) {
+				if(row[connections[i]] == UNREACHABLE) {
+					row[connections[i]] = row[room] + 1;
+					queue[tail] = connections[i];
+					tail++;
+				}
+			}
+		}
+	}
+
+	free(queue);
+	*distances = table;
+	return 0;
+}
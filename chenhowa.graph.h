@@ -0,0 +1,76 @@
+/* Filename: chenhowa.graph.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Shortest paths and reachability over the rooms of a Maze. Searches
+ * 	walk the integer links of the maze directly and mark rooms in bitsets.
+ * 	Connections are expected to be symmetric, as chenhowa.buildrooms makes them.
+ */
+
+#ifndef CHENHOWA_GRAPH_H
+#define CHENHOWA_GRAPH_H
+
+#include <stdint.h>
+
+#include "chenhowa.maze.h"
+
+#define NO_PATH UINT32_MAX /*path length meaning the target can't be reached */
+#define ALL_PAIRS_LIMIT 4096 /*largest maze allPairsDistances accepts */
+#define UNREACHABLE UINT16_MAX /*distance between rooms with no path between them */
+
+/*One bit per room */
+struct Bitset {
+	uint64_t* words;
+	uint64_t numBits;
+};
+
+/*Returns 1 if bit i is set */
+static inline int testBit(const struct Bitset* bits, uint64_t i) {
+	return (bits->words[i >> 6] >> (i & 63)) & 1;
+}
+
+/*Sets bit i */
+static inline void setBit(struct Bitset* bits, uint64_t i) {
+	bits->words[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+/*Clears bit i */
+static inline void clearBit(struct Bitset* bits, uint64_t i) {
+	bits->words[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+
+/*One direction of a search: the rooms it has reached, in the order it reached them */
+struct SearchSide {
+	uint32_t* queue; /*every room reached so far, in order */
+	uint32_t head; /*next room in queue to expand */
+	uint32_t tail; /*number of rooms in queue */
+	uint32_t* parent; /*room each room was reached from; valid for reached rooms only */
+	uint32_t* depth; /*steps from the search's origin; valid for reached rooms only */
+	struct Bitset reached;
+};
+
+/*Reusable memory for searching one maze. Setting up costs O(rooms), but each search
+ * afterwards only costs as much as the rooms it reaches */
+struct GraphSearch {
+	const struct Maze* maze;
+	struct SearchSide sides[2]; /*forward from the start, and backward from the target */
+	uint64_t reached; /*rooms reached by the last search, on both sides */
+};
+
+/*A route between two rooms */
+struct Path {
+	uint32_t* rooms; /*every room on the route, from the start to the target */
+	uint32_t length; /*steps on the route, one less than its rooms, or NO_PATH */
+	uint32_t capacity; /*entries rooms has space for */
+};
+
+int initBitset(struct Bitset* bits, uint64_t numBits);
+void freeBitset(struct Bitset* bits);
+int initGraphSearch(struct GraphSearch* search, const struct Maze* maze);
+void freeGraphSearch(struct GraphSearch* search);
+void initPath(struct Path* path);
+void freePath(struct Path* path);
+int shortestPath(struct GraphSearch* search, uint32_t from, uint32_t to, struct Path* path);
+int bidirectionalPath(struct GraphSearch* search, uint32_t from, uint32_t to, struct Path* path);
+int allPairsDistances(const struct Maze* maze, uint16_t** distances);
+
+#endif
@@ -0,0 +1,202 @@
+/* Filename: chenhowa.layoutbench.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Compares the memory footprint and traversal speed of the old
+ * 	fixed-size Room struct (names stored inline, connections stored as names)
+ * 	against the structure-of-arrays Maze used by chenhowa.adventure.
+ * Input: optional room count (default 1000000) and walk length (default 10000000)
+ * Output: one line per layout with its size, a full scan time and a random walk time
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "chenhowa.maze.h"
+#include "chenhowa.nametable.h"
+#include "chenhowa.timing.h"
+
+#define MAX_CONNECTIONS 6
+#define MIN_CONNECTIONS 3
+#define NAME_LEN 50
+#define SCAN_REPEATS 10
+
+/*The Room struct chenhowa.adventure used to read room files into */
+struct LegacyRoom {
+	char name[NAME_LEN];
+	char connections[MAX_CONNECTIONS][NAME_LEN];
+	int type;
+	int numConnections;
+};
+
+/*Small xorshift generator, so both layouts walk exactly the same path */
+static uint64_t nextRandom(uint64_t* state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/* Builds a random maze with the given number of rooms
+ * args: [1] maze, the Maze to create
+ * 	[2] count, the number of rooms
+ * post: every room has MIN_CONNECTIONS to MAX_CONNECTIONS random connections.
+ * 	Connections are not symmetric; only the shape of the data matters here
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+static int buildRandomMaze(struct Maze* maze, uint32_t count) {
+	uint64_t state = 88172645463325252ULL;
+	uint64_t numLinks = 0;
+	uint64_t namesSize = 0;
+	uint64_t link = 0;
+	uint64_t offset = 0;
+	uint8_t* degrees;
+	char name[NAME_LEN];
+	uint32_t i;
+	int j;
+
+	degrees = malloc(count);
+	if(degrees == NULL) {
+		return 1;
+	}
+	for(i = 0; i < count; i++) {
+		degrees[i] = MIN_CONNECTIONS + nextRandom(&state) % (MAX_CONNECTIONS - MIN_CONNECTIONS + 1);
+		numLinks += degrees[i];
+		namesSize += sprintf(name, "ROOM_%u", i + 1) + 1;
+	}
+
+	if(createMaze(maze, count, numLinks, namesSize) != 0) {
+		free(degrees);
+		return 1;
+	}
+
+	for(i = 0; i < count; i++) {
+		maze->nameOffsets[i] = offset;
+		offset += sprintf(maze->names + offset, "ROOM_%u", i + 1) + 1;
+		maze->types[i] = MID_ROOM;
+		maze->degrees[i] = degrees[i];
+		maze->linkStart[i] = link;
+		for(j = 0; j < degrees[i]; j++) {
+			maze->links[link] = nextRandom(&state) % count;
+			link++;
+		}
+	}
+	maze->types[count - 1] = END_ROOM;
+
+	free(degrees);
+	return 0;
+}
+
+/*Copies a maze into an array of LegacyRooms, the way room files used to be read */
+static void buildLegacyRooms(struct LegacyRoom* rooms, const struct Maze* maze) {
+	uint32_t i;
+	int j;
+
+	memset(rooms, 0, maze->numRooms * sizeof(struct LegacyRoom));
+	for(i = 0; i < maze->numRooms; i++) {
+		strcpy(rooms[i].name, mazeRoomName(maze, i));
+		rooms[i].type = maze->types[i];
+		rooms[i].numConnections = maze->degrees[i];
+		for(j = 0; j < maze->degrees[i]; j++) {
+			strcpy(rooms[i].connections[j], mazeRoomName(maze, mazeConnections(maze, i)[j]));
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	uint32_t count = 1000000;
+	uint64_t steps = 10000000;
+	struct Maze maze;
+	struct NameTable names;
+	struct LegacyRoom* rooms;
+	uint64_t state;
+	uint64_t step;
+	uint64_t checksum;
+	uint32_t cur;
+	uint32_t i;
+	int repeat;
+	double start;
+	double legacyScan, legacyWalk, soaScan, soaWalk;
+	size_t legacyBytes, soaBytes, tableBytes;
+
+	if(argc > 1) {
+		count = strtoul(argv[1], NULL, 10);
+	}
+	if(argc > 2) {
+		steps = strtoull(argv[2], NULL, 10);
+	}
+	if(count < 2) {
+		fprintf(stderr, "Usage: %s [rooms] [steps]\n", argv[0]);
+		return 1;
+	}
+
+	if(buildRandomMaze(&maze, count) != 0 || buildNameTable(&names, &maze) != 0) {
+		fprintf(stderr, "Could not allocate a maze of %u rooms\n", count);
+		return 1;
+	}
+	rooms = malloc(count * sizeof(struct LegacyRoom));
+	if(rooms == NULL) {
+		fprintf(stderr, "Could not allocate %u legacy rooms\n", count);
+		return 1;
+	}
+	buildLegacyRooms(rooms, &maze);
+
+	legacyBytes = count * sizeof(struct LegacyRoom);
+	soaBytes = maze.size;
+	tableBytes = (names.mask + 1) * sizeof(struct NameSlot);
+
+	/*Scan every room for its type and number of connections */
+	checksum = 0;
+	start = nowNs();
+	for(repeat = 0; repeat < SCAN_REPEATS; repeat++) {
+		for(i = 0; i < count; i++) {
+			checksum += rooms[i].numConnections + (rooms[i].type == END_ROOM);
+		}
+	}
+	legacyScan = (nowNs() - start) / ((double)count * SCAN_REPEATS);
+
+	start = nowNs();
+	for(repeat = 0; repeat < SCAN_REPEATS; repeat++) {
+		for(i = 0; i < count; i++) {
+			checksum -= maze.degrees[i] + (maze.types[i] == END_ROOM);
+		}
+	}
+	soaScan = (nowNs() - start) / ((double)count * SCAN_REPEATS);
+
+	/*Walk the same random path through both layouts. The legacy layout only
+ * 		knows connections by name, so every step needs a name lookup */
+	state = 2463534242ULL;
+	cur = 0;
+	start = nowNs();
+	for(step = 0; step < steps; step++) {
+		cur = lookupName(&names, rooms[cur].connections[nextRandom(&state) % rooms[cur].numConnections]);
+	}
+	legacyWalk = (nowNs() - start) / steps;
+	checksum += cur;
+
+	state = 2463534242ULL;
+	cur = 0;
+	start = nowNs();
+	for(step = 0; step < steps; step++) {
+		cur = mazeConnections(&maze, cur)[nextRandom(&state) % maze.degrees[cur]];
+	}
+	soaWalk = (nowNs() - start) / steps;
+	checksum -= cur;
+
+	printf("rooms: %u, walk steps: %llu\n", count, (unsigned long long)steps);
+	printf("%-8s %14s %12s %14s %14s\n", "layout", "bytes", "bytes/room", "scan ns/room", "walk ns/step");
+	printf("%-8s %14zu %12.1f %14.2f %14.2f\n", "legacy", legacyBytes, (double)legacyBytes / count, legacyScan, legacyWalk);
+	printf("%-8s %14zu %12.1f %14.2f %14.2f\n", "soa", soaBytes, (double)soaBytes / count, soaScan, soaWalk);
+	printf("(name table for command lookups: %zu bytes)\n", tableBytes);
+
+	/*Both layouts hold the same maze, so they must agree */
+	if(checksum != 0) {
+		fprintf(stderr, "Layouts disagree!\n");
+		return 1;
+	}
+
+	free(rooms);
+	freeNameTable(&names);
+	closeMaze(&maze);
+	return 0;
+}
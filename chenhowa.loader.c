@@ -0,0 +1,766 @@
+/* Filename: chenhowa.loader.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Reads the room files written by chenhowa.buildrooms into a
+ * 	structure-of-arrays MazeBuilder, then packs the builder into a Maze. Each
+ * 	room file is read whole and parsed in place, without stdio.
+ * 	A directory with a binary maze file is mapped instead of read.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "chenhowa.loader.h"
+#include "chenhowa.roomgraph.h"
+#include "chenhowa.stats.h"
+
+#define ROOM_CAPACITY 8 /*initial capacity of a builder's per-room arrays */
+#define ROOM_FILE_LEN 4096 /*initial size of a worker's room file buffer */
+#define QUOTE_LEN 40 /*most bytes of a bad line quoted in a parse error */
+#define ROOM_NAME_TAG "ROOM NAME: "
+#define CONNECTION_TAG "CONNECTION "
+#define ROOM_TYPE_TAG "ROOM TYPE: "
+#define PARSE_NAME 0 /*parser state: expecting the ROOM NAME line */
+#define PARSE_CONNECTIONS 1 /*parser state: expecting a CONNECTION or the ROOM TYPE line */
+#define PARSE_DONE 2 /*parser state: the ROOM TYPE line has been read */
+
+/*Names of the files in a rooms directory, back to back in one buffer */
+struct FileList {
+	uint64_t count; /*number of files */
+	uint64_t capacity; /*capacity of offsets */
+	uint64_t* offsets; /*offset of each file name in text */
+	uint64_t textSize; /*bytes used in text */
+	uint64_t textCapacity; /*capacity of text */
+	char* text; /*NUL terminated file names */
+};
+
+struct LoadJob;
+
+/*One worker's share of loading a rooms directory */
+struct LoadTask {
+	struct LoadJob* job; /*the load this task is part of */
+	int index; /*index of this task in job->tasks */
+	uint64_t firstFile; /*first file in job->files this worker reads */
+	uint64_t endFile; /*one past the last file this worker reads */
+	struct MazeBuilder builder; /*rooms read by this worker only */
+	char* buffer; /*contents of the room file being parsed, reused for every file */
+	size_t bufferSize; /*capacity of buffer */
+	uint32_t firstRoom; /*index of the builder's first room in the merged maze */
+	uint64_t firstLink; /*index of the builder's first link in the merged maze */
+	uint64_t firstName; /*offset of the builder's first name in the merged maze */
+	int result; /*0 if every step of this worker succeeded */
+};
+
+/*State shared by every worker loading one rooms directory */
+struct LoadJob {
+	const char* dirName; /*the rooms directory */
+	int dirFd; /*open descriptor of the rooms directory, for openat */
+	struct FileList files; /*room files to read */
+	struct LoadTask* tasks; /*one task per worker */
+	int numTasks; /*number of workers */
+	pthread_mutex_t startLock; /*held until the workers' shares and the barrier are set up */
+	pthread_barrier_t barrier; /*separates the phases of the load */
+	struct Maze* maze; /*merged maze */
+	struct NameTable* names; /*name table of the merged maze */
+	int failed; /*set by worker 0 when a serial step fails */
+};
+
+/*Reallocates an array to hold count elements of the given size.
+ * Returns 0 on success, 1 if memory could not be allocated */
+static int resizeArray(void** array, uint64_t count, size_t size) {
+	void* grown = realloc(*array, count * size);
+
+	if(grown == NULL) {
+		return 1;
+	}
+	*array = grown;
+	return 0;
+}
+
+/* Makes sure a growable array can hold at least needed elements
+ * args: [1] array, the address of the array pointer
+ * 	[2] capacity, the address of the array's capacity in elements
+ * 	[3] needed, the number of elements the array must hold
+ * 	[4] size, the size of one element
+ * post: capacity is doubled until it covers needed, and the array is reallocated
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+static int growArray(void** array, uint64_t* capacity, uint64_t needed, size_t size) {
+	uint64_t newCapacity = *capacity;
+
+	if(needed <= *capacity) {
+		return 0;
+	}
+	if(newCapacity == 0) {
+		newCapacity = ROOM_CAPACITY;
+	}
+	while(newCapacity < needed) {
+		newCapacity *= 2;
+	}
+
+	if(resizeArray(array, newCapacity, size) != 0) {
+		return 1;
+	}
+	*capacity = newCapacity;
+	return 0;
+}
+
+/*Copies a name of length bytes into a builder's text arena, NUL terminated, and
+ * returns its offset through offset. Returns 0 on success, 1 if memory could not be allocated */
+static int addText(struct MazeBuilder* builder, const char* name, size_t length, uint64_t* offset) {
+	if(growArray((void**)&builder->text, &builder->textCapacity, builder->textSize + length + 1, 1) != 0) {
+		return 1;
+	}
+	memcpy(builder->text + builder->textSize, name, length);
+	builder->text[builder->textSize + length] = '\0';
+	*offset = builder->textSize;
+	builder->textSize += length + 1;
+	return 0;
+}
+
+/*Starts a new room in a builder, named by the length bytes at name. Its type is
+ * unassigned and it has no connections. Returns 0 on success, 1 if memory could
+ * not be allocated */
+int addRoom(struct MazeBuilder* builder, const char* name, size_t length) {
+	uint32_t room = builder->numRooms;
+	uint64_t capacity;
+	uint64_t offset;
+
+	if(room == builder->roomCapacity) {
+		/*All of the per-room arrays grow together */
+		capacity = builder->roomCapacity == 0 ? ROOM_CAPACITY : builder->roomCapacity * 2;
+		if(resizeArray((void**)&builder->types, capacity, sizeof(uint8_t)) != 0
+				|| resizeArray((void**)&builder->degrees, capacity, sizeof(uint8_t)) != 0
+				|| resizeArray((void**)&builder->nameOffsets, capacity, sizeof(uint64_t)) != 0
+				|| resizeArray((void**)&builder->linkStart, capacity, sizeof(uint64_t)) != 0) {
+			return 1;
+		}
+		builder->roomCapacity = capacity;
+	}
+
+	if(addText(builder, name, length, &offset) != 0) {
+		return 1;
+	}
+	builder->nameOffsets[room] = offset;
+	builder->namesSize += length + 1;
+	builder->types[room] = 0;
+	builder->degrees[room] = 0;
+	builder->linkStart[room] = builder->numConnections;
+	builder->numRooms++;
+	return 0;
+}
+
+/*Adds a connection, by the room name in the length bytes at name, to the last room
+ * started in a builder. Returns 0 on success, 1 if the room has too many
+ * connections or memory could not be allocated */
+int addConnection(struct MazeBuilder* builder, const char* name, size_t length) {
+	uint32_t room = builder->numRooms - 1;
+	uint64_t offset;
+
+	if(builder->degrees[room] == UINT8_MAX) {
+		fprintf(stderr, "ERROR: room %s has too many connections\n", builder->text + builder->nameOffsets[room]);
+		return 1;
+	}
+	if(growArray((void**)&builder->connections, &builder->connectionCapacity,
+			builder->numConnections + 1, sizeof(uint64_t)) != 0) {
+		return 1;
+	}
+	if(addText(builder, name, length, &offset) != 0) {
+		return 1;
+	}
+	builder->connections[builder->numConnections] = offset;
+	builder->numConnections++;
+	builder->degrees[room]++;
+	return 0;
+}
+
+/*Initializes an empty MazeBuilder */
+void initMazeBuilder(struct MazeBuilder* builder) {
+	memset(builder, 0, sizeof(*builder));
+}
+
+/*Frees the memory held by a MazeBuilder and leaves it empty */
+void freeMazeBuilder(struct MazeBuilder* builder) {
+	free(builder->types);
+	free(builder->degrees);
+	free(builder->nameOffsets);
+	free(builder->linkStart);
+	free(builder->connections);
+	free(builder->text);
+	initMazeBuilder(builder);
+}
+
+/*Reports a room file that doesn't follow the room file grammar, quoting the start
+ * of the offending line */
+static void parseError(const char* fileName, int lineNumber, const char* problem,
+		const char* line, const char* lineEnd) {
+	int shown = lineEnd - line < QUOTE_LEN ? (int)(lineEnd - line) : QUOTE_LEN;
+
+	fprintf(stderr, "Error. %s:%i: %s: \"%.*s%s\"\n", fileName, lineNumber, problem,
+		shown, line, lineEnd - line > QUOTE_LEN ? "..." : "");
+}
+
+/*Returns 1 if the line from line to lineEnd starts with the tagLength bytes of tag */
+static int startsWith(const char* line, const char* lineEnd, const char* tag, size_t tagLength) {
+	return (size_t)(lineEnd - line) >= tagLength && memcmp(line, tag, tagLength) == 0;
+}
+
+/* Parses the text of one room file into a builder, in a single pass. The grammar
+ * 	is the one chenhowa.buildrooms writes, one item per line:
+ * 	"ROOM NAME: <name>", then "CONNECTION <n>: <name>" for n = 1, 2, ..., then
+ * 	"ROOM TYPE: <START_ROOM|MID_ROOM|END_ROOM>". Blank lines are skipped
+ * args: [1] text, the contents of the room file. It need not be NUL terminated
+ *	[2] length, the number of bytes in text
+ *	[3] fileName, the name of the room file, for error messages
+ *	[4] builder, the MazeBuilder to add the room to
+ * post: the room has been added to the builder as a new room. Names are copied
+ * 	straight from text into the builder's arena; nothing else is allocated
+ * ret: 0 on success, 1 if the text breaks the grammar (the file and line are
+ * 	reported) or memory could not be allocated
+ */
+int parseRoom(const char* text, size_t length, const char* fileName, struct MazeBuilder* builder) {
+	const char* end = text + length;
+	const char* line;
+	const char* lineEnd;
+	const char* name;
+	const char* colon;
+	int lineNumber = 0;
+	int state = PARSE_NAME;
+	int number;
+	uint32_t room = 0;
+
+	for(line = text; line < end; line = lineEnd + 1) {
+		lineEnd = memchr(line, '\n', end - line);
+		if(lineEnd == NULL) {
+			lineEnd = end;
+		}
+		lineNumber++;
+		if(lineEnd == line) {
+			continue;
+		}
+
+		if(state == PARSE_NAME) {
+			/*The first line names the room */
+			name = line + sizeof(ROOM_NAME_TAG) - 1;
+			if(!startsWith(line, lineEnd, ROOM_NAME_TAG, sizeof(ROOM_NAME_TAG) - 1)) {
+				parseError(fileName, lineNumber, "expected ROOM NAME", line, lineEnd);
+				return 1;
+			}
+			if(!isRoomName(name, lineEnd - name)) {
+				parseError(fileName, lineNumber, "bad room name", line, lineEnd);
+				return 1;
+			}
+			if(addRoom(builder, name, lineEnd - name) != 0) {
+				return 1;
+			}
+			room = builder->numRooms - 1;
+			state = PARSE_CONNECTIONS;
+		} else if(state == PARSE_CONNECTIONS && startsWith(line, lineEnd, CONNECTION_TAG, sizeof(CONNECTION_TAG) - 1)) {
+			/*Connections are numbered from 1, in order, and end with a colon */
+			number = 0;
+			for(colon = line + sizeof(CONNECTION_TAG) - 1; colon < lineEnd && *colon >= '0' && *colon <= '9'
+					&& number <= UINT8_MAX; colon++) {
+				number = number * 10 + (*colon - '0');
+			}
+			if(number != builder->degrees[room] + 1) {
+				parseError(fileName, lineNumber, "connections must be numbered 1, 2, ... in order", line, lineEnd);
+				return 1;
+			}
+			if(lineEnd - colon < 2 || colon[0] != ':' || colon[1] != ' ') {
+				parseError(fileName, lineNumber, "expected \": \" after the connection number", line, lineEnd);
+				return 1;
+			}
+			name = colon + 2;
+			if(!isRoomName(name, lineEnd - name)) {
+				parseError(fileName, lineNumber, "bad connection name", line, lineEnd);
+				return 1;
+			}
+			if(addConnection(builder, name, lineEnd - name) != 0) {
+				return 1;
+			}
+		} else if(state == PARSE_CONNECTIONS && startsWith(line, lineEnd, ROOM_TYPE_TAG, sizeof(ROOM_TYPE_TAG) - 1)) {
+			/*The type ends the room */
+			name = line + sizeof(ROOM_TYPE_TAG) - 1;
+			if(lineEnd - name == sizeof("MID_ROOM") - 1 && memcmp(name, "MID_ROOM", lineEnd - name) == 0) {
+				builder->types[room] = MID_ROOM;
+			} else if(lineEnd - name == sizeof("START_ROOM") - 1 && memcmp(name, "START_ROOM", lineEnd - name) == 0) {
+				builder->types[room] = START_ROOM;
+			} else if(lineEnd - name == sizeof("END_ROOM") - 1 && memcmp(name, "END_ROOM", lineEnd - name) == 0) {
+				builder->types[room] = END_ROOM;
+			} else {
+				parseError(fileName, lineNumber, "unknown room type", line, lineEnd);
+				return 1;
+			}
+			state = PARSE_DONE;
+		} else if(state == PARSE_CONNECTIONS) {
+			parseError(fileName, lineNumber, "expected CONNECTION or ROOM TYPE", line, lineEnd);
+			return 1;
+		} else {
+			parseError(fileName, lineNumber, "unexpected text after ROOM TYPE", line, lineEnd);
+			return 1;
+		}
+	}
+
+	if(state != PARSE_DONE) {
+		fprintf(stderr, "Error. %s:%i: expected %s, found the end of the file\n", fileName, lineNumber + 1,
+			state == PARSE_NAME ? "ROOM NAME" : "ROOM TYPE");
+		return 1;
+	}
+	return 0;
+}
+
+/* Lists the room files in an open rooms directory
+ * args: [1] dirToCheck, the open rooms directory
+ * 	[2] files, the FileList to fill in
+ * post: files holds the name of every entry except . and .., in directory order.
+ * 	It must be released with freeFileList
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+static int listRoomFiles(DIR* dirToCheck, struct FileList* files) {
+	struct dirent *fileInDir; /*Hold current file in the rooms directory */
+	size_t length;
+
+	memset(files, 0, sizeof(*files));
+
+	fileInDir = readdir(dirToCheck);
+	while(fileInDir != NULL) {
+		/*We care about every file except the . and .. files */
+		if(strcmp(fileInDir->d_name, ".") != 0 && strcmp(fileInDir->d_name, "..") != 0  ) {
+			length = strlen(fileInDir->d_name) + 1;
+			if(growArray((void**)&files->offsets, &files->capacity, files->count + 1, sizeof(uint64_t)) != 0
+					|| growArray((void**)&files->text, &files->textCapacity, files->textSize + length, 1) != 0) {
+				return 1;
+			}
+			memcpy(files->text + files->textSize, fileInDir->d_name, length);
+			files->offsets[files->count] = files->textSize;
+			files->textSize += length;
+			files->count++;
+		}
+		/*Get the next room file */
+		fileInDir = readdir(dirToCheck);
+	}
+
+	return 0;
+}
+
+/*Frees the memory held by a FileList */
+static void freeFileList(struct FileList* files) {
+	free(files->offsets);
+	free(files->text);
+	memset(files, 0, sizeof(*files));
+}
+
+/*Reads a whole room file into a task's buffer, growing it if the file doesn't fit.
+ * Returns the number of bytes read, or -1 if the file could not be read */
+static ssize_t readRoomFile(struct LoadTask* task, int roomFd) {
+	size_t length = 0;
+	ssize_t result;
+	char* grown;
+
+	while(1) {
+		if(length == task->bufferSize) {
+			grown = realloc(task->buffer, task->bufferSize ? 2 * task->bufferSize : ROOM_FILE_LEN);
+			if(grown == NULL) {
+				return -1;
+			}
+			task->buffer = grown;
+			task->bufferSize = task->bufferSize ? 2 * task->bufferSize : ROOM_FILE_LEN;
+		}
+		result = read(roomFd, task->buffer + length, task->bufferSize - length);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result < 0) {
+			return -1;
+		}
+		if(result == 0) {
+			return length;
+		}
+		length += result;
+	}
+}
+
+/*Reads a task's share of the room files into the task's own builder.
+ * Returns 0 on success, 1 if a room file could not be opened or read */
+static int readRoomFiles(struct LoadTask* task) {
+	struct LoadJob* job = task->job;
+	const char* fileName;
+	int roomFd;
+	ssize_t length;
+	uint64_t i;
+	STATS_TIMER(started);
+
+	for(i = task->firstFile; i < task->endFile; i++) {
+		fileName = job->files.text + job->files.offsets[i];
+
+		/*Read the whole room file into the task's buffer, then parse it from there */
+		STATS_START(started);
+		roomFd = openat(job->dirFd, fileName, O_RDONLY);
+		if(roomFd < 0) {
+			fprintf(stderr, "Error. Attempt to open room file %s/%s failed\n", job->dirName, fileName);
+			return 1;
+		}
+		length = readRoomFile(task, roomFd);
+		close(roomFd);
+		if(length < 0) {
+			fprintf(stderr, "Error. Couldn't read room file %s/%s\n", job->dirName, fileName);
+			return 1;
+		}
+		STATS_STOP(STAT_READ, started);
+
+		STATS_START(started);
+		if(parseRoom(task->buffer, length, fileName, &task->builder) != 0) {
+			fprintf(stderr, "Error. Couldn't read room file %s/%s\n", job->dirName, fileName);
+			return 1;
+		}
+		STATS_STOP(STAT_PARSE, started);
+	}
+
+	return 0;
+}
+
+/* Gives every task's builder its place in the merged maze, then creates the maze
+ * args: [1] job, a LoadJob whose tasks have all finished reading
+ * post: each task knows the index of its first room, link and name byte, and
+ * 	the maze has room for every builder
+ * ret: 0 on success, 1 if a task failed or memory could not be allocated
+ */
+static int placeBuilders(struct LoadJob* job) {
+	uint64_t numRooms = 0;
+	uint64_t numLinks = 0;
+	uint64_t namesSize = 0;
+	int i;
+
+	for(i = 0; i < job->numTasks; i++) {
+		if(job->tasks[i].result != 0) {
+			return 1;
+		}
+		job->tasks[i].firstRoom = numRooms;
+		job->tasks[i].firstLink = numLinks;
+		job->tasks[i].firstName = namesSize;
+		numRooms += job->tasks[i].builder.numRooms;
+		numLinks += job->tasks[i].builder.numConnections;
+		namesSize += job->tasks[i].builder.namesSize;
+	}
+
+	if(numRooms >= NO_ROOM) {
+		fprintf(stderr, "Error. Too many rooms in %s\n", job->dirName);
+		return 1;
+	}
+	if(createMaze(job->maze, numRooms, numLinks, namesSize) != 0) {
+		fprintf(stderr, "Error. Couldn't allocate the maze\n");
+		return 1;
+	}
+	return 0;
+}
+
+/*Copies the types, degrees, link starts and names of a task's builder into its
+ * part of the merged maze. Tasks write to disjoint parts, so no lock is needed */
+static void copyBuilder(struct LoadTask* task) {
+	struct MazeBuilder* builder = &task->builder;
+	struct Maze* maze = task->job->maze;
+	uint64_t nameOffset = task->firstName;
+	uint32_t room = task->firstRoom;
+	size_t length;
+	uint32_t i;
+
+	memcpy(maze->types + room, builder->types, builder->numRooms);
+	memcpy(maze->degrees + room, builder->degrees, builder->numRooms);
+	for(i = 0; i < builder->numRooms; i++) {
+		maze->linkStart[room + i] = task->firstLink + builder->linkStart[i];
+
+		/*Only the room names are copied, not the connection names */
+		length = strlen(builder->text + builder->nameOffsets[i]) + 1;
+		memcpy(maze->names + nameOffset, builder->text + builder->nameOffsets[i], length);
+		maze->nameOffsets[room + i] = nameOffset;
+		nameOffset += length;
+	}
+}
+
+/*Turns the connection names of a task's builder into room indices in its part of
+ * the merged maze. Returns 0 on success, 1 if a connection names a missing room */
+static int resolveBuilder(struct LoadTask* task) {
+	struct MazeBuilder* builder = &task->builder;
+	struct Maze* maze = task->job->maze;
+	uint64_t link;
+	uint32_t target;
+	uint32_t i;
+
+	for(i = 0; i < builder->numRooms; i++) {
+		for(link = builder->linkStart[i]; link < builder->linkStart[i] + builder->degrees[i]; link++) {
+			target = lookupName(task->job->names, builder->text + builder->connections[link]);
+			if(target == NO_ROOM) {
+				fprintf(stderr, "Error. Room %s connects to missing room %s\n",
+					builder->text + builder->nameOffsets[i], builder->text + builder->connections[link]);
+				return 1;
+			}
+			maze->links[task->firstLink + link] = target;
+		}
+	}
+
+	return 0;
+}
+
+/* Runs one worker of a LoadJob. Every worker reads its own share of the room
+ * files into its own builder; the builders are then merged in place
+ * args: [1] arg, the worker's LoadTask
+ * post: task->result is 0 if every step this worker ran succeeded
+ * ret: NULL
+ *
+ * Workers only ever write to their own builder and to their own part of the maze,
+ * so the only synchronization is the barrier between phases. Worker 0 also does
+ * the serial steps: placing the builders and building the name table.
+ */
+static void* loadWorker(void* arg) {
+	struct LoadTask* task = arg;
+	struct LoadJob* job = task->job;
+
+	/*Wait until every worker that could be started has its share of the files */
+	pthread_mutex_lock(&job->startLock);
+	pthread_mutex_unlock(&job->startLock);
+
+	task->result = readRoomFiles(task);
+
+	pthread_barrier_wait(&job->barrier);
+	if(task->index == 0) {
+		job->failed = placeBuilders(job);
+	}
+	pthread_barrier_wait(&job->barrier);
+	if(job->failed) {
+		return NULL;
+	}
+
+	copyBuilder(task);
+
+	pthread_barrier_wait(&job->barrier);
+	if(task->index == 0) {
+		job->failed = buildNameTable(job->names, job->maze);
+	}
+	pthread_barrier_wait(&job->barrier);
+	if(job->failed) {
+		return NULL;
+	}
+
+	task->result = resolveBuilder(task);
+	return NULL;
+}
+
+/* Finds the newest rooms directory in the current working directory
+ * args: [1] dirName, buffer for the directory's name
+ * 	[2] size, the size of dirName
+ * post: dirName holds the target of the LATEST_LINK_NAME symlink if it points to
+ * 	a directory. Otherwise every entry of the current directory whose name
+ * 	contains ROOMS_DIR_PREFIX is checked, and dirName holds the one that was
+ * 	modified last
+ * ret: 0 on success, 1 if there is no rooms directory
+ *
+ * The directory manipulation code used here is DIRECTLY based on the code
+ * provided in the Reading Notes for CS 344 on Canvas
+ */
+int findNewestRoomsDir(char* dirName, size_t size) {
+	long newestDirTime = -1;
+	int cwdFd; /*Holds my starting directory */
+	DIR* dirToCheck;
+	struct dirent *fileInDir; /*Hold current file in starting directory */
+	struct stat dirAttributes; /*Holds info from stat call on fileInDir */
+	ssize_t length;
+
+	memset(dirName, '\0', size);
+
+	/*chenhowa.buildrooms keeps a symlink to the directory it made last */
+	length = readlink(LATEST_LINK_NAME, dirName, size - 1);
+	if(length > 0 && (size_t)length < size - 1) {
+		dirName[length] = '\0';
+		if(stat(dirName, &dirAttributes) == 0 && S_ISDIR(dirAttributes.st_mode)) {
+			return 0;
+		}
+	}
+	memset(dirName, '\0', size);
+
+	/*The link is missing or stale, so fall back to scanning for the newest directory */
+	cwdFd = open(".", O_RDONLY | O_DIRECTORY);
+	if(cwdFd < 0) {
+		fprintf(stderr, "Error. Couldn't open current working directory");
+		return 1;
+	}
+	dirToCheck = fdopendir(cwdFd);
+	if(!dirToCheck) {
+		fprintf(stderr, "Error. Couldn't open current working directory");
+		close(cwdFd);
+		return 1;
+	}
+
+	/*check every entry in the directory to see if it contains the prefix*/
+	fileInDir = readdir(dirToCheck);
+	while(fileInDir != NULL) {
+		/*If the entry has the prefix in its name and might be a directory, get its
+ * 			attributes relative to the open directory */
+		if(strstr(fileInDir->d_name, ROOMS_DIR_PREFIX) != NULL
+				&& (fileInDir->d_type == DT_DIR || fileInDir->d_type == DT_UNKNOWN)
+				&& strlen(fileInDir->d_name) < size
+				&& fstatat(cwdFd, fileInDir->d_name, &dirAttributes, AT_SYMLINK_NOFOLLOW) == 0
+				&& S_ISDIR(dirAttributes.st_mode)) {
+
+			if( (long)dirAttributes.st_mtime > newestDirTime ) {
+				/*if this entry was created later, then it is the newest directory
+ * 					with the desired prefix*/
+				newestDirTime = (long)dirAttributes.st_mtime;
+				strcpy(dirName, fileInDir->d_name);
+			}
+		}
+
+		fileInDir = readdir(dirToCheck);
+	}
+
+	/*After examining all the MATCHING files in the current directory, close it */
+	closedir(dirToCheck);
+
+	if(newestDirTime < 0) {
+		fprintf(stderr, "Error. Couldn't find a %s directory\n", ROOMS_DIR_PREFIX);
+		return 1;
+	}
+	return 0;
+}
+
+/* Reads every room file in a rooms directory into a maze
+ * args: [1] dirName, the rooms directory
+ *	[2] maze, the Maze to create
+ *	[3] names, the NameTable to build for the maze
+ *	[4] threads, the number of worker threads to read with
+ * post: the room files are split evenly across the workers, in directory order.
+ * 	If some workers can't be started, the files are split across the ones that
+ * 	were. maze must be released with closeMaze, and names with freeNameTable
+ * ret: 0 on success, 1 if the directory or a room file could not be read
+ */
+int loadTextMaze(const char* dirName, struct Maze* maze, struct NameTable* names, int threads) {
+	DIR* dirToCheck; /*Holds the rooms directory */
+	struct LoadJob job;
+	pthread_t* workers;
+	int started;
+	int result = 0;
+	int i;
+
+	dirToCheck = opendir(dirName);
+	if(!dirToCheck) {
+		fprintf(stderr, "Error. Couldn't open NEWEST directory");
+		return 1;
+	}
+
+	memset(maze, 0, sizeof(*maze));
+	memset(&job, 0, sizeof(job));
+	job.dirName = dirName;
+	job.dirFd = dirfd(dirToCheck);
+	job.maze = maze;
+	job.names = names;
+	if(listRoomFiles(dirToCheck, &job.files) != 0) {
+		fprintf(stderr, "Error. Couldn't list the room files in %s\n", dirName);
+		freeFileList(&job.files);
+		closedir(dirToCheck);
+		return 1;
+	}
+
+	/*No point in having workers without files to read */
+	if(threads < 1) {
+		threads = 1;
+	}
+	if((uint64_t)threads > job.files.count && job.files.count > 0) {
+		threads = job.files.count;
+	}
+
+	job.tasks = calloc(threads, sizeof(struct LoadTask));
+	workers = calloc(threads, sizeof(pthread_t));
+	if(job.tasks == NULL || workers == NULL) {
+		free(job.tasks);
+		free(workers);
+		freeFileList(&job.files);
+		closedir(dirToCheck);
+		return 1;
+	}
+
+	for(i = 0; i < threads; i++) {
+		job.tasks[i].job = &job;
+		job.tasks[i].index = i;
+		initMazeBuilder(&job.tasks[i].builder);
+	}
+
+	/*The calling thread acts as worker 0. The workers wait on startLock, so the
+ * 	files and the barrier can be split across only the ones that started */
+	pthread_mutex_init(&job.startLock, NULL);
+	pthread_mutex_lock(&job.startLock);
+	for(started = 1; started < threads; started++) {
+		if(pthread_create(workers + started, NULL, loadWorker, job.tasks + started) != 0) {
+			break;
+		}
+	}
+	job.numTasks = started;
+	for(i = 0; i < started; i++) {
+		job.tasks[i].firstFile = job.files.count * i / started;
+		job.tasks[i].endFile = job.files.count * (i + 1) / started;
+	}
+	pthread_barrier_init(&job.barrier, NULL, started);
+	pthread_mutex_unlock(&job.startLock);
+
+	loadWorker(job.tasks);
+	for(i = 1; i < started; i++) {
+		pthread_join(workers[i], NULL);
+	}
+	pthread_barrier_destroy(&job.barrier);
+	pthread_mutex_destroy(&job.startLock);
+
+	for(i = 0; i < threads; i++) {
+		if(job.tasks[i].result != 0) {
+			result = 1;
+		}
+		freeMazeBuilder(&job.tasks[i].builder);
+		free(job.tasks[i].buffer);
+	}
+	if(job.failed) {
+		result = 1;
+	} else if(result != 0) {
+		freeNameTable(names);
+	}
+	if(result != 0 && maze->base != NULL) {
+		closeMaze(maze);
+	}
+
+	free(job.tasks);
+	free(workers);
+	freeFileList(&job.files);
+	closedir(dirToCheck);
+	return result;
+}
+
+/* Loads the maze in a rooms directory and interns its room names
+ * args: [1] dirName, the rooms directory
+ *	[2] maze, the Maze to set up
+ *	[3] names, the NameTable to build for the maze
+ *	[4] threads, the number of threads to read room files with
+ * post: if the directory has a binary maze file, maze is a read-only mapping
+ * 	of it. Otherwise maze was built from the directory's room files.
+ * 	Either way, maze must be released with closeMaze, and names with freeNameTable
+ * ret: 0 on success, 1 if the maze could not be loaded
+ */
+int loadMaze(const char* dirName, struct Maze* maze, struct NameTable* names, int threads) {
+	char fileName[512];
+
+	snprintf(fileName, sizeof(fileName), "%s/%s", dirName, MAZE_FILE_NAME);
+	if(access(fileName, F_OK) == 0) {
+		if(openMaze(maze, fileName) != 0) {
+			return 1;
+		}
+		if(buildNameTable(names, maze) != 0) {
+			closeMaze(maze);
+			return 1;
+		}
+		return 0;
+	}
+
+	return loadTextMaze(dirName, maze, names, threads);
+}
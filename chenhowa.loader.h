@@ -0,0 +1,46 @@
+/* Filename: chenhowa.loader.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Loads the maze in a rooms directory for chenhowa.adventure, either
+ * 	by mapping its binary maze file or by reading its room files with a pool
+ * 	of worker threads.
+ */
+
+#ifndef CHENHOWA_LOADER_H
+#define CHENHOWA_LOADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chenhowa.maze.h"
+#include "chenhowa.nametable.h"
+
+/*Growable structure-of-arrays that room files are read into before they become
+ * a Maze. Room names and connection names share one text arena, and connections
+ * stay names until every room is known */
+struct MazeBuilder {
+	uint32_t numRooms; /*number of rooms read so far */
+	uint64_t roomCapacity; /*capacity of the per-room arrays */
+	uint8_t* types; /*type of each room */
+	uint8_t* degrees; /*number of connections of each room */
+	uint64_t* nameOffsets; /*offset of each room's name in text */
+	uint64_t* linkStart; /*index of each room's first connection in connections */
+	uint64_t numConnections; /*number of connections read so far */
+	uint64_t connectionCapacity; /*capacity of connections */
+	uint64_t* connections; /*offset of each connection's room name in text */
+	uint64_t namesSize; /*bytes taken by room names (not connection names) in text */
+	uint64_t textSize; /*bytes used in text */
+	uint64_t textCapacity; /*capacity of text */
+	char* text; /*NUL terminated names, back to back */
+};
+
+void initMazeBuilder(struct MazeBuilder* builder);
+void freeMazeBuilder(struct MazeBuilder* builder);
+int addRoom(struct MazeBuilder* builder, const char* name, size_t length);
+int addConnection(struct MazeBuilder* builder, const char* name, size_t length);
+int parseRoom(const char* text, size_t length, const char* fileName, struct MazeBuilder* builder);
+int findNewestRoomsDir(char* dirName, size_t size);
+int loadTextMaze(const char* dirName, struct Maze* maze, struct NameTable* names, int threads);
+int loadMaze(const char* dirName, struct Maze* maze, struct NameTable* names, int threads);
+
+#endif
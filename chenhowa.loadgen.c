@@ -0,0 +1,359 @@
+/* Filename: chenhowa.loadgen.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Load generator for the chenhowa.adventure server. Each client
+ * 	thread plays sessions back to back, picking a random connection at every
+ * 	room, and times every move from sending the room name to receiving the reply.
+ * Input: -s <socket> (required), -c <clients> (default 4), -n <sessions> (default 10000),
+ * 	-m <max moves per session> (default 1000), -r <seed> (default 1)
+ * Output: sessions per second, moves per second, and move and session latency percentiles
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "chenhowa.server.h"
+#include "chenhowa.timing.h"
+
+#define MAX_WORDS 64 /*most words a ROOM line is split into */
+
+/*Growable array of timing samples */
+struct Samples {
+	double* values;
+	size_t count;
+	size_t capacity;
+};
+
+/*Settings shared by every client, and the next session to play */
+struct LoadSettings {
+	const char* socketPath;
+	unsigned long sessions; /*sessions to play in total */
+	unsigned long maxMoves; /*moves after which a session is abandoned */
+	unsigned int seed;
+	unsigned long nextSession; /*claimed with an atomic add */
+};
+
+/*One client thread and its results */
+struct Client {
+	pthread_t thread;
+	struct LoadSettings* settings;
+	unsigned int seed; /*rand_r state */
+	struct Samples moveLatency; /*ns from sending a move to receiving its reply */
+	struct Samples sessionLatency; /*ns from connecting to the END line */
+	unsigned long completed; /*sessions that reached the END_ROOM */
+	unsigned long abandoned; /*sessions given up after maxMoves */
+	unsigned long failed; /*sessions lost to a socket or protocol error */
+	unsigned long long moves;
+	unsigned long long rejected; /*moves answered with HUH */
+};
+
+/*A connection to the server, and the bytes received but not yet returned as lines */
+struct Connection {
+	int fd;
+	char buffer[SERVER_LINE_LEN];
+	size_t start; /*first unreturned byte in buffer */
+	size_t length; /*bytes used in buffer */
+};
+
+/*Appends a sample, growing the array when it is full. Returns 1 if memory ran out */
+static int addSample(struct Samples* samples, double value) {
+	double* grown;
+
+	if(samples->count == samples->capacity) {
+		grown = realloc(samples->values, (samples->capacity ? 2 * samples->capacity : 1024) * sizeof(double));
+		if(grown == NULL) {
+			return 1;
+		}
+		samples->values = grown;
+		samples->capacity = samples->capacity ? 2 * samples->capacity : 1024;
+	}
+	samples->values[samples->count] = value;
+	samples->count++;
+	return 0;
+}
+
+/*Appends every sample of from to to. Returns 1 if memory ran out */
+static int mergeSamples(struct Samples* to, const struct Samples* from) {
+	size_t i;
+
+	for(i = 0; i < from->count; i++) {
+		if(addSample(to, from->values[i]) != 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*Connects to the server. Returns 0 on success, 1 on failure */
+static int openConnection(struct Connection* connection, const char* path) {
+	struct sockaddr_un address;
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+	connection->start = 0;
+	connection->length = 0;
+	connection->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(connection->fd < 0) {
+		return 1;
+	}
+	if(connect(connection->fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+		close(connection->fd);
+		return 1;
+	}
+	return 0;
+}
+
+/* Reads the next line the server sent
+ * args: [1] connection, an open connection
+ * post: the newline is replaced by a NUL. The line stays valid until the next call
+ * ret: the line, or NULL if the server hung up, the socket failed, or the line
+ * 	is longer than SERVER_LINE_LEN
+ */
+static char* readLine(struct Connection* connection) {
+	char* line;
+	char* end;
+	ssize_t received;
+
+	while(1) {
+		line = connection->buffer + connection->start;
+		end = memchr(line, '\n', connection->length - connection->start);
+		if(end != NULL) {
+			*end = '\0';
+			connection->start = end + 1 - connection->buffer;
+			return line;
+		}
+
+		/*Move the partial line to the front, and read more after it */
+		connection->length -= connection->start;
+		memmove(connection->buffer, line, connection->length);
+		connection->start = 0;
+		if(connection->length == sizeof(connection->buffer)) {
+			return NULL;
+		}
+		received = read(connection->fd, connection->buffer + connection->length,
+			sizeof(connection->buffer) - connection->length);
+		if(received < 0 && errno == EINTR) {
+			continue;
+		}
+		if(received <= 0) {
+			return NULL;
+		}
+		connection->length += received;
+	}
+}
+
+/*Sends all of text. Returns 0 on success, 1 on failure */
+static int sendAll(int fd, const char* text, size_t length) {
+	ssize_t sent;
+
+	while(length > 0) {
+		sent = send(fd, text, length, MSG_NOSIGNAL);
+		if(sent < 0 && errno == EINTR) {
+			continue;
+		}
+		if(sent <= 0) {
+			return 1;
+		}
+		text += sent;
+		length -= sent;
+	}
+	return 0;
+}
+
+/*Splits line into space separated words. Returns the number of words */
+static int splitWords(char* line, char* words[MAX_WORDS]) {
+	int count = 0;
+	char* save;
+	char* word;
+
+	for(word = strtok_r(line, " ", &save); word != NULL && count < MAX_WORDS;
+			word = strtok_r(NULL, " ", &save)) {
+		words[count] = word;
+		count++;
+	}
+	return count;
+}
+
+/* Plays one session, moving to a random connection until the END_ROOM is reached
+ * args: [1] client, the client playing it
+ * post: the client's counters and samples are updated
+ * ret: none
+ */
+static void playSession(struct Client* client) {
+	struct Connection connection;
+	char move[SERVER_LINE_LEN + 1];
+	char* words[MAX_WORDS];
+	char* line;
+	int count;
+	int length;
+	unsigned long moves;
+	double start;
+	double sent;
+
+	start = nowNs();
+	if(openConnection(&connection, client->settings->socketPath) != 0) {
+		client->failed++;
+		return;
+	}
+	line = readLine(&connection);
+
+	for(moves = 0; line != NULL; moves++) {
+		if(strncmp(line, "END ", 4) == 0) {
+			addSample(&client->sessionLatency, nowNs() - start);
+			client->completed++;
+			close(connection.fd);
+			return;
+		}
+		if(moves == client->settings->maxMoves) {
+			client->abandoned++;
+			close(connection.fd);
+			return;
+		}
+
+		count = splitWords(line, words);
+		if(count < 3 || strcmp(words[0], "ROOM") != 0) {
+			break;
+		}
+		length = snprintf(move, sizeof(move), "%s\n", words[2 + rand_r(&client->seed) % (count - 2)]);
+
+		sent = nowNs();
+		if(sendAll(connection.fd, move, length) != 0) {
+			break;
+		}
+		line = readLine(&connection);
+		addSample(&client->moveLatency, nowNs() - sent);
+		client->moves++;
+
+		/*Moves are always to a listed connection, so HUH means the server is confused */
+		if(line != NULL && strcmp(line, "HUH") == 0) {
+			client->rejected++;
+			break;
+		}
+	}
+
+	client->failed++;
+	close(connection.fd);
+}
+
+/* Description: body of every client thread. Claims sessions until all have been played
+ * Args: [1] args, the Client
+ * ret: NULL
+ */
+static void* runClient(void* args) {
+	struct Client* client = args;
+
+	while(__atomic_fetch_add(&client->settings->nextSession, 1, __ATOMIC_RELAXED) < client->settings->sessions) {
+		playSession(client);
+	}
+	return NULL;
+}
+
+/*Prints the percentiles of samples, in microseconds */
+static void printLatency(const char* label, struct Samples* samples) {
+	sortSamples(samples->values, samples->count);
+	printf("%s latency (us): p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n", label,
+		percentile(samples->values, samples->count, 0.50) / 1e3,
+		percentile(samples->values, samples->count, 0.90) / 1e3,
+		percentile(samples->values, samples->count, 0.99) / 1e3,
+		percentile(samples->values, samples->count, 1.0) / 1e3);
+}
+
+int main(int argc, char* argv[]) {
+	struct LoadSettings settings;
+	struct Client* clients;
+	struct Samples moveLatency;
+	struct Samples sessionLatency;
+	unsigned long completed = 0, abandoned = 0, failed = 0;
+	unsigned long long moves = 0, rejected = 0;
+	int numClients = 4;
+	int started;
+	int i;
+	int opt;
+	double start;
+	double elapsed;
+
+	memset(&settings, 0, sizeof(settings));
+	settings.sessions = 10000;
+	settings.maxMoves = 1000;
+	settings.seed = 1;
+	while((opt = getopt(argc, argv, "s:c:n:m:r:")) != -1) {
+		switch(opt) {
+			case 's': settings.socketPath = optarg;
+			break;
+			case 'c': numClients = atoi(optarg);
+			break;
+			case 'n': settings.sessions = strtoul(optarg, NULL, 10);
+			break;
+			case 'm': settings.maxMoves = strtoul(optarg, NULL, 10);
+			break;
+			case 'r': settings.seed = strtoul(optarg, NULL, 10);
+			break;
+			default:
+				settings.socketPath = NULL;
+				numClients = 0;
+		}
+	}
+	if(settings.socketPath == NULL || numClients < 1) {
+		fprintf(stderr, "Usage: %s -s socket [-c clients] [-n sessions] [-m max moves] [-r seed]\n", argv[0]);
+		return 1;
+	}
+
+	clients = calloc(numClients, sizeof(struct Client));
+	if(clients == NULL) {
+		fprintf(stderr, "Error. Couldn't allocate %d clients\n", numClients);
+		return 1;
+	}
+
+	start = nowNs();
+	for(started = 0; started < numClients; started++) {
+		clients[started].settings = &settings;
+		clients[started].seed = settings.seed + started;
+		if(pthread_create(&clients[started].thread, NULL, runClient, &clients[started]) != 0) {
+			fprintf(stderr, "Error. Only %d of %d clients started\n", started, numClients);
+			break;
+		}
+	}
+	for(i = 0; i < started; i++) {
+		pthread_join(clients[i].thread, NULL);
+	}
+	elapsed = nowNs() - start;
+
+	/*Merge every client's results */
+	memset(&moveLatency, 0, sizeof(moveLatency));
+	memset(&sessionLatency, 0, sizeof(sessionLatency));
+	for(i = 0; i < started; i++) {
+		completed += clients[i].completed;
+		abandoned += clients[i].abandoned;
+		failed += clients[i].failed;
+		moves += clients[i].moves;
+		rejected += clients[i].rejected;
+		if(mergeSamples(&moveLatency, &clients[i].moveLatency) != 0
+				|| mergeSamples(&sessionLatency, &clients[i].sessionLatency) != 0) {
+			fprintf(stderr, "Error. Couldn't merge the latency samples\n");
+			return 1;
+		}
+		free(clients[i].moveLatency.values);
+		free(clients[i].sessionLatency.values);
+	}
+
+	printf("clients: %d, sessions: %lu (%lu reached the END_ROOM, %lu abandoned, %lu failed)\n",
+		started, completed + abandoned + failed, completed, abandoned, failed);
+	printf("moves: %llu (%llu not understood)\n", moves, rejected);
+	printf("elapsed: %.6f s\n", elapsed / 1e9);
+	printf("sessions per second: %.0f\n", elapsed > 0 ? (completed + abandoned) / (elapsed / 1e9) : 0.0);
+	printf("moves per second: %.0f\n", elapsed > 0 ? moves / (elapsed / 1e9) : 0.0);
+	printLatency("move", &moveLatency);
+	printLatency("session", &sessionLatency);
+
+	free(moveLatency.values);
+	free(sessionLatency.values);
+	free(clients);
+	return failed > 0;
+}
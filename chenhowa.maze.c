@@ -0,0 +1,610 @@
+/* Filename: chenhowa.maze.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Creates, writes and maps binary maze files. See chenhowa.maze.h
+ * 	for the layout of the format.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+
+#include "chenhowa.maze.h"
+
+/*Rounds offset up to the next multiple of align, which must be a power of two */
+static uint64_t alignUp(uint64_t offset, uint64_t align) {
+	return (offset + align - 1) & ~(align - 1);
+}
+
+/* Fills in the counts and array offsets of a header. A writer that streams a
+ * 	maze to its file, rather than building its image, lays it out with this
+ * args: [1] header, the header to fill in
+ * 	[2] numRooms, [3] numLinks, [4] namesSize, the sizes of the maze arrays
+ * post: every offset is aligned for its array, and fileSize covers the whole maze
+ * ret: none
+ */
+void layoutMaze(struct MazeHeader* header, uint64_t numRooms, uint64_t numLinks, uint64_t namesSize) {
+	uint64_t offset;
+
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, MAZE_MAGIC, sizeof(header->magic));
+	header->version = MAZE_VERSION;
+	header->byteOrder = MAZE_BYTE_ORDER;
+	header->numRooms = numRooms;
+	header->numLinks = numLinks;
+	header->namesSize = namesSize;
+
+	offset = alignUp(sizeof(struct MazeHeader), 8);
+	header->linkStartOffset = offset;
+	offset += numRooms * sizeof(uint64_t);
+	header->nameOffsetsOffset = offset;
+	offset += numRooms * sizeof(uint64_t);
+	header->nameOrderOffset = offset;
+	offset += numRooms * sizeof(uint32_t);
+	header->typesOffset = offset;
+	offset += numRooms;
+	header->degreesOffset = offset;
+	offset += numRooms;
+	header->namesOffset = offset;
+	offset += namesSize;
+	offset = alignUp(offset, sizeof(uint32_t));
+	header->linksOffset = offset;
+	offset += numLinks * sizeof(uint32_t);
+	header->fileSize = offset;
+}
+
+/*Points the arrays of a maze into its image, using the offsets in its header */
+static void bindMaze(struct Maze* maze) {
+	char* base = maze->base;
+	struct MazeHeader* header = maze->base;
+
+	maze->header = header;
+	maze->numRooms = (uint32_t)header->numRooms;
+	maze->numLinks = header->numLinks;
+	maze->linkStart = (uint64_t*)(base + header->linkStartOffset);
+	maze->nameOffsets = (uint64_t*)(base + header->nameOffsetsOffset);
+	maze->nameOrder = (uint32_t*)(base + header->nameOrderOffset);
+	maze->types = (uint8_t*)(base + header->typesOffset);
+	maze->degrees = (uint8_t*)(base + header->degreesOffset);
+	maze->names = base + header->namesOffset;
+	maze->links = (uint32_t*)(base + header->linksOffset);
+}
+
+/* Allocates an empty maze image that a generator or loader can fill in
+ * args: [1] maze, the Maze to set up
+ * 	[2] numRooms, the number of rooms
+ * 	[3] numLinks, the total number of links, two per connection
+ * 	[4] namesSize, the bytes needed for every name and its NUL terminator
+ * pre: numRooms must fit below NO_ROOM
+ * post: the header is complete and every array is zeroed. The caller fills in
+ * 	linkStart, nameOffsets, types, degrees, names and links. A maze that will
+ * 	be written to a file then needs its nameOrder from sortMazeNames
+ * post: the maze must be released with closeMaze
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+int createMaze(struct Maze* maze, uint32_t numRooms, uint64_t numLinks, uint64_t namesSize) {
+	struct MazeHeader header;
+
+	layoutMaze(&header, numRooms, numLinks, namesSize);
+
+	memset(maze, 0, sizeof(*maze));
+	maze->base = calloc(1, header.fileSize);
+	if(maze->base == NULL) {
+		return 1;
+	}
+	maze->size = header.fileSize;
+	maze->mapped = 0;
+	memcpy(maze->base, &header, sizeof(header));
+	bindMaze(maze);
+
+	return 0;
+}
+
+/* Writes a maze image to a binary maze file
+ * args: [1] maze, a filled in Maze
+ * 	[2] path, the file to create or replace
+ * post: the file holds an exact copy of the image
+ * ret: 0 on success, 1 if the file could not be written
+ */
+int writeMaze(const struct Maze* maze, const char* path) {
+	int fd;
+	size_t written = 0;
+	ssize_t result;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) {
+		fprintf(stderr, "Could not open %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	/*Write the whole image, picking up where a short write left off */
+	while(written < maze->size) {
+		result = write(fd, (char*)maze->base + written, maze->size - written);
+		if(result < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			fprintf(stderr, "Could not write %s: %s\n", path, strerror(errno));
+			close(fd);
+			return 1;
+		}
+		written += result;
+	}
+
+	if(close(fd) != 0) {
+		fprintf(stderr, "Could not write %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+/*Returns 1 if an array of count elements of the given size, starting at offset,
+ * is aligned and lies entirely within a file of fileSize bytes */
+static int arrayFits(uint64_t offset, uint64_t count, uint64_t size, uint64_t fileSize) {
+	if(offset % size != 0 || offset > fileSize) {
+		return 0;
+	}
+	return count <= (fileSize - offset) / size;
+}
+
+/* Checks one room of a maze whose header has been checked
+ * args: [1] maze, a Maze from openMaze, readMaze or openMazeForUpdate
+ * 	[2] room, a room below maze->numRooms
+ * ret: 1 if the room's name and links are inside the image and it links only
+ * 	to rooms of the maze, 0 otherwise
+ */
+int mazeRoomFits(const struct Maze* maze, uint32_t room) {
+	const uint32_t* connections;
+	int j;
+
+	if(maze->nameOffsets[room] >= maze->header->namesSize || maze->linkStart[room] > maze->numLinks
+			|| maze->degrees[room] > maze->numLinks - maze->linkStart[room]) {
+		return 0;
+	}
+	connections = mazeConnections(maze, room);
+	for(j = 0; j < maze->degrees[room]; j++) {
+		if(connections[j] >= maze->numRooms) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*Returns 1 if every room of a bound maze passes mazeRoomFits, and nameOrder
+ * holds only rooms of the maze, 0 otherwise */
+static int roomsFit(const struct Maze* maze) {
+	uint32_t i;
+
+	for(i = 0; i < maze->numRooms; i++) {
+		if(!mazeRoomFits(maze, i) || maze->nameOrder[i] >= maze->numRooms) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Checks that a maze image is a maze: its header describes arrays that really
+ * 	are in it, and, if asked, every room's name and links are inside those arrays
+ * args: [1] maze, a Maze whose base and size hold the image
+ * 	[2] path, the image's file, for error messages
+ * 	[3] checkRooms, 1 to check every room, 0 to leave each room to be checked
+ * 	with mazeRoomFits before it is used
+ * post: on success the maze arrays point into the image, so mazeRoomName and
+ * 	mazeConnections stay inside it for every room that was checked. Otherwise
+ * 	the image is released with closeMaze
+ * ret: 0 if the image is a maze, 1 if it isn't
+ */
+static int checkImage(struct Maze* maze, const char* path, int checkRooms) {
+	struct MazeHeader* header = maze->base;
+	uint64_t size = maze->size;
+
+	if(memcmp(header->magic, MAZE_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != MAZE_VERSION
+			|| header->byteOrder != MAZE_BYTE_ORDER
+			|| header->fileSize != size
+			|| header->numRooms >= NO_ROOM
+			|| !arrayFits(header->linkStartOffset, header->numRooms, sizeof(uint64_t), size)
+			|| !arrayFits(header->nameOffsetsOffset, header->numRooms, sizeof(uint64_t), size)
+			|| !arrayFits(header->nameOrderOffset, header->numRooms, sizeof(uint32_t), size)
+			|| !arrayFits(header->typesOffset, header->numRooms, 1, size)
+			|| !arrayFits(header->degreesOffset, header->numRooms, 1, size)
+			|| !arrayFits(header->namesOffset, header->namesSize, 1, size)
+			|| !arrayFits(header->linksOffset, header->numLinks, sizeof(uint32_t), size)
+			/*A NUL at the end of the name table ends every name that starts inside it */
+			|| (header->numRooms > 0 && (header->namesSize == 0
+				|| ((char*)maze->base)[header->namesOffset + header->namesSize - 1] != '\0'))) {
+		fprintf(stderr, "Error. %s is not a valid maze file\n", path);
+		closeMaze(maze);
+		return 1;
+	}
+
+	bindMaze(maze);
+	if(checkRooms && !roomsFit(maze)) {
+		fprintf(stderr, "Error. %s is not a valid maze file\n", path);
+		closeMaze(maze);
+		return 1;
+	}
+	return 0;
+}
+
+/*Takes a flock on a file, trying again if a signal cuts the wait short. Returns 0 on success, 1 otherwise */
+static int lockFile(int fd, int operation) {
+	int result;
+
+	do {
+		result = flock(fd, operation);
+	} while(result != 0 && errno == EINTR);
+	return result != 0;
+}
+
+/* Maps an opened binary maze file
+ * args: [1] maze, the Maze to set up
+ * 	[2] fd, the opened file, with a flock on it
+ * 	[3] path, the file's path, for error messages
+ * 	[4] shared, 1 to map the file shared, so writes to it show through, and
+ * 	check only its header; 0 for a private mapping checked in full
+ * post: see openMaze. The maze takes fd, and closes it when it is released
+ * 	with closeMaze, or at once if the file can't be mapped
+ * ret: 0 on success, 1 if the file could not be mapped or is not a maze file
+ */
+static int mapMaze(struct Maze* maze, int fd, const char* path, int shared) {
+	struct stat info;
+	uint64_t size;
+
+	memset(maze, 0, sizeof(*maze));
+	if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(struct MazeHeader)) {
+		fprintf(stderr, "Error. %s is not a maze file\n", path);
+		close(fd);
+		return 1;
+	}
+
+	size = info.st_size;
+	maze->base = mmap(NULL, size, PROT_READ, shared ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+	if(maze->base == MAP_FAILED) {
+		fprintf(stderr, "Error. Could not map %s: %s\n", path, strerror(errno));
+		maze->base = NULL;
+		close(fd);
+		return 1;
+	}
+	maze->size = size;
+	maze->mapped = 1;
+	maze->fd = fd;
+
+	/*Make sure every array the header describes, and every room, is really in the file */
+	return checkImage(maze, path, !shared);
+}
+
+/* Maps a binary maze file so it can be used in place
+ * args: [1] maze, the Maze to set up
+ * 	[2] path, the binary maze file
+ * pre: path was written by writeMaze
+ * post: the maze arrays point into a read-only mapping of the file. The header,
+ * 	and every room's name and links, are checked in one pass; the arrays are
+ * 	used exactly as they are on disk. The file keeps a shared flock until the
+ * 	maze is released, so chenhowa.mazeedit won't patch it under the mapping
+ * post: the maze must be released with closeMaze
+ * ret: 0 on success, 1 if the file could not be mapped or is not a maze file
+ */
+int openMaze(struct Maze* maze, const char* path) {
+	int fd;
+
+	memset(maze, 0, sizeof(*maze));
+	fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		return 1;
+	}
+	if(lockFile(fd, LOCK_SH) != 0) {
+		fprintf(stderr, "Error. Could not lock %s: %s\n", path, strerror(errno));
+		close(fd);
+		return 1;
+	}
+	return mapMaze(maze, fd, path, 0);
+}
+
+/* Reads a binary maze file into memory of its own, instead of mapping it
+ * args: [1] maze, the Maze to set up
+ * 	[2] path, the binary maze file
+ * post: the maze is a private copy of the file, so nothing that later happens
+ * 	to the file shows through it. The file is held with a shared flock only
+ * 	while it is read.
+ * 	The maze must be released with closeMaze
+ * ret: 0 on success, 1 if the file could not be read or is not a maze file
+ */
+int readMaze(struct Maze* maze, const char* path) {
+	struct stat info;
+	size_t length = 0;
+	ssize_t result;
+	int fd;
+
+	memset(maze, 0, sizeof(*maze));
+	fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		return 1;
+	}
+
+	/*The shared flock keeps an edit from patching the file while it is read */
+	if(lockFile(fd, LOCK_SH) != 0) {
+		fprintf(stderr, "Error. Could not lock %s: %s\n", path, strerror(errno));
+		close(fd);
+		return 1;
+	}
+	if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(struct MazeHeader)) {
+		fprintf(stderr, "Error. %s is not a maze file\n", path);
+		close(fd);
+		return 1;
+	}
+	maze->base = malloc(info.st_size);
+	if(maze->base == NULL) {
+		fprintf(stderr, "Error. Couldn't allocate %lld bytes for %s\n", (long long)info.st_size, path);
+		close(fd);
+		return 1;
+	}
+	maze->size = info.st_size;
+	maze->mapped = 0;
+
+	/*Read the whole file, picking up where a short read left off */
+	while(length < maze->size) {
+		result = read(fd, (char*)maze->base + length, maze->size - length);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result <= 0) {
+			fprintf(stderr, "Error. Could not read %s\n", path);
+			close(fd);
+			closeMaze(maze);
+			return 1;
+		}
+		length += result;
+	}
+	close(fd);
+
+	return checkImage(maze, path, 1);
+}
+
+/*Writes all of a block of memory to a file at an offset. Returns 0 on success, 1 on error */
+static int writeAt(int fd, const void* data, size_t size, uint64_t offset) {
+	ssize_t result;
+
+	while(size > 0) {
+		result = pwrite(fd, data, size, offset);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result <= 0) {
+			return 1;
+		}
+		data = (const char*)data + result;
+		size -= result;
+		offset += result;
+	}
+	return 0;
+}
+
+/* Opens a binary maze file so chenhowa.mazeedit can patch it, without reading
+ * 	any more of it than its header
+ * args: [1] maze, the Maze to set up
+ * 	[2] path, the binary maze file
+ * 	[3] exclusive, set to 1 if the file got an exclusive flock, so no reader
+ * 	has it open and it may be patched in place. It is set to 0 if a reader
+ * 	has it mapped; the file then gets a shared flock, and must be copied and
+ * 	the copy patched instead
+ * post: the maze arrays point into a shared, read-only mapping of the file, so
+ * 	writes from appendMazeLinks and writeMazeRoom show through. Only the header
+ * 	has been checked: each room must pass mazeRoomFits before it is used.
+ * 	The maze must be released with closeMaze, which drops the flock
+ * ret: 0 on success, 1 if the file could not be opened, locked or mapped or is
+ * 	not a maze file
+ */
+int openMazeForUpdate(struct Maze* maze, const char* path, int* exclusive) {
+	int fd;
+
+	memset(maze, 0, sizeof(*maze));
+	fd = open(path, O_RDWR);
+	if(fd < 0) {
+		fprintf(stderr, "Error. Could not open %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+
+	/*Wait out another edit, but not a reader, which may hold its mapping for good */
+	*exclusive = lockFile(fd, LOCK_EX | LOCK_NB) == 0;
+	if(!*exclusive && (errno != EWOULDBLOCK || lockFile(fd, LOCK_SH) != 0)) {
+		fprintf(stderr, "Error. Could not lock %s: %s\n", path, strerror(errno));
+		close(fd);
+		return 1;
+	}
+	return mapMaze(maze, fd, path, 1);
+}
+
+/* Grows the links array of a maze opened with openMazeForUpdate. links is the
+ * 	last array of the file, so nothing else moves
+ * args: [1] maze, the Maze to grow, whose file has an exclusive flock
+ * 	[2] count, the number of links to add
+ * 	[3] first, set to the index of the first new link
+ * post: the file is count links longer, and its header counts them. The maze
+ * 	is remapped, so pointers into the old image are no longer valid. The new
+ * 	links are zero until writeMazeRoom fills them in
+ * ret: 0 on success, 1 if the file could not be grown or remapped
+ */
+int appendMazeLinks(struct Maze* maze, uint64_t count, uint64_t* first) {
+	struct MazeHeader header = *maze->header;
+	uint64_t size = maze->size + count * sizeof(uint32_t);
+	void* base;
+
+	header.numLinks += count;
+	header.fileSize = size;
+	if(ftruncate(maze->fd, size) != 0 || writeAt(maze->fd, &header, sizeof(header), 0) != 0) {
+		fprintf(stderr, "Error. Could not grow the maze file: %s\n", strerror(errno));
+		return 1;
+	}
+	base = mmap(NULL, size, PROT_READ, MAP_SHARED, maze->fd, 0);
+	if(base == MAP_FAILED) {
+		fprintf(stderr, "Error. Could not map the maze file: %s\n", strerror(errno));
+		return 1;
+	}
+	munmap(maze->base, maze->size);
+	maze->base = base;
+	maze->size = size;
+
+	*first = maze->numLinks;
+	bindMaze(maze);
+	return 0;
+}
+
+/* Stores one room's record in a maze opened with openMazeForUpdate
+ * args: [1] maze, the Maze, whose file has an exclusive flock
+ * 	[2] room, the room to store
+ * 	[3] type, [4] degree, the room's type and number of links
+ * 	[5] linkStart, the room's first link, in its old block or one from appendMazeLinks
+ * 	[6] links, the room's degree links
+ * post: the links are written first, then the room's linkStart, degree and type
+ * ret: 0 on success, 1 if the file could not be written
+ */
+int writeMazeRoom(const struct Maze* maze, uint32_t room, int type, int degree, uint64_t linkStart,
+		const uint32_t* links) {
+	const struct MazeHeader* header = maze->header;
+	uint8_t typeByte = type;
+	uint8_t degreeByte = degree;
+
+	if(writeAt(maze->fd, links, degree * sizeof(uint32_t), header->linksOffset + linkStart * sizeof(uint32_t)) != 0
+			|| writeAt(maze->fd, &linkStart, sizeof(linkStart),
+				header->linkStartOffset + (uint64_t)room * sizeof(uint64_t)) != 0
+			|| writeAt(maze->fd, &degreeByte, 1, header->degreesOffset + room) != 0
+			|| writeAt(maze->fd, &typeByte, 1, header->typesOffset + room) != 0) {
+		fprintf(stderr, "Error. Could not write the maze file: %s\n", strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+/*Releases the image of a maze from createMaze, openMaze, readMaze or
+ * openMazeForUpdate, and the flock on a mapped maze's file */
+void closeMaze(struct Maze* maze) {
+	if(maze->base != NULL) {
+		if(maze->mapped) {
+			munmap(maze->base, maze->size);
+			close(maze->fd);
+		} else {
+			free(maze->base);
+		}
+	}
+	memset(maze, 0, sizeof(*maze));
+}
+
+/*Returns the order of two rooms of a maze by name, as strcmp does */
+static int compareRooms(const struct Maze* maze, uint32_t a, uint32_t b) {
+	return strcmp(mazeRoomName(maze, a), mazeRoomName(maze, b));
+}
+
+/* Fills in the nameOrder of a maze, with a merge sort of its rooms by name
+ * args: [1] maze, a Maze whose names and nameOffsets are filled in
+ * post: nameOrder holds every room, in the strcmp order of their names
+ * ret: 0 on success, 1 if memory could not be allocated or two rooms share a
+ * 	name (a message is printed)
+ */
+int sortMazeNames(struct Maze* maze) {
+	uint32_t numRooms = maze->numRooms;
+	uint32_t* from = maze->nameOrder;
+	uint32_t* to;
+	uint32_t* swap;
+	uint32_t* scratch;
+	uint64_t width;
+	uint64_t left;
+	uint64_t middle;
+	uint64_t right;
+	uint64_t a;
+	uint64_t b;
+	uint64_t k;
+	uint32_t i;
+
+	scratch = malloc(((size_t)numRooms + 1) * sizeof(uint32_t));
+	if(scratch == NULL) {
+		fprintf(stderr, "Error. Couldn't allocate the room name index\n");
+		return 1;
+	}
+	to = scratch;
+	for(i = 0; i < numRooms; i++) {
+		from[i] = i;
+	}
+
+	/*Merge runs of width rooms into runs of twice that, back and forth between the arrays */
+	for(width = 1; width < numRooms; width *= 2) {
+		for(left = 0; left < numRooms; left += 2 * width) {
+			middle = left + width < numRooms ? left + width : numRooms;
+			right = left + 2 * width < numRooms ? left + 2 * width : numRooms;
+			for(a = left, b = middle, k = left; k < right; k++) {
+				if(a < middle && (b == right || compareRooms(maze, from[a], from[b]) <= 0)) {
+					to[k] = from[a++];
+				} else {
+					to[k] = from[b++];
+				}
+			}
+		}
+		swap = from;
+		from = to;
+		to = swap;
+	}
+	if(from != maze->nameOrder) {
+		memcpy(maze->nameOrder, from, (size_t)numRooms * sizeof(uint32_t));
+	}
+	free(scratch);
+
+	/*Rooms that share a name end up side by side */
+	for(i = 1; i < numRooms; i++) {
+		if(compareRooms(maze, maze->nameOrder[i - 1], maze->nameOrder[i]) == 0) {
+			fprintf(stderr, "Error. More than one room is named %s\n", mazeRoomName(maze, maze->nameOrder[i]));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Finds a room by name, with a binary search of nameOrder. Only the rooms
+ * 	the search passes through are read, and each is checked first, so this
+ * 	is safe on a maze from openMazeForUpdate
+ * args: [1] maze, a Maze whose nameOrder was filled in by sortMazeNames
+ * 	[2] name, the name to look for
+ * ret: the room with that name, or NO_ROOM if there is none
+ */
+uint32_t findMazeRoom(const struct Maze* maze, const char* name) {
+	uint32_t low = 0;
+	uint32_t high = maze->numRooms;
+	uint32_t middle;
+	uint32_t room;
+	int order;
+
+	while(low < high) {
+		middle = low + (high - low) / 2;
+		room = maze->nameOrder[middle];
+		if(room >= maze->numRooms || maze->nameOffsets[room] >= maze->header->namesSize) {
+			return NO_ROOM;
+		}
+		order = strcmp(name, mazeRoomName(maze, room));
+		if(order == 0) {
+			return room;
+		}
+		if(order < 0) {
+			high = middle;
+		} else {
+			low = middle + 1;
+		}
+	}
+	return NO_ROOM;
+}
+
+/*Returns the index of the first room of the given type, or NO_ROOM if there is none */
+uint32_t findRoomOfType(const struct Maze* maze, int type) {
+	uint32_t i;
+
+	for(i = 0; i < maze->numRooms; i++) {
+		if(maze->types[i] == type) {
+			return i;
+		}
+	}
+	return NO_ROOM;
+}
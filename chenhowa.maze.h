@@ -0,0 +1,109 @@
+/* Filename: chenhowa.maze.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Single-file binary maze format shared by chenhowa.buildrooms and
+ * 	chenhowa.adventure. A maze file is a header followed by flat arrays:
+ *
+ * 	MazeHeader
+ * 	linkStart[numRooms]	(uint64) index of each room's first link in links
+ * 	nameOffsets[numRooms]	(uint64) offset of each room's name in names
+ * 	nameOrder[numRooms]	(uint32) every room, in the strcmp order of their names
+ * 	types[numRooms]		(uint8) START_ROOM, MID_ROOM or END_ROOM
+ * 	degrees[numRooms]	(uint8) number of links of each room
+ * 	names[namesSize]	NUL terminated room names, back to back
+ * 	links[numLinks]		(uint32) index of each connected room
+ *
+ * 	Room i is connected to links[linkStart[i]] .. links[linkStart[i] + degrees[i] - 1].
+ * 	nameOrder lets a room be found by name with a binary search, without
+ * 	reading every name. links may also hold slots no room points at:
+ * 	chenhowa.mazeedit moves a room that gains connections to a new block at the
+ * 	end of the file.
+ * 	chenhowa.mazeedit patches a maze file in place. Every reader holds a shared
+ * 	flock on the file while it reads or maps it, and an edit only writes to a
+ * 	file it holds an exclusive flock on; a maze someone has mapped is copied,
+ * 	patched, and renamed over instead.
+ * 	Every field is stored in host byte order, and every array starts at an
+ * 	offset aligned for its element type, so a mapped file can be used in place.
+ */
+
+#ifndef CHENHOWA_MAZE_H
+#define CHENHOWA_MAZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define START_ROOM 1
+#define MID_ROOM 2
+#define END_ROOM 3
+
+#define MAZE_FILE_NAME "maze.bin" /*name of the binary maze inside a rooms directory */
+#define ROOMS_DIR_PREFIX "chenhowa.rooms." /*prefix of every rooms directory */
+#define LATEST_LINK_NAME "chenhowa.latest" /*symlink to the newest rooms directory */
+#define MAZE_MAGIC "CHMAZE\0\0"
+#define MAZE_VERSION 2
+#define MAZE_BYTE_ORDER 0x01020304 /*reads back differently on a foreign byte order */
+#define NO_ROOM UINT32_MAX /*room index meaning "no such room" */
+
+/*Header at the start of every binary maze file. Offsets are from the start of the file */
+struct MazeHeader {
+	char magic[8]; /*MAZE_MAGIC */
+	uint32_t version; /*MAZE_VERSION */
+	uint32_t byteOrder; /*MAZE_BYTE_ORDER */
+	uint64_t numRooms; /*number of rooms */
+	uint64_t numLinks; /*number of entries in links: two per connection, plus any unused slots */
+	uint64_t namesSize; /*bytes in the name table */
+	uint64_t linkStartOffset;
+	uint64_t nameOffsetsOffset;
+	uint64_t nameOrderOffset;
+	uint64_t typesOffset;
+	uint64_t degreesOffset;
+	uint64_t namesOffset;
+	uint64_t linksOffset;
+	uint64_t fileSize; /*total size of the maze in bytes */
+};
+
+/*A maze held in one contiguous image, either mapped from a file or allocated.
+ * The array pointers point straight into the image */
+struct Maze {
+	struct MazeHeader* header;
+	uint32_t numRooms;
+	uint64_t numLinks;
+	uint64_t* linkStart;
+	uint64_t* nameOffsets;
+	uint32_t* nameOrder;
+	uint8_t* types;
+	uint8_t* degrees;
+	char* names;
+	uint32_t* links;
+	void* base; /*start of the image */
+	size_t size; /*size of the image in bytes */
+	int mapped; /*1 if base is a mapping of the file, 0 if it was allocated */
+	int fd; /*the file of a mapped maze, held open for its flock */
+};
+
+/*Returns the name of room id */
+static inline const char* mazeRoomName(const struct Maze* maze, uint32_t id) {
+	return maze->names + maze->nameOffsets[id];
+}
+
+/*Returns the array of rooms connected to room id. It has maze->degrees[id] entries */
+static inline const uint32_t* mazeConnections(const struct Maze* maze, uint32_t id) {
+	return maze->links + maze->linkStart[id];
+}
+
+void layoutMaze(struct MazeHeader* header, uint64_t numRooms, uint64_t numLinks, uint64_t namesSize);
+int createMaze(struct Maze* maze, uint32_t numRooms, uint64_t numLinks, uint64_t namesSize);
+int writeMaze(const struct Maze* maze, const char* path);
+int openMaze(struct Maze* maze, const char* path);
+int readMaze(struct Maze* maze, const char* path);
+int openMazeForUpdate(struct Maze* maze, const char* path, int* exclusive);
+int appendMazeLinks(struct Maze* maze, uint64_t count, uint64_t* first);
+int writeMazeRoom(const struct Maze* maze, uint32_t room, int type, int degree, uint64_t linkStart,
+	const uint32_t* links);
+void closeMaze(struct Maze* maze);
+int mazeRoomFits(const struct Maze* maze, uint32_t room);
+int sortMazeNames(struct Maze* maze);
+uint32_t findMazeRoom(const struct Maze* maze, const char* name);
+uint32_t findRoomOfType(const struct Maze* maze, int type);
+
+#endif
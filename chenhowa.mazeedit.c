@@ -0,0 +1,208 @@
+/* Filename: chenhowa.mazeedit.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Edits an existing maze without regenerating it, rewriting only
+ * 	the rooms the edits touch (see chenhowa.edit.h)
+ * Input: optional -d <rooms directory>, the maze to edit (default: the newest one)
+ * 	optional -m/--min-degree <n> and -M/--max-degree <n>, the fewest and most
+ * 	connections an edit may leave a room with (default 3 and 6)
+ * 	optional -V, load the edited maze afterwards and verify it
+ * 	edits, one per argument, or one per line of stdin if none are given:
+ * 		link <room> <room>
+ * 		unlink <room> <room>
+ * 		type <room> <START_ROOM|MID_ROOM|END_ROOM>
+ * 		add <new room> <room> <room> ...
+ * 		remove <room>
+ * 	Blank lines and lines starting with # are skipped
+ * Output: the edited room files and binary maze, and a line saying how much was
+ * 	written. If any edit fails, nothing is written
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "chenhowa.edit.h"
+#include "chenhowa.loader.h"
+#include "chenhowa.verify.h"
+
+#define MAX_CONNECTIONS 6 /*default most connections a room may have */
+#define MIN_CONNECTIONS 3 /*default fewest connections a room may have */
+#define MAX_WORDS (MAX_DEGREE_LIMIT + 2) /*most words in one edit: "add", the room and its neighbours */
+#define LINE_LEN 65536
+
+/*Returns the room type with the given name, or 0 if there is none */
+static int parseType(const char* name) {
+	if(strcmp(name, "START_ROOM") == 0) {
+		return START_ROOM;
+	} else if(strcmp(name, "MID_ROOM") == 0) {
+		return MID_ROOM;
+	} else if(strcmp(name, "END_ROOM") == 0) {
+		return END_ROOM;
+	}
+	return 0;
+}
+
+/* Applies one edit to a MazeEdit
+ * args: [1] edit, the MazeEdit
+ * 	[2] words, the edit split into words
+ * 	[3] count, the number of words
+ * ret: 0 on success, 1 if the edit is malformed or fails (the reason is printed)
+ */
+static int applyEdit(struct MazeEdit* edit, char** words, int count) {
+	if(strcmp(words[0], "link") == 0 && count == 3) {
+		return editLink(edit, words[1], words[2]);
+	} else if(strcmp(words[0], "unlink") == 0 && count == 3) {
+		return editUnlink(edit, words[1], words[2]);
+	} else if(strcmp(words[0], "type") == 0 && count == 3 && parseType(words[2]) != 0) {
+		return editSetType(edit, words[1], parseType(words[2]));
+	} else if(strcmp(words[0], "add") == 0 && count >= 2) {
+		return editAddRoom(edit, words[1], words + 2, count - 2);
+	} else if(strcmp(words[0], "remove") == 0 && count == 2) {
+		return editRemoveRoom(edit, words[1]);
+	}
+	fprintf(stderr, "Error. Unknown edit %s\n", words[0]);
+	return 1;
+}
+
+/*Splits a line into words separated by spaces and tabs. Returns the number of words,
+ * or -1 if there are more than max */
+static int splitWords(char* line, char** words, int max) {
+	int count = 0;
+	char* word;
+
+	for(word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n")) {
+		if(count == max) {
+			return -1;
+		}
+		words[count] = word;
+		count++;
+	}
+	return count;
+}
+
+/* Loads the edited maze back and checks that it is still a valid maze
+ * args: [1] dirName, the rooms directory
+ * 	[2] minDegree, [3] maxDegree, the degree bounds every room must keep
+ * ret: 0 if the maze is valid, 1 if it isn't or could not be loaded
+ */
+static int checkEditedMaze(const char* dirName, int minDegree, int maxDegree) {
+	struct Maze maze;
+	struct NameTable names;
+	struct MazeCheck check;
+	int threads = sysconf(_SC_NPROCESSORS_ONLN);
+	int result;
+
+	if(loadMaze(dirName, &maze, &names, threads) != 0) {
+		return 1;
+	}
+	result = verifyMaze(&maze, minDegree, maxDegree, threads, &check);
+	if(result == 0 && !mazeIsValid(&maze, &check)) {
+		fprintf(stderr, "Error. Edited maze is invalid: %llu rooms with a bad degree, %llu bad connections, "
+			"%llu one-way connections, %llu of %u rooms reachable\n", (unsigned long long)check.badDegrees,
+			(unsigned long long)check.badLinks, (unsigned long long)check.oneWayLinks, (unsigned long long)check.reached, maze.numRooms);
+		result = 1;
+	}
+	if(result == 0) {
+		printf("verified %u rooms: degrees %i..%i, symmetric, connected in %u levels\n",
+			maze.numRooms, minDegree, maxDegree, check.levels);
+	}
+	freeNameTable(&names);
+	closeMaze(&maze);
+	return result;
+}
+
+int main(int argc, char* argv[]) {
+	char dirName[1000];
+	char line[LINE_LEN];
+	char* words[MAX_WORDS];
+	struct MazeEdit edit;
+	int minDegree = MIN_CONNECTIONS;
+	int maxDegree = MAX_CONNECTIONS;
+	int verify = 0;
+	int count;
+	int lineNumber = 0;
+	int opt;
+	int result = 0;
+	static struct option longOptions[] = {
+		{ "min-degree", required_argument, NULL, 'm' },
+		{ "max-degree", required_argument, NULL, 'M' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	memset(dirName, 0, sizeof(dirName));
+	while((opt = getopt_long(argc, argv, "d:m:M:V", longOptions, NULL)) != -1) {
+		switch(opt) {
+			case 'd': strncpy(dirName, optarg, sizeof(dirName) - 1);
+			break;
+			case 'm': minDegree = atoi(optarg);
+			break;
+			case 'M': maxDegree = atoi(optarg);
+			break;
+			case 'V': verify = 1;
+			break;
+			default:
+				fprintf(stderr, "Usage: %s [-d rooms directory] [-m min degree] [-M max degree] [-V] "
+					"[edit ...]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	if(checkDegreeBounds(MAX_DEGREE_LIMIT + 1, minDegree, maxDegree) != 0) {
+		return 1;
+	}
+	if(dirName[0] == '\0' && findNewestRoomsDir(dirName, sizeof(dirName)) != 0) {
+		return 1;
+	}
+	if(openMazeEdit(&edit, dirName, minDegree, maxDegree) != 0) {
+		return 1;
+	}
+
+	/*Apply every edit, stopping at the first that fails */
+	if(optind < argc) {
+		for(; optind < argc && result == 0; optind++) {
+			lineNumber++;
+			strncpy(line, argv[optind], sizeof(line) - 1);
+			line[sizeof(line) - 1] = '\0';
+			count = splitWords(line, words, MAX_WORDS);
+			if(count < 1) {
+				fprintf(stderr, "Error. Bad edit: %s\n", argv[optind]);
+				result = 1;
+			} else {
+				result = applyEdit(&edit, words, count);
+			}
+		}
+	} else {
+		while(result == 0 && fgets(line, sizeof(line), stdin) != NULL) {
+			lineNumber++;
+			count = splitWords(line, words, MAX_WORDS);
+			if(count < 0) {
+				fprintf(stderr, "Error. Edit %i has too many words\n", lineNumber);
+				result = 1;
+			} else if(count > 0 && words[0][0] != '#') {
+				result = applyEdit(&edit, words, count);
+			}
+		}
+	}
+
+	if(result != 0) {
+		fprintf(stderr, "Error. Edit %i failed; nothing was written\n", lineNumber);
+	} else {
+		result = commitMazeEdit(&edit);
+	}
+	if(result == 0) {
+		printf("%i edits to %s: %u rooms read, %u room files written, %u removed, "
+			"%u binary rooms patched, %u link blocks moved%s%s\n", lineNumber, dirName, edit.rooms.numRooms,
+			edit.filesWritten, edit.filesRemoved, edit.roomsPatched, edit.blocksMoved,
+			edit.hasBinary && edit.resized ? ", binary maze repacked" : "",
+			edit.copied ? ", binary maze copied since it was in use" : "");
+	}
+	closeMazeEdit(&edit);
+
+	if(result == 0 && verify) {
+		result = checkEditedMaze(dirName, minDegree, maxDegree);
+	}
+	return result;
+}
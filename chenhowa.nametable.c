@@ -0,0 +1,96 @@
+/* Filename: chenhowa.nametable.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Builds and searches the room name table. Collisions are resolved
+ * 	by linear probing, and the table is kept at most half full so probes stay short.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "chenhowa.nametable.h"
+
+/*Returns the 64 bit FNV-1a hash of a NUL terminated name */
+uint64_t hashName(const char* name) {
+	uint64_t hash = 14695981039346656037ULL;
+
+	while(*name != '\0') {
+		hash ^= (unsigned char)*name;
+		hash *= 1099511628211ULL;
+		name++;
+	}
+	return hash;
+}
+
+/* Interns every room name of a maze
+ * args: [1] table, the NameTable to fill in
+ * 	[2] maze, a maze whose names and nameOffsets are filled in
+ * pre: maze must outlive the table, since names are not copied
+ * post: table must be released with freeNameTable
+ * ret: 0 on success, 1 if memory could not be allocated or two rooms share a name
+ */
+int buildNameTable(struct NameTable* table, const struct Maze* maze) {
+	uint64_t capacity = 16;
+	uint64_t slot;
+	uint64_t hash;
+	uint32_t i;
+
+	while(capacity < (uint64_t)maze->numRooms * 2) {
+		capacity *= 2;
+	}
+
+	table->maze = maze;
+	table->mask = capacity - 1;
+	table->slots = malloc(capacity * sizeof(struct NameSlot));
+	if(table->slots == NULL) {
+		fprintf(stderr, "Error. Couldn't allocate the room name table\n");
+		return 1;
+	}
+	for(slot = 0; slot < capacity; slot++) {
+		table->slots[slot].room = NO_ROOM;
+	}
+
+	for(i = 0; i < maze->numRooms; i++) {
+		hash = hashName(mazeRoomName(maze, i));
+
+		/*Probe from the home slot until an empty slot turns up */
+		for(slot = hash & table->mask; table->slots[slot].room != NO_ROOM; slot = (slot + 1) & table->mask) {
+			if(table->slots[slot].hash == (uint32_t)hash
+					&& strcmp(mazeRoomName(maze, table->slots[slot].room), mazeRoomName(maze, i)) == 0) {
+				fprintf(stderr, "Error. More than one room is named %s\n", mazeRoomName(maze, i));
+				freeNameTable(table);
+				return 1;
+			}
+		}
+		table->slots[slot].room = i;
+		table->slots[slot].hash = (uint32_t)hash;
+	}
+
+	return 0;
+}
+
+/*Returns the index of the room with the given name, or NO_ROOM if no room has it */
+uint32_t lookupName(const struct NameTable* table, const char* name) {
+	uint64_t hash = hashName(name);
+	uint64_t slot;
+	const struct NameSlot* entry;
+
+	for(slot = hash & table->mask; ; slot = (slot + 1) & table->mask) {
+		entry = table->slots + slot;
+		if(entry->room == NO_ROOM) {
+			return NO_ROOM;
+		}
+		if(entry->hash == (uint32_t)hash && strcmp(mazeRoomName(table->maze, entry->room), name) == 0) {
+			return entry->room;
+		}
+	}
+}
+
+/*Frees the memory held by a NameTable */
+void freeNameTable(struct NameTable* table) {
+	free(table->slots);
+	table->slots = NULL;
+	table->mask = 0;
+	table->maze = NULL;
+}
@@ -0,0 +1,33 @@
+/* Filename: chenhowa.nametable.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Open-addressing hash table that interns the room names of a maze,
+ * 	so a room name can be turned into its room index with one lookup.
+ */
+
+#ifndef CHENHOWA_NAMETABLE_H
+#define CHENHOWA_NAMETABLE_H
+
+#include <stdint.h>
+
+#include "chenhowa.maze.h"
+
+/*One slot of a NameTable. Empty slots hold NO_ROOM */
+struct NameSlot {
+	uint32_t room; /*index of the room with this name */
+	uint32_t hash; /*low bits of the name's hash, checked before comparing strings */
+};
+
+/*Maps every room name of a maze to its room index */
+struct NameTable {
+	struct NameSlot* slots; /*array of capacity slots */
+	uint64_t mask; /*capacity - 1. capacity is a power of two */
+	const struct Maze* maze; /*maze whose names are interned */
+};
+
+uint64_t hashName(const char* name);
+int buildNameTable(struct NameTable* table, const struct Maze* maze);
+uint32_t lookupName(const struct NameTable* table, const char* name);
+void freeNameTable(struct NameTable* table);
+
+#endif
@@ -0,0 +1,280 @@
+/* Filename: chenhowa.parsebench.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Compares the fscanf room file reader chenhowa.adventure used to
+ * 	have against the single-pass parseRoom parser. Every room file of a rooms
+ * 	directory is read into memory first, so only parsing is timed.
+ * Input: optional rooms directory (default: the newest one) and repeats (default 5)
+ * Output: one line per reader with its median and best time per room, and its throughput
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+
+#include "chenhowa.loader.h"
+#include "chenhowa.timing.h"
+
+#define NAME_LEN 256
+#define READ_LEN 4096 /*bytes read from a room file at a time */
+
+/*Every room file of a directory, back to back in one buffer */
+struct RoomFiles {
+	char* text; /*contents of every file */
+	size_t size; /*bytes used in text */
+	size_t capacity; /*capacity of text */
+	size_t* starts; /*offset of each file in text; starts[count] is size */
+	size_t count; /*number of files */
+	size_t startsCapacity; /*capacity of starts */
+};
+
+/* Reads in a Room's data from a Room file with fscanf, the way chenhowa.adventure did
+ * args: [1] file, a pointer to an opened FILE
+ *	[2] builder, the MazeBuilder to add the room to
+ * ret: 0 on success, 1 if the room could not be read or memory could not be allocated
+ */
+static int scanRoom(FILE *file, struct MazeBuilder* builder) {
+	char name[NAME_LEN];
+	char type[50];
+	int trash = 0;
+	uint32_t room;
+
+	memset(type, '\0', sizeof(type) );
+
+	/*First, scan in the name */
+	if(fscanf(file, "ROOM NAME: %255s\n", name) != 1) {
+		return 1;
+	}
+	if(addRoom(builder, name, strlen(name)) != 0) {
+		return 1;
+	}
+	room = builder->numRooms - 1;
+
+	/*Then repeatedly scan in connections */
+	while(fscanf(file, "CONNECTION %i: %255s\n", &trash, name) == 2) {
+		if(addConnection(builder, name, strlen(name)) != 0) {
+			return 1;
+		}
+	}
+
+	/*Once you're done reading all the connections, read the room type */
+	fscanf(file, "ROOM TYPE: %49s\n", type);
+	if (strcmp( type, "MID_ROOM") == 0 ) {
+		builder->types[room] = MID_ROOM;
+	}
+	else if(strcmp( type, "START_ROOM") == 0) {
+		builder->types[room] = START_ROOM;
+	}
+	else if(strcmp( type, "END_ROOM") == 0) {
+		builder->types[room] = END_ROOM;
+	}
+	else {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*Makes room for needed more bytes in files->text. Returns 1 if memory ran out */
+static int growText(struct RoomFiles* files, size_t needed) {
+	char* grown;
+	size_t capacity = files->capacity ? files->capacity : READ_LEN;
+
+	while(capacity < files->size + needed) {
+		capacity *= 2;
+	}
+	if(capacity != files->capacity) {
+		grown = realloc(files->text, capacity);
+		if(grown == NULL) {
+			return 1;
+		}
+		files->text = grown;
+		files->capacity = capacity;
+	}
+	return 0;
+}
+
+/*Appends the contents of a room file to files. Returns 0 on success, 1 on failure */
+static int addFile(struct RoomFiles* files, int dirFd, const char* fileName) {
+	size_t* grown;
+	ssize_t result;
+	int fd;
+
+	if(files->count + 2 > files->startsCapacity) {
+		grown = realloc(files->starts, (files->startsCapacity ? 2 * files->startsCapacity : 1024) * sizeof(size_t));
+		if(grown == NULL) {
+			return 1;
+		}
+		files->starts = grown;
+		files->startsCapacity = files->startsCapacity ? 2 * files->startsCapacity : 1024;
+	}
+
+	fd = openat(dirFd, fileName, O_RDONLY);
+	if(fd < 0) {
+		return 1;
+	}
+	files->starts[files->count] = files->size;
+	do {
+		if(growText(files, READ_LEN) != 0) {
+			close(fd);
+			return 1;
+		}
+		result = read(fd, files->text + files->size, READ_LEN);
+		if(result > 0) {
+			files->size += result;
+		}
+	} while(result > 0);
+	close(fd);
+
+	files->count++;
+	files->starts[files->count] = files->size;
+	return result < 0;
+}
+
+/* Reads every room file in a directory into memory
+ * args: [1] dirName, the rooms directory
+ * 	[2] files, the RoomFiles to fill in
+ * post: files holds every file except the binary maze file. Its memory must be freed
+ * ret: 0 on success, 1 if the directory or a file could not be read
+ */
+static int readRoomDir(const char* dirName, struct RoomFiles* files) {
+	DIR* dir;
+	struct dirent* entry;
+	int result = 0;
+
+	memset(files, 0, sizeof(*files));
+	dir = opendir(dirName);
+	if(dir == NULL) {
+		fprintf(stderr, "Could not open %s\n", dirName);
+		return 1;
+	}
+	for(entry = readdir(dir); entry != NULL && result == 0; entry = readdir(dir)) {
+		if(entry->d_name[0] != '.' && strcmp(entry->d_name, MAZE_FILE_NAME) != 0) {
+			result = addFile(files, dirfd(dir), entry->d_name);
+			if(result != 0) {
+				fprintf(stderr, "Could not read %s/%s\n", dirName, entry->d_name);
+			}
+		}
+	}
+	closedir(dir);
+	return result;
+}
+
+/* Reads every room in files into a fresh builder with one of the two readers
+ * args: [1] files, the room files
+ * 	[2] useParser, 1 for parseRoom, 0 for scanRoom
+ * 	[3] builder, an empty MazeBuilder
+ * ret: the time taken in ns, or a negative number if a room could not be read
+ */
+static double readRooms(struct RoomFiles* files, int useParser, struct MazeBuilder* builder) {
+	FILE* file;
+	size_t i;
+	int result = 0;
+	double start;
+
+	start = nowNs();
+	for(i = 0; i < files->count && result == 0; i++) {
+		if(useParser) {
+			result = parseRoom(files->text + files->starts[i], files->starts[i + 1] - files->starts[i],
+				"room file", builder);
+		} else {
+			/*fmemopen stands in for the fdopen the loader used */
+			file = fmemopen(files->text + files->starts[i], files->starts[i + 1] - files->starts[i], "r");
+			result = file == NULL || scanRoom(file, builder) != 0;
+			if(file != NULL) {
+				fclose(file);
+			}
+		}
+	}
+	return result == 0 ? nowNs() - start : -1;
+}
+
+/*Returns 1 if two builders hold the same rooms, connections and names */
+static int sameRooms(const struct MazeBuilder* a, const struct MazeBuilder* b) {
+	return a->numRooms == b->numRooms && a->numConnections == b->numConnections
+		&& a->textSize == b->textSize
+		&& memcmp(a->types, b->types, a->numRooms) == 0
+		&& memcmp(a->degrees, b->degrees, a->numRooms) == 0
+		&& memcmp(a->text, b->text, a->textSize) == 0;
+}
+
+int main(int argc, char* argv[]) {
+	char dirName[256];
+	struct RoomFiles files;
+	struct MazeBuilder builders[2];
+	double* samples[2];
+	const char* labels[2] = { "fscanf", "parseRoom" };
+	int repeats = 5;
+	int repeat;
+	int reader;
+
+	if(argc > 1) {
+		snprintf(dirName, sizeof(dirName), "%s", argv[1]);
+	} else if(findNewestRoomsDir(dirName, sizeof(dirName)) != 0) {
+		return 1;
+	}
+	if(argc > 2) {
+		repeats = atoi(argv[2]);
+	}
+	if(repeats < 1) {
+		fprintf(stderr, "Usage: %s [rooms directory] [repeats]\n", argv[0]);
+		return 1;
+	}
+
+	if(readRoomDir(dirName, &files) != 0) {
+		return 1;
+	}
+	if(files.count == 0) {
+		fprintf(stderr, "%s has no room files; build one with chenhowa.buildrooms -f text\n", dirName);
+		return 1;
+	}
+	samples[0] = malloc(repeats * sizeof(double));
+	samples[1] = malloc(repeats * sizeof(double));
+	if(samples[0] == NULL || samples[1] == NULL) {
+		fprintf(stderr, "Could not allocate %i samples\n", repeats);
+		return 1;
+	}
+
+	/*Alternate the readers, so both see the same cache and clock conditions */
+	for(repeat = 0; repeat < repeats; repeat++) {
+		for(reader = 0; reader < 2; reader++) {
+			if(repeat > 0) {
+				freeMazeBuilder(&builders[reader]);
+			}
+			initMazeBuilder(&builders[reader]);
+			samples[reader][repeat] = readRooms(&files, reader, &builders[reader]);
+			if(samples[reader][repeat] < 0) {
+				fprintf(stderr, "%s could not read the rooms in %s\n", labels[reader], dirName);
+				return 1;
+			}
+		}
+	}
+
+	printf("rooms: %zu, bytes: %zu, repeats: %i\n", files.count, files.size, repeats);
+	printf("%-10s %14s %14s %10s %9s\n", "reader", "median ns/room", "best ns/room", "MB/s", "speedup");
+	for(reader = 0; reader < 2; reader++) {
+		sortSamples(samples[reader], repeats);
+		printf("%-10s %14.1f %14.1f %10.1f %9.2f\n", labels[reader],
+			percentile(samples[reader], repeats, 0.5) / files.count,
+			samples[reader][0] / files.count,
+			files.size / (percentile(samples[reader], repeats, 0.5) / 1e3),
+			percentile(samples[0], repeats, 0.5) / percentile(samples[reader], repeats, 0.5));
+	}
+
+	/*Both readers read the same files, so they must agree */
+	if(!sameRooms(&builders[0], &builders[1])) {
+		fprintf(stderr, "Readers disagree!\n");
+		return 1;
+	}
+
+	freeMazeBuilder(&builders[0]);
+	freeMazeBuilder(&builders[1]);
+	free(samples[0]);
+	free(samples[1]);
+	free(files.starts);
+	free(files.text);
+	return 0;
+}
@@ -0,0 +1,193 @@
+/* Filename: chenhowa.player.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Starts players in a maze and moves them between rooms.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "chenhowa.player.h"
+#include "chenhowa.stats.h"
+
+#define HISTORY_CAPACITY 16 /*rooms a new player's history has space for */
+
+/* Starts a player in the START_ROOM of a maze
+ * args: [1] player, the Player to set up
+ * 	[2] maze, the maze to explore
+ * 	[3] names, the name table of maze
+ * 	[4] timeService, the time service that answers the time command, or NULL
+ * post: the player has an empty history, with 0 rooms visited, and is in the
+ * 	correct starting room. It must be released with freePlayer
+ * ret: 0 on success, 1 if the maze has no START_ROOM or memory could not be allocated
+ */
+int initPlayer(struct Player* player, struct Maze* maze, struct NameTable* names, struct TimeService* timeService) {
+	return initPlayerInRoom(player, maze, names, timeService, findRoomOfType(maze, START_ROOM));
+}
+
+/* Starts a player in a given room of a maze. Callers that start many players
+ * 	find the START_ROOM once and pass it here, instead of scanning every room
+ * 	for each player
+ * args: [1] player, the Player to set up
+ * 	[2] maze, the maze to explore
+ * 	[3] names, the name table of maze
+ * 	[4] timeService, the time service that answers the time command, or NULL
+ * 	[5] room, index of the room to start in
+ * post: the player has an empty history, with 0 rooms visited, and is in room.
+ * 	It must be released with freePlayer
+ * ret: 0 on success, 1 if room is NO_ROOM or memory could not be allocated
+ */
+int initPlayerInRoom(struct Player* player, struct Maze* maze, struct NameTable* names,
+		struct TimeService* timeService, uint32_t room) {
+	player->maze = maze;
+	player->names = names;
+	player->timeService = timeService;
+	player->visited = 0;
+	player->curRoom = room;
+	player->reloader = NULL;
+	player->snapshot = NULL;
+	player->generation = 0;
+	player->historyCapacity = HISTORY_CAPACITY;
+	player->history = malloc(HISTORY_CAPACITY * sizeof(uint32_t));
+	if(player->curRoom == NO_ROOM || player->history == NULL) {
+		free(player->history);
+		player->history = NULL;
+		return 1;
+	}
+	return 0;
+}
+
+/* Starts a player in the START_ROOM of the newest maze of a reloader
+ * args: [1] player, the Player to set up
+ * 	[2] reloader, a started MazeReloader
+ * 	[3] timeService, the time service that answers the time command, or NULL
+ * post: the player holds a reference to the newest snapshot, and moves to newer
+ * 	ones as they are published (see movePlayer). It must be released with freePlayer
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+int initPlayerFromReloader(struct Player* player, struct MazeReloader* reloader, struct TimeService* timeService) {
+	struct MazeSnapshot* snapshot = acquireSnapshot(reloader);
+
+	if(initPlayerInRoom(player, &snapshot->maze, &snapshot->names, timeService, snapshot->startRoom) != 0) {
+		releaseSnapshot(snapshot);
+		return 1;
+	}
+	player->reloader = reloader;
+	player->snapshot = snapshot;
+	player->generation = snapshot->generation;
+	return 0;
+}
+
+/*Frees the memory held by a Player, and gives back its snapshot */
+void freePlayer(struct Player* player) {
+	free(player->history);
+	player->history = NULL;
+	if(player->snapshot != NULL) {
+		releaseSnapshot(player->snapshot);
+		player->snapshot = NULL;
+	}
+}
+
+/* Moves a player who has just moved into the newest snapshot of its reloader.
+ * 	Rooms are matched by name, so the player keeps its room and its history
+ * args: [1] player, a player set up with initPlayerFromReloader
+ * post: if the room the player is in, or any room in its history, is not in the
+ * 	newest maze, the player stays in its own snapshot, which is still whole, and
+ * 	doesn't try that generation again
+ * ret: none
+ */
+static void migratePlayer(struct Player* player) {
+	struct MazeSnapshot* next = acquireSnapshot(player->reloader);
+	uint32_t* history;
+	int i;
+
+	player->generation = next->generation;
+	history = malloc(player->historyCapacity * sizeof(uint32_t));
+	for(i = 0; history != NULL && i < player->visited; i++) {
+		history[i] = lookupName(&next->names, mazeRoomName(player->maze, player->history[i]));
+		if(history[i] == NO_ROOM) {
+			free(history);
+			history = NULL;
+		}
+	}
+	if(history == NULL) {
+		releaseSnapshot(next);
+		return;
+	}
+
+	free(player->history);
+	releaseSnapshot(player->snapshot);
+	player->history = history;
+	player->snapshot = next;
+	player->maze = &next->maze;
+	player->names = &next->names;
+	player->curRoom = history[player->visited - 1];
+}
+
+/* Moves a player to a connected room
+ * args: [1] player, the struct containing the player's data
+ * 	[2] roomName, the name of the room to move to
+ * pre: player must have been set up with initPlayer
+ * post: if roomName is connected to the player's current room, the player is
+ * 	in that room and it has been added to the player's history. A player with
+ * 	a reloader then moves into the newest maze, if one has been published
+ * ret: 0 if the player moved, 1 if roomName is not a connection of the current room
+ * 	(or the history could not grow)
+ */
+int movePlayer(struct Player* player, const char* roomName) {
+	int i;
+	int numConnections = player->maze->degrees[player->curRoom];
+	const uint32_t* connections = mazeConnections(player->maze, player->curRoom);
+	uint32_t target;
+	uint32_t* grown;
+	STATS_TIMER(started);
+
+	/*Turn the room name into a room index, then check whether that room is
+ * 		one of the possible connections */
+	STATS_START(started);
+	target = lookupName(player->names, roomName);
+	for(i = 0; target != NO_ROOM && i < numConnections; i++) {
+		/*If the room was one of the possible connections, change
+ * 			the player's current room to that connection */
+		if(connections[i] == target) {
+			/*Record the room in the player's history, doubling the history
+ * 				when it is full so a long walk stays linear */
+			if(player->visited == player->historyCapacity) {
+				grown = realloc(player->history, 2 * player->historyCapacity * sizeof(uint32_t));
+				if(grown == NULL) {
+					return 1;
+				}
+				player->history = grown;
+				player->historyCapacity *= 2;
+			}
+			player->history[player->visited] = target;
+			player->visited++;
+			player->curRoom = target;
+
+			/*The move was checked against the maze the player saw; only
+ * 				now does the player step into a newer one */
+			if(player->reloader != NULL && currentGeneration(player->reloader) != player->generation) {
+				migratePlayer(player);
+			}
+			STATS_STOP(STAT_MOVE, started);
+			return 0;
+		}
+	}
+
+	STATS_STOP(STAT_MOVE, started);
+	return 1;
+}
+
+/*Returns 1 if the player is in the END_ROOM, 0 otherwise */
+int playerHasWon(const struct Player* player) {
+	return player->maze->types[player->curRoom] == END_ROOM;
+}
+
+/*Prints the name of every room a player has visited, one per line, in order */
+void printHistory(FILE* file, const struct Player* player) {
+	int i;
+
+	for(i = 0; i < player->visited; i++) {
+		fprintf(file, "%s\n", mazeRoomName(player->maze, player->history[i]));
+	}
+}
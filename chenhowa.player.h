@@ -0,0 +1,43 @@
+/* Filename: chenhowa.player.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: A player's position and history in a maze, and the moves that
+ * 	change them. Nothing here prints, so the same moves drive the interactive
+ * 	game and the headless modes.
+ */
+
+#ifndef CHENHOWA_PLAYER_H
+#define CHENHOWA_PLAYER_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "chenhowa.maze.h"
+#include "chenhowa.nametable.h"
+#include "chenhowa.timeservice.h"
+#include "chenhowa.reload.h"
+
+/*Player struct that holds player data */
+struct Player {
+	struct Maze* maze; /*maze the player is exploring */
+	struct NameTable* names; /*looks up rooms of maze by name */
+	struct TimeService* timeService; /*answers the time command */
+	uint32_t curRoom; /*index of the current room */
+	uint32_t* history; /*index of every room the player has visited, in order */
+	int historyCapacity; /*number of entries history has room for */
+	int visited; /*total number of rooms the Player has visited */
+	struct MazeReloader* reloader; /*where newer mazes come from, or NULL if maze never changes */
+	struct MazeSnapshot* snapshot; /*snapshot that holds maze, or NULL */
+	uint64_t generation; /*newest generation the player has moved to or given up on */
+};
+
+int initPlayer(struct Player* player, struct Maze* maze, struct NameTable* names, struct TimeService* timeService);
+int initPlayerInRoom(struct Player* player, struct Maze* maze, struct NameTable* names,
+	struct TimeService* timeService, uint32_t room);
+int initPlayerFromReloader(struct Player* player, struct MazeReloader* reloader, struct TimeService* timeService);
+void freePlayer(struct Player* player);
+int movePlayer(struct Player* player, const char* roomName);
+int playerHasWon(const struct Player* player);
+void printHistory(FILE* file, const struct Player* player);
+
+#endif
@@ -0,0 +1,283 @@
+/* Filename: chenhowa.reload.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Watches for new mazes and publishes them as snapshots.
+ *
+ * 	Publishing works like RCU. A snapshot is never changed once it is
+ * 	published; a reload builds a whole new one in the watcher thread, then
+ * 	swaps the current pointer and bumps the generation with release stores.
+ * 	Players compare the generation on every move, which is one load with no
+ * 	lock, and only take the lock to pin the new snapshot when it has changed.
+ * 	Every player holds a reference to the snapshot it is in, and the last
+ * 	reference to go frees the snapshot, so an old maze lives exactly as long
+ * 	as someone is still in it.
+ *
+ * 	The watcher uses inotify on the current directory, for chenhowa.buildrooms
+ * 	renaming a new chenhowa.latest into place, and on the current rooms
+ * 	directory, for chenhowa.mazeedit rewriting room files or maze.bin. Changes
+ * 	usually come in bursts, so the maze is only reloaded once none have arrived
+ * 	for QUIET_MS.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+#include "chenhowa.reload.h"
+#include "chenhowa.loader.h"
+
+#define QUIET_MS 100 /*changes must stop for this long before the maze is reloaded */
+#define EVENT_BUFFER_LEN 4096
+#define DIR_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MODIFY | IN_ATTRIB)
+
+/* Loads the maze in a rooms directory as a new snapshot
+ * args: [1] dirName, the rooms directory
+ * 	[2] threads, the number of threads to read room files with
+ * post: a binary maze file is read into memory rather than mapped, so the
+ * 	snapshot never depends on the file it came from
+ * ret: the snapshot, holding the one reference of its caller, or NULL if the
+ * 	maze could not be loaded or has no START_ROOM or END_ROOM (a message is printed)
+ */
+static struct MazeSnapshot* loadSnapshot(const char* dirName, int threads) {
+	struct MazeSnapshot* snapshot;
+	char fileName[512];
+	int result;
+
+	snapshot = calloc(1, sizeof(struct MazeSnapshot));
+	if(snapshot == NULL) {
+		return NULL;
+	}
+	strncpy(snapshot->dirName, dirName, sizeof(snapshot->dirName) - 1);
+
+	snprintf(fileName, sizeof(fileName), "%s/%s", dirName, MAZE_FILE_NAME);
+	if(access(fileName, F_OK) == 0) {
+		result = readMaze(&snapshot->maze, fileName);
+		if(result == 0 && buildNameTable(&snapshot->names, &snapshot->maze) != 0) {
+			closeMaze(&snapshot->maze);
+			result = 1;
+		}
+	} else {
+		result = loadTextMaze(dirName, &snapshot->maze, &snapshot->names, threads);
+	}
+	if(result != 0) {
+		free(snapshot);
+		return NULL;
+	}
+	snapshot->refs = 1;
+
+	snapshot->startRoom = findRoomOfType(&snapshot->maze, START_ROOM);
+	if(snapshot->startRoom == NO_ROOM || findRoomOfType(&snapshot->maze, END_ROOM) == NO_ROOM) {
+		fprintf(stderr, "Error. The maze in %s needs a START_ROOM and an END_ROOM\n", dirName);
+		releaseSnapshot(snapshot);
+		return NULL;
+	}
+	return snapshot;
+}
+
+/* Takes a reference to the newest snapshot
+ * args: [1] reloader, a started MazeReloader
+ * post: the snapshot stays loaded until it is given back with releaseSnapshot,
+ * 	however many reloads happen in the meantime
+ * ret: the snapshot
+ */
+struct MazeSnapshot* acquireSnapshot(struct MazeReloader* reloader) {
+	struct MazeSnapshot* snapshot;
+
+	/*The lock keeps the watcher from dropping the current reference between
+ * 		reading the pointer and adding ours */
+	pthread_mutex_lock(&reloader->lock);
+	snapshot = reloader->current;
+	__atomic_add_fetch(&snapshot->refs, 1, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&reloader->lock);
+	return snapshot;
+}
+
+/*Gives back a reference to a snapshot, freeing it if it was the last */
+void releaseSnapshot(struct MazeSnapshot* snapshot) {
+	if(__atomic_sub_fetch(&snapshot->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+		freeNameTable(&snapshot->names);
+		closeMaze(&snapshot->maze);
+		free(snapshot);
+	}
+}
+
+/*Makes a snapshot the current one, and drops the reference the old one held as current */
+static void publishSnapshot(struct MazeReloader* reloader, struct MazeSnapshot* snapshot) {
+	struct MazeSnapshot* old;
+
+	pthread_mutex_lock(&reloader->lock);
+	old = reloader->current;
+	snapshot->generation = old->generation + 1;
+	__atomic_store_n(&reloader->current, snapshot, __ATOMIC_RELEASE);
+	__atomic_store_n(&reloader->generation, snapshot->generation, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&reloader->lock);
+
+	releaseSnapshot(old);
+}
+
+/*Points the directory watch at a rooms directory. Returns 0 on success, 1 if it can't be watched */
+static int watchRoomsDir(struct MazeReloader* reloader, const char* dirName) {
+	if(reloader->dirWatch >= 0) {
+		inotify_rm_watch(reloader->inotify, reloader->dirWatch);
+	}
+	reloader->dirWatch = inotify_add_watch(reloader->inotify, dirName, DIR_EVENTS);
+	return reloader->dirWatch < 0;
+}
+
+/*Loads the newest maze and publishes it, or keeps the current one if it can't be loaded */
+static void reloadMaze(struct MazeReloader* reloader) {
+	struct MazeSnapshot* snapshot;
+	char dirName[sizeof(snapshot->dirName)];
+
+	if(findNewestRoomsDir(dirName, sizeof(dirName)) != 0
+			|| (snapshot = loadSnapshot(dirName, reloader->threads)) == NULL) {
+		fprintf(stderr, "Error. Couldn't reload the maze; keeping %s\n", reloader->current->dirName);
+		reloader->failures++;
+		return;
+	}
+
+	/*Only the watcher swaps current, so it can read it without the lock */
+	if(strcmp(dirName, reloader->current->dirName) != 0 && watchRoomsDir(reloader, dirName) != 0) {
+		fprintf(stderr, "Error. Couldn't watch %s: %s\n", dirName, strerror(errno));
+	}
+	publishSnapshot(reloader, snapshot);
+	reloader->reloads++;
+	if(reloader->report) {
+		printf("reloaded %u rooms from %s (generation %llu)\n", snapshot->maze.numRooms, dirName,
+			(unsigned long long)snapshot->generation);
+		fflush(stdout);
+	}
+}
+
+/*Reads every pending inotify event. Returns 1 if any of them may change the maze */
+static int readEvents(struct MazeReloader* reloader) {
+	char buffer[EVENT_BUFFER_LEN] __attribute__((aligned(__alignof__(struct inotify_event))));
+	const struct inotify_event* event;
+	ssize_t length;
+	char* next;
+	int changed = 0;
+
+	while((length = read(reloader->inotify, buffer, sizeof(buffer))) > 0) {
+		for(next = buffer; next < buffer + length; next += sizeof(struct inotify_event) + event->len) {
+			event = (const struct inotify_event*)next;
+			if(event->mask & IN_Q_OVERFLOW || event->wd == reloader->dirWatch
+					|| (event->len > 0 && strcmp(event->name, LATEST_LINK_NAME) == 0)) {
+				changed = 1;
+			}
+		}
+	}
+	return changed;
+}
+
+/* Description: body of the watcher thread. Reloads the maze once changes to it
+ * 	have stopped for QUIET_MS
+ * Args: [1] args, the MazeReloader
+ * Post: this function executes until the wake eventfd is raised
+ * ret: NULL
+ */
+static void* watchMazes(void* args) {
+	struct MazeReloader* reloader = args;
+	struct pollfd fds[2];
+	int changed = 0;
+	int count;
+
+	fds[0].fd = reloader->inotify;
+	fds[0].events = POLLIN;
+	fds[1].fd = reloader->wake;
+	fds[1].events = POLLIN;
+	while(1) {
+		count = poll(fds, 2, changed ? QUIET_MS : -1);
+		if(count < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			fprintf(stderr, "Error. Maze watcher stopped: %s\n", strerror(errno));
+			return NULL;
+		}
+		if(fds[1].revents & POLLIN) {
+			return NULL;
+		}
+		if(count == 0) {
+			reloadMaze(reloader);
+			changed = 0;
+		} else if(fds[0].revents & POLLIN) {
+			changed |= readEvents(reloader);
+		}
+	}
+}
+
+/*Closes every descriptor of a reloader that was opened */
+static void closeReloaderFds(struct MazeReloader* reloader) {
+	if(reloader->inotify >= 0) {
+		close(reloader->inotify);
+	}
+	if(reloader->wake >= 0) {
+		close(reloader->wake);
+	}
+}
+
+/* Loads the newest maze and starts the thread that reloads it
+ * args: [1] reloader, the MazeReloader to set up
+ * 	[2] threads, the number of threads to read room files with
+ * 	[3] report, 1 to print a line to stdout for every reload
+ * post: reloader->current is the first snapshot. The reloader must be stopped
+ * 	with stopMazeReloader
+ * ret: 0 on success, 1 if there is no maze to load or it can't be watched
+ */
+int startMazeReloader(struct MazeReloader* reloader, int threads, int report) {
+	char dirName[sizeof(reloader->current->dirName)];
+
+	memset(reloader, 0, sizeof(*reloader));
+	reloader->threads = threads;
+	reloader->report = report;
+	reloader->dirWatch = -1;
+	if(findNewestRoomsDir(dirName, sizeof(dirName)) != 0) {
+		return 1;
+	}
+	reloader->current = loadSnapshot(dirName, threads);
+	if(reloader->current == NULL) {
+		return 1;
+	}
+	reloader->current->generation = 1;
+	reloader->generation = 1;
+	pthread_mutex_init(&reloader->lock, NULL);
+
+	reloader->inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	reloader->wake = eventfd(0, EFD_CLOEXEC);
+	if(reloader->inotify < 0 || reloader->wake < 0
+			|| (reloader->latestWatch = inotify_add_watch(reloader->inotify, ".", IN_CREATE | IN_MOVED_TO)) < 0
+			|| watchRoomsDir(reloader, dirName) != 0
+			|| pthread_create(&reloader->thread, NULL, watchMazes, reloader) != 0) {
+		fprintf(stderr, "Error. Couldn't watch %s for new mazes: %s\n", dirName, strerror(errno));
+		closeReloaderFds(reloader);
+		releaseSnapshot(reloader->current);
+		pthread_mutex_destroy(&reloader->lock);
+		return 1;
+	}
+	return 0;
+}
+
+/* Stops the watcher thread and drops the current snapshot
+ * args: [1] reloader, a started MazeReloader
+ * pre: every snapshot taken with acquireSnapshot has been released
+ * post: every snapshot has been freed
+ * ret: none
+ */
+void stopMazeReloader(struct MazeReloader* reloader) {
+	uint64_t one = 1;
+
+	if(write(reloader->wake, &one, sizeof(one)) != sizeof(one)) {
+		fprintf(stderr, "Error. Couldn't stop the maze watcher\n");
+		return;
+	}
+	pthread_join(reloader->thread, NULL);
+	closeReloaderFds(reloader);
+	releaseSnapshot(reloader->current);
+	reloader->current = NULL;
+	pthread_mutex_destroy(&reloader->lock);
+}
@@ -0,0 +1,56 @@
+/* Filename: chenhowa.reload.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Hot reload of the maze for a long-running chenhowa.adventure.
+ * 	A watcher thread loads the newest maze in the background whenever
+ * 	chenhowa.latest is repointed or the current rooms directory changes, and
+ * 	publishes it as a new snapshot. Players keep the snapshot they are in
+ * 	until they move (see movePlayer), so nobody ever sees half a maze.
+ */
+
+#ifndef CHENHOWA_RELOAD_H
+#define CHENHOWA_RELOAD_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "chenhowa.maze.h"
+#include "chenhowa.nametable.h"
+
+/*One loaded maze, freed once the last player leaves it */
+struct MazeSnapshot {
+	struct Maze maze; /*a private copy, so the files can change under it */
+	struct NameTable names;
+	uint32_t startRoom;
+	uint64_t generation; /*1 for the first maze loaded, then one more for each reload */
+	int refs; /*players in the maze, plus one while it is the current maze */
+	char dirName[256]; /*rooms directory it was loaded from */
+};
+
+/*The current maze, and the thread that replaces it */
+struct MazeReloader {
+	struct MazeSnapshot* current; /*newest snapshot. Only swapped while lock is held */
+	uint64_t generation; /*generation of current, readable without the lock */
+	pthread_mutex_t lock; /*held to take a reference to current, and to swap it */
+	int threads; /*threads that read room files */
+	int report; /*1 to print a line for each reload */
+	int inotify;
+	int latestWatch; /*watch on the current directory, for LATEST_LINK_NAME */
+	int dirWatch; /*watch on the rooms directory of current, or -1 */
+	int wake; /*eventfd that stops the watcher */
+	pthread_t thread;
+	uint64_t reloads; /*snapshots published after the first */
+	uint64_t failures; /*reloads that failed, leaving the old maze current */
+};
+
+/*Returns the generation of the newest snapshot. Cheap enough to call on every move */
+static inline uint64_t currentGeneration(struct MazeReloader* reloader) {
+	return __atomic_load_n(&reloader->generation, __ATOMIC_ACQUIRE);
+}
+
+int startMazeReloader(struct MazeReloader* reloader, int threads, int report);
+struct MazeSnapshot* acquireSnapshot(struct MazeReloader* reloader);
+void releaseSnapshot(struct MazeSnapshot* snapshot);
+void stopMazeReloader(struct MazeReloader* reloader);
+
+#endif
@@ -0,0 +1,87 @@
+/* Filename: chenhowa.rng.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Seeding and stream splitting for the xoshiro256** generator.
+ */
+
+#include <time.h>
+#include <unistd.h>
+
+#include "chenhowa.rng.h"
+
+/*Advances a splitmix64 state and returns its next output */
+static uint64_t splitMix(uint64_t* state) {
+	uint64_t z;
+
+	*state += 0x9e3779b97f4a7c15ULL;
+	z = *state;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/* Seeds a stream
+ * args: [1] rng, the stream to seed
+ * 	[2] seed, any 64 bit number; equal seeds give equal streams
+ * post: the state is filled from splitmix64, so it is never all zero and
+ * 	nearby seeds give unrelated streams
+ * ret: none
+ */
+void seedRng(struct Rng* rng, uint64_t seed) {
+	int i;
+
+	for(i = 0; i < 4; i++) {
+		rng->s[i] = splitMix(&seed);
+	}
+}
+
+/*Advances a stream by 2^128 numbers, as if rngNext had been called that many times */
+void jumpRng(struct Rng* rng) {
+	static const uint64_t jump[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+		0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+	uint64_t s[4] = { 0, 0, 0, 0 };
+	int i, b, j;
+
+	for(i = 0; i < 4; i++) {
+		for(b = 0; b < 64; b++) {
+			if(jump[i] & (uint64_t)1 << b) {
+				for(j = 0; j < 4; j++) {
+					s[j] ^= rng->s[j];
+				}
+			}
+			rngNext(rng);
+		}
+	}
+	for(j = 0; j < 4; j++) {
+		rng->s[j] = s[j];
+	}
+}
+
+/* Makes an independent stream for one thread
+ * args: [1] stream, the stream to set up
+ * 	[2] base, a seeded stream, left unchanged
+ * 	[3] index, which stream to make
+ * post: stream is base jumped index + 1 times, so the streams of different
+ * 	indices never overlap and each depends only on the seed and its index
+ * ret: none
+ */
+void splitRng(struct Rng* stream, const struct Rng* base, int index) {
+	int i;
+
+	*stream = *base;
+	for(i = 0; i <= index; i++) {
+		jumpRng(stream);
+	}
+}
+
+/*Returns a seed that differs between runs, even two started in the same second:
+ * the clock in nanoseconds mixed with the process id */
+uint64_t defaultSeed(void) {
+	struct timespec now;
+	uint64_t state;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	state = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+	state ^= (uint64_t)getpid() << 32;
+	return splitMix(&state);
+}
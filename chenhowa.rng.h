@@ -0,0 +1,66 @@
+/* Filename: chenhowa.rng.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Seedable random number generator for chenhowa.buildrooms.
+ * 	xoshiro256** (Blackman and Vigna), seeded through splitmix64, with unbiased
+ * 	bounded sampling (Lemire's multiply-and-reject) and a jump function that
+ * 	splits one seed into independent streams, one per thread.
+ */
+
+#ifndef CHENHOWA_RNG_H
+#define CHENHOWA_RNG_H
+
+#include <stdint.h>
+
+/*State of one random stream */
+struct Rng {
+	uint64_t s[4];
+};
+
+/*Rotates x left by k bits */
+static inline uint64_t rotateLeft(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+/*Returns the next 64 random bits of a stream */
+static inline uint64_t rngNext(struct Rng* rng) {
+	uint64_t result = rotateLeft(rng->s[1] * 5, 7) * 9;
+	uint64_t t = rng->s[1] << 17;
+
+	rng->s[2] ^= rng->s[0];
+	rng->s[3] ^= rng->s[1];
+	rng->s[1] ^= rng->s[2];
+	rng->s[0] ^= rng->s[3];
+	rng->s[2] ^= t;
+	rng->s[3] = rotateLeft(rng->s[3], 45);
+	return result;
+}
+
+/* Returns a uniformly random number below bound, with no modulo bias
+ * args: [1] rng, the stream to draw from
+ * 	[2] bound, one more than the largest number wanted; must not be 0
+ * ret: a number from 0 to bound - 1
+ *
+ * The top 32 bits of a random number times bound land in [0, bound) almost
+ * uniformly; the few low products that would make some results more likely
+ * than others are rejected, which is rare enough that the loop almost never repeats.
+ */
+static inline uint32_t rngBounded(struct Rng* rng, uint32_t bound) {
+	uint64_t product = (rngNext(rng) >> 32) * bound;
+	uint32_t threshold;
+
+	if((uint32_t)product < bound) {
+		threshold = -bound % bound;
+		while((uint32_t)product < threshold) {
+			product = (rngNext(rng) >> 32) * bound;
+		}
+	}
+	return product >> 32;
+}
+
+void seedRng(struct Rng* rng, uint64_t seed);
+void jumpRng(struct Rng* rng);
+void splitRng(struct Rng* stream, const struct Rng* base, int index);
+uint64_t defaultSeed(void);
+
+#endif
@@ -0,0 +1,334 @@
+/* Filename: chenhowa.roomgraph.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Sets up, edits and packs the RoomGraph that chenhowa.buildrooms
+ * 	generates mazes in, and writes its rooms out as room files.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "chenhowa.roomgraph.h"
+
+#define LINE_TEXT_LEN (MAX_NAME_LEN + 32) /*longest line of a room file, with room to spare */
+
+/* Checks that a maze with the given size and degree bounds can be generated
+ * args: [1] numRooms, the number of rooms
+ * 	[2] minDegree, the fewest connections a room may have
+ * 	[3] maxDegree, the most connections a room may have
+ * post: the problem is printed if there is one
+ * ret: 0 if 1 <= minDegree < maxDegree <= MAX_DEGREE_LIMIT and every room can
+ * 	find minDegree other rooms, 1 otherwise
+ *
+ * maxDegree must be above minDegree because a room that can't be satisfied by
+ * random pairing is given two connections at once.
+ */
+int checkDegreeBounds(uint32_t numRooms, int minDegree, int maxDegree) {
+	if(minDegree < 1 || maxDegree <= minDegree || maxDegree > MAX_DEGREE_LIMIT) {
+		fprintf(stderr, "Connection bounds must satisfy 1 <= min < max <= %i, not %i and %i\n",
+			MAX_DEGREE_LIMIT, minDegree, maxDegree);
+		return 1;
+	}
+	if(numRooms <= (uint32_t)minDegree || numRooms >= NO_ROOM) {
+		fprintf(stderr, "Need more than %i rooms to give every room %i connections\n", minDegree, minDegree);
+		return 1;
+	}
+	return 0;
+}
+
+/* Allocates a graph of rooms with no names, types or connections
+ * args: [1] graph, the RoomGraph to set up
+ * 	[2] numRooms, the number of rooms
+ * 	[3] minDegree, the fewest connections a room of the finished maze may have
+ * 	[4] maxDegree, the most connections a room may have
+ * pre: the bounds pass checkDegreeBounds
+ * post: graph must be released with freeRoomGraph
+ * ret: 0 on success, 1 if memory could not be allocated
+ */
+int initRoomGraph(struct RoomGraph* graph, uint32_t numRooms, int minDegree, int maxDegree) {
+	graph->numRooms = numRooms;
+	graph->minDegree = minDegree;
+	graph->maxDegree = maxDegree;
+	graph->names = calloc(numRooms + 1, sizeof(char*));
+	graph->types = calloc(numRooms + 1, sizeof(uint8_t));
+	graph->degrees = calloc(numRooms + 1, sizeof(uint8_t));
+	graph->links = malloc(((size_t)numRooms * maxDegree + 1) * sizeof(uint32_t));
+	if(graph->names == NULL || graph->types == NULL || graph->degrees == NULL || graph->links == NULL) {
+		freeRoomGraph(graph);
+		return 1;
+	}
+	return 0;
+}
+
+/*Frees the memory held by a RoomGraph, but not its names */
+void freeRoomGraph(struct RoomGraph* graph) {
+	free(graph->names);
+	free(graph->types);
+	free(graph->degrees);
+	free(graph->links);
+	graph->names = NULL;
+	graph->types = NULL;
+	graph->degrees = NULL;
+	graph->links = NULL;
+	graph->numRooms = 0;
+}
+
+/*Removes the one-way connection from x to y, if there is one. The order of
+ * x's other connections may change */
+void disconnectRoom(struct RoomGraph* graph, uint32_t x, uint32_t y) {
+	uint32_t* links = roomLinks(graph, x);
+	int i;
+
+	for(i = 0; i < graph->degrees[x]; i++) {
+		if(links[i] == y) {
+			/*Move the last connection into the freed spot */
+			graph->degrees[x]--;
+			links[i] = links[graph->degrees[x]];
+			return;
+		}
+	}
+}
+
+/* Determines whether or not a graph is full
+ * args: [1] graph, the RoomGraph to check
+ * ret: 0 if any room has fewer than minDegree or more than maxDegree connections,
+ * 	1 if every room is within bounds
+ */
+int graphIsFull(const struct RoomGraph* graph) {
+	uint32_t i;
+
+	for(i = 0; i < graph->numRooms; i++) {
+		if(graph->degrees[i] < graph->minDegree || graph->degrees[i] > graph->maxDegree) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*Returns 1 if the length bytes at name can be a room name: chenhowa.adventure
+ * reads names as single words, and the text format uses them as file names, so
+ * a room file with CRLF line ends is refused. name need not be NUL terminated */
+int isRoomName(const char* name, size_t length) {
+	size_t i;
+
+	if(length == 0 || length > MAX_NAME_LEN) {
+		return 0;
+	}
+	for(i = 0; i < length; i++) {
+		/*strchr also finds the terminator, so a NUL byte is refused too */
+		if(strchr(" \t\v\f\r/", name[i]) != NULL) {
+			return 0;
+		}
+	}
+	return !(length == 1 && name[0] == '.')
+		&& !(length == 2 && memcmp(name, "..", 2) == 0)
+		&& !(length == strlen(MAZE_FILE_NAME) && memcmp(name, MAZE_FILE_NAME, length) == 0);
+}
+
+/* Packs a graph into a maze image for the binary maze format
+ * args: [1] graph, a RoomGraph whose rooms all have names
+ * 	[2] maze, the Maze to create
+ * post: maze holds the same rooms, names, types and connections, and its name
+ * 	index is sorted. It must be released with closeMaze
+ * ret: 0 on success, 1 if memory could not be allocated or two rooms share a
+ * 	name (a message is printed)
+ */
+int graphToMaze(const struct RoomGraph* graph, struct Maze* maze) {
+	uint64_t numLinks = 0;
+	uint64_t namesSize = 0;
+	uint64_t link = 0;
+	uint64_t nameOffset = 0;
+	size_t length;
+	uint32_t i;
+
+	for(i = 0; i < graph->numRooms; i++) {
+		numLinks += graph->degrees[i];
+		namesSize += strlen(graph->names[i]) + 1;
+	}
+
+	if(createMaze(maze, graph->numRooms, numLinks, namesSize) != 0) {
+		return 1;
+	}
+
+	for(i = 0; i < graph->numRooms; i++) {
+		length = strlen(graph->names[i]) + 1;
+		memcpy(maze->names + nameOffset, graph->names[i], length);
+		maze->nameOffsets[i] = nameOffset;
+		nameOffset += length;
+
+		maze->types[i] = graph->types[i];
+		maze->degrees[i] = graph->degrees[i];
+		maze->linkStart[i] = link;
+		memcpy(maze->links + link, roomLinks(graph, i), graph->degrees[i] * sizeof(uint32_t));
+		link += graph->degrees[i];
+	}
+
+	if(sortMazeNames(maze) != 0) {
+		closeMaze(maze);
+		return 1;
+	}
+	return 0;
+}
+
+/*Copies text to at, and returns the end of the copy */
+static char* appendText(char* at, const char* text) {
+	size_t length = strlen(text);
+
+	memcpy(at, text, length);
+	return at + length;
+}
+
+/*Writes a non-negative number to at in decimal, and returns the end of it */
+static char* appendNumber(char* at, int number) {
+	char digits[12];
+	int count = 0;
+
+	do {
+		digits[count] = '0' + number % 10;
+		count++;
+		number /= 10;
+	} while(number > 0);
+	while(count > 0) {
+		count--;
+		*at = digits[count];
+		at++;
+	}
+	return at;
+}
+
+/* Formats a room as the text of its room file
+ * Args: [1] text, a buffer of at least roomTextLength(graph) bytes
+ * 	[2] graph, the graph the room is in
+ * 	[3] room, the room to format
+ * pre: the room's name and its connections' names are at most MAX_NAME_LEN long
+ * ret: the number of bytes written to text. text is not NUL terminated
+ */
+size_t formatRoom(char* text, const struct RoomGraph* graph, int room) {
+	const uint32_t* links = roomLinks(graph, room);
+	char* at = text;
+	int i;
+
+	/*The name of the Room, or NULL if there is no name */
+	if(graph->names[room] == NULL) {
+		at = appendText(at, "NULL\n");
+	} else {
+		at = appendText(at, "ROOM NAME: ");
+		at = appendText(at, graph->names[room]);
+		*at++ = '\n';
+	}
+
+	/*The name of each connected room */
+	for(i = 0; i < graph->degrees[room]; i++) {
+		at = appendText(at, "CONNECTION ");
+		at = appendNumber(at, i + 1);
+		at = appendText(at, ": ");
+		at = appendText(at, graph->names[links[i]]);
+		*at++ = '\n';
+	}
+
+	/*The room type, if one has been assigned */
+	switch (graph->types[room]) {
+		case START_ROOM: at = appendText(at, "ROOM TYPE: START_ROOM\n");
+		break;
+		case MID_ROOM: at = appendText(at, "ROOM TYPE: MID_ROOM\n");
+		break;
+		case END_ROOM: at = appendText(at, "ROOM TYPE: END_ROOM\n");
+		break;
+		default: at = appendText(at, "ROOM TYPE: UNASSIGNED_ROOM\n");
+		break;
+	}
+
+	return at - text;
+}
+
+/*Returns the size of a buffer that fits the text of any room of a graph */
+size_t roomTextLength(const struct RoomGraph* graph) {
+	return (size_t)(graph->maxDegree + 2) * LINE_TEXT_LEN;
+}
+
+/*Prints the data in a room to a given opened FILE */
+void printRoom(FILE *file, const struct RoomGraph* graph, int room) {
+	char* text = malloc(roomTextLength(graph));
+
+	if(text == NULL) {
+		return;
+	}
+	fwrite(text, 1, formatRoom(text, graph, room), file);
+	free(text);
+
+	/*flush the output to the file */
+	fflush(file);
+}
+
+/* Writes the text file of one room, with a single write
+ * Args: [1] dirFd, the opened directory to write to
+ * 	[2] graph, the graph the room is in
+ * 	[3] room, the room to write, which must have a name
+ * 	[4] text, a buffer of at least roomTextLength(graph) bytes to format the room in
+ * post: the directory holds a file named after the room, in the format printRoom prints
+ * ret: 0 on success, 1 if the file could not be written
+ */
+int writeRoomFile(int dirFd, const struct RoomGraph* graph, int room, char* text) {
+	size_t length = formatRoom(text, graph, room);
+	size_t written;
+	ssize_t result;
+	int fd;
+
+	fd = openat(dirFd, graph->names[room], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0) {
+		return 1;
+	}
+
+	/*Write the whole room, picking up where a short write left off */
+	for(written = 0; written < length; written += result) {
+		result = write(fd, text + written, length - written);
+		if(result < 0 && errno == EINTR) {
+			result = 0;
+		} else if(result < 0) {
+			break;
+		}
+	}
+	return close(fd) != 0 || written < length;
+}
+
+/* Writes one text file per room into a directory. Each room is formatted into
+ * 	one reusable buffer and written with a single write, and files are opened
+ * 	relative to the directory, so the kernel never walks the full path again
+ * Args: [1] dirname, the directory to write to
+ * 	[2] graph, a RoomGraph whose rooms all have names
+ * post: the directory holds a file named after each room, in the format printRoom prints
+ * ret: 0 on success, 1 if a file could not be written
+ */
+int writeRoomFiles(const char* dirname, const struct RoomGraph* graph) {
+	char* text;
+	int dirFd;
+	uint32_t i;
+
+	text = malloc(roomTextLength(graph));
+	dirFd = open(dirname, O_RDONLY | O_DIRECTORY);
+	if(text == NULL || dirFd < 0) {
+		fprintf(stderr, "Could not open %s\n", dirname);
+		free(text);
+		if(dirFd >= 0) {
+			close(dirFd);
+		}
+		return 1;
+	}
+
+	for(i = 0; i < graph->numRooms; i++) {
+		if(writeRoomFile(dirFd, graph, i, text) != 0) {
+			fprintf(stderr, "Could not write %s/%s\n", dirname, graph->names[i]);
+			free(text);
+			close(dirFd);
+			return 1;
+		}
+	}
+
+	free(text);
+	close(dirFd);
+	return 0;
+}
@@ -0,0 +1,77 @@
+/* Filename: chenhowa.roomgraph.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Mutable graph of rooms for building and editing mazes. The number
+ * 	of rooms and the bounds on each room's connections are chosen at run time.
+ * 	Every room owns maxDegree link slots in one shared arena, so connecting and
+ * 	disconnecting rooms never allocates, and a room's links sit in one short run
+ * 	of memory just like the old fixed-size connection arrays.
+ */
+
+#ifndef CHENHOWA_ROOMGRAPH_H
+#define CHENHOWA_ROOMGRAPH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "chenhowa.maze.h"
+
+#define MAX_DEGREE_LIMIT UINT8_MAX /*largest maxDegree, since a Maze stores degrees in a byte */
+#define MAX_NAME_LEN 255 /*longest room name chenhowa.adventure can read */
+
+/*Rooms, and the connections between them, as room indices */
+struct RoomGraph {
+	uint32_t numRooms;
+	int minDegree; /*fewest connections a room of a finished maze may have */
+	int maxDegree; /*most connections a room may have */
+	char** names; /*name of each room, or NULL. The names are not owned by the graph */
+	uint8_t* types; /*type of each room, or 0 if it has none yet */
+	uint8_t* degrees; /*number of connections of each room */
+	uint32_t* links; /*maxDegree slots per room; see roomLinks */
+};
+
+/*Returns the link slots of a room. The first graph->degrees[room] hold its connections */
+static inline uint32_t* roomLinks(const struct RoomGraph* graph, uint32_t room) {
+	return graph->links + (size_t)room * graph->maxDegree;
+}
+
+/*Returns 1 if a room has fewer than maxDegree connections */
+static inline int canAddConnection(const struct RoomGraph* graph, uint32_t room) {
+	return graph->degrees[room] < graph->maxDegree;
+}
+
+/*Returns 1 if x has a one-way connection to y */
+static inline int isConnected(const struct RoomGraph* graph, uint32_t x, uint32_t y) {
+	const uint32_t* links = roomLinks(graph, x);
+	int i;
+
+	for(i = 0; i < graph->degrees[x]; i++) {
+		if(links[i] == y) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*Creates a one-way connection from x to y.
+ * WARNING: Does not check if this connection is legal. Use canAddConnection beforehand */
+static inline void connectRoom(struct RoomGraph* graph, uint32_t x, uint32_t y) {
+	roomLinks(graph, x)[graph->degrees[x]] = y;
+	graph->degrees[x]++;
+}
+
+int isRoomName(const char* name, size_t length);
+int checkDegreeBounds(uint32_t numRooms, int minDegree, int maxDegree);
+int initRoomGraph(struct RoomGraph* graph, uint32_t numRooms, int minDegree, int maxDegree);
+void freeRoomGraph(struct RoomGraph* graph);
+void disconnectRoom(struct RoomGraph* graph, uint32_t x, uint32_t y);
+int graphIsFull(const struct RoomGraph* graph);
+int graphToMaze(const struct RoomGraph* graph, struct Maze* maze);
+size_t roomTextLength(const struct RoomGraph* graph);
+size_t formatRoom(char* text, const struct RoomGraph* graph, int room);
+void printRoom(FILE* file, const struct RoomGraph* graph, int room);
+int writeRoomFile(int dirFd, const struct RoomGraph* graph, int room, char* text);
+int writeRoomFiles(const char* dirname, const struct RoomGraph* graph);
+
+#endif
@@ -0,0 +1,555 @@
+/* Filename: chenhowa.server.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Serves game sessions over a Unix domain socket.
+ *
+ * 	All workers wait on one epoll instance. Every session socket is registered
+ * 	with EPOLLONESHOT, so whichever worker is woken for a session owns it until
+ * 	it rearms the socket, and a session never needs a lock of its own. The
+ * 	listening socket is rearmed the same way after each round of accepts.
+ * 	SIGINT and SIGTERM arrive through a signalfd; the worker that reads one
+ * 	raises an eventfd that every worker sees, and they all return.
+ */
+
+#define _GNU_SOURCE /*for accept4 */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "chenhowa.server.h"
+#include "chenhowa.player.h"
+
+#define EVENTS_PER_WAIT 4 /*events a worker takes at once; few, so one worker doesn't hoard ready sessions */
+#define OUTPUT_LIMIT 65536 /*pending output at which a session stops reading commands */
+#define LISTEN_BACKLOG 1024
+
+/*One connected player */
+struct Session {
+	int fd; /*the session's socket */
+	struct Player player;
+	char in[SERVER_LINE_LEN]; /*received bytes not yet handled */
+	size_t inLength; /*bytes used in in */
+	char* out; /*replies not yet sent */
+	size_t outLength; /*bytes used in out */
+	size_t outSent; /*bytes of out already sent */
+	size_t outCapacity; /*capacity of out */
+	int closing; /*1 once the session should be closed after its output is sent */
+	struct Session* prev; /*neighbours in the list of open sessions */
+	struct Session* next;
+};
+
+/*State shared by every worker */
+struct Server {
+	int epoll;
+	int listener; /*listening socket */
+	int signals; /*signalfd for SIGINT and SIGTERM */
+	int wake; /*eventfd that becomes readable when the server stops */
+	struct Maze* maze; /*NULL if sessions take their maze from reloader */
+	struct NameTable* names;
+	struct MazeReloader* reloader; /*source of the newest maze, or NULL */
+	struct TimeService* timeService;
+	uint32_t startRoom; /*START_ROOM of maze, found once for every session */
+	pthread_mutex_t lock; /*guards the fields below */
+	struct Session* sessions; /*every open session */
+	unsigned long long opened; /*sessions accepted */
+	unsigned long long finished; /*sessions that reached the END_ROOM */
+	unsigned long long moves; /*moves made by closed sessions */
+};
+
+/* Queues bytes to be sent to a session
+ * args: [1] session, the session to reply to
+ * 	[2] text, the bytes to queue
+ * 	[3] length, the number of bytes
+ * post: if memory could not be allocated, the session is marked closing instead
+ * ret: none
+ */
+static void appendOutput(struct Session* session, const char* text, size_t length) {
+	size_t capacity = session->outCapacity;
+	char* grown;
+
+	if(session->outSent == session->outLength) {
+		session->outSent = 0;
+		session->outLength = 0;
+	}
+	while(session->outLength + length > capacity) {
+		capacity = capacity ? 2 * capacity : SERVER_LINE_LEN;
+	}
+	if(capacity != session->outCapacity) {
+		grown = realloc(session->out, capacity);
+		if(grown == NULL) {
+			session->closing = 1;
+			return;
+		}
+		session->out = grown;
+		session->outCapacity = capacity;
+	}
+	memcpy(session->out + session->outLength, text, length);
+	session->outLength += length;
+}
+
+/*Queues a ROOM line describing the session's current room */
+static void appendRoom(struct Session* session) {
+	const struct Maze* maze = session->player.maze;
+	uint32_t room = session->player.curRoom;
+	const uint32_t* connections = mazeConnections(maze, room);
+	const char* name;
+	int i;
+
+	appendOutput(session, "ROOM ", 5);
+	name = mazeRoomName(maze, room);
+	appendOutput(session, name, strlen(name));
+	for(i = 0; i < maze->degrees[room]; i++) {
+		name = mazeRoomName(maze, connections[i]);
+		appendOutput(session, " ", 1);
+		appendOutput(session, name, strlen(name));
+	}
+	appendOutput(session, "\n", 1);
+}
+
+/*Sends as much queued output as the socket takes without blocking.
+ * Returns 0 unless the socket failed, in which case the output is dropped and the
+ * session is marked closing */
+static int flushOutput(struct Session* session) {
+	ssize_t sent;
+
+	while(session->outSent < session->outLength) {
+		sent = send(session->fd, session->out + session->outSent,
+			session->outLength - session->outSent, MSG_NOSIGNAL);
+		if(sent < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			if(errno == EAGAIN || errno == EWOULDBLOCK) {
+				return 0;
+			}
+			session->closing = 1;
+			session->outSent = session->outLength;
+			return 1;
+		}
+		session->outSent += sent;
+	}
+	return 0;
+}
+
+/* Executes one command line from a session
+ * args: [1] server, the server
+ * 	[2] session, the session that sent the line
+ * 	[3] line, the command, without its newline
+ * post: the reply is queued. A session that reached the END_ROOM is marked closing
+ * ret: none
+ */
+static void executeLine(struct Server* server, struct Session* session, const char* line) {
+	char time[TIME_TEXT_LEN];
+	char reply[TIME_TEXT_LEN + 16];
+	int length;
+
+	if(strcmp(line, "time") == 0) {
+		requestTime(server->timeService, time, sizeof(time));
+		length = snprintf(reply, sizeof(reply), "TIME %s\n", time);
+		appendOutput(session, reply, length);
+	} else if(movePlayer(&session->player, line) != 0) {
+		appendOutput(session, "HUH\n", 4);
+	} else if(playerHasWon(&session->player)) {
+		length = snprintf(reply, sizeof(reply), "END %d\n", session->player.visited);
+		appendOutput(session, reply, length);
+		session->closing = 1;
+	} else {
+		appendRoom(session);
+	}
+}
+
+/*Executes every complete line a session has received, until it is closing or has
+ * too much output pending. Unhandled bytes are moved to the start of in */
+static void executeLines(struct Server* server, struct Session* session) {
+	char* line = session->in;
+	char* end;
+	size_t remaining = session->inLength;
+
+	while(!session->closing && session->outLength - session->outSent < OUTPUT_LIMIT) {
+		end = memchr(line, '\n', remaining);
+		if(end == NULL) {
+			break;
+		}
+		*end = '\0';
+		if(end > line && end[-1] == '\r') {
+			end[-1] = '\0';
+		}
+		executeLine(server, session, line);
+		remaining -= end + 1 - line;
+		line = end + 1;
+	}
+
+	memmove(session->in, line, remaining);
+	session->inLength = remaining;
+}
+
+/*Reads and executes commands from a session until its socket is drained, it is
+ * closing, or it has too much output pending */
+static void readCommands(struct Server* server, struct Session* session) {
+	ssize_t received;
+
+	while(!session->closing && session->outLength - session->outSent < OUTPUT_LIMIT) {
+		/*A full buffer with no newline in it can never become a command */
+		if(session->inLength == sizeof(session->in)) {
+			session->closing = 1;
+			return;
+		}
+		received = read(session->fd, session->in + session->inLength,
+			sizeof(session->in) - session->inLength);
+		if(received < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			if(errno != EAGAIN && errno != EWOULDBLOCK) {
+				session->closing = 1;
+			}
+			return;
+		}
+		if(received == 0) {
+			/*The client hung up, so nothing more will be read by it either */
+			session->closing = 1;
+			session->outSent = session->outLength;
+			return;
+		}
+		session->inLength += received;
+		executeLines(server, session);
+	}
+}
+
+/*Closes a session's socket, takes it off the list of open sessions, and frees it */
+static void closeSession(struct Server* server, struct Session* session) {
+	pthread_mutex_lock(&server->lock);
+	if(session->prev != NULL) {
+		session->prev->next = session->next;
+	} else {
+		server->sessions = session->next;
+	}
+	if(session->next != NULL) {
+		session->next->prev = session->prev;
+	}
+	server->moves += session->player.visited;
+	server->finished += playerHasWon(&session->player);
+	pthread_mutex_unlock(&server->lock);
+
+	close(session->fd);
+	freePlayer(&session->player);
+	free(session->out);
+	free(session);
+}
+
+/*Rearms a session's socket for the events it now waits on, or closes the
+ * session if it is finished. After this the session may belong to another worker */
+static void releaseSession(struct Server* server, struct Session* session) {
+	struct epoll_event event;
+	int pending = session->outSent < session->outLength;
+
+	if(session->closing && !pending) {
+		closeSession(server, session);
+		return;
+	}
+
+	/*While replies are still pending, only wait for the socket to drain, so a
+ * 		client that doesn't read can't make the server buffer without limit */
+	event.events = EPOLLONESHOT | (pending ? EPOLLOUT : EPOLLIN);
+	event.data.ptr = session;
+	if(epoll_ctl(server->epoll, EPOLL_CTL_MOD, session->fd, &event) != 0) {
+		closeSession(server, session);
+	}
+}
+
+/* Handles an event on a session socket
+ * args: [1] server, the server
+ * 	[2] session, the session, owned by this worker until it is released
+ * 	[3] events, the epoll events that were reported
+ * ret: none
+ */
+static void handleSession(struct Server* server, struct Session* session, uint32_t events) {
+	if(events & EPOLLERR) {
+		closeSession(server, session);
+		return;
+	}
+
+	/*Finish sending old replies before executing anything new */
+	flushOutput(session);
+	if(session->outSent == session->outLength) {
+		executeLines(server, session);
+		if(events & (EPOLLIN | EPOLLHUP)) {
+			readCommands(server, session);
+		}
+		flushOutput(session);
+	}
+
+	releaseSession(server, session);
+}
+
+/*Accepts every pending connection, greets it with its START_ROOM, and registers it
+ * with the epoll instance. Then rearms the listening socket */
+static void acceptSessions(struct Server* server) {
+	struct Session* session;
+	struct epoll_event event;
+	int result;
+	int fd;
+
+	while((fd = accept4(server->listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+		session = calloc(1, sizeof(struct Session));
+		if(session == NULL) {
+			close(fd);
+			continue;
+		}
+		if(server->reloader != NULL) {
+			result = initPlayerFromReloader(&session->player, server->reloader, server->timeService);
+		} else {
+			result = initPlayerInRoom(&session->player, server->maze, server->names,
+				server->timeService, server->startRoom);
+		}
+		if(result != 0) {
+			free(session);
+			close(fd);
+			continue;
+		}
+		session->fd = fd;
+		appendRoom(session);
+		flushOutput(session);
+
+		pthread_mutex_lock(&server->lock);
+		session->next = server->sessions;
+		if(server->sessions != NULL) {
+			server->sessions->prev = session;
+		}
+		server->sessions = session;
+		server->opened++;
+		pthread_mutex_unlock(&server->lock);
+
+		/*From here on another worker may already be handling the session */
+		event.events = EPOLLIN | EPOLLONESHOT;
+		if(session->outSent < session->outLength) {
+			event.events |= EPOLLOUT;
+		}
+		event.data.ptr = session;
+		if(epoll_ctl(server->epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+			closeSession(server, session);
+		}
+	}
+	if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+		fprintf(stderr, "Error. Couldn't accept a session: %s\n", strerror(errno));
+	}
+
+	event.events = EPOLLIN | EPOLLONESHOT;
+	event.data.ptr = &server->listener;
+	epoll_ctl(server->epoll, EPOLL_CTL_MOD, server->listener, &event);
+}
+
+/* Description: body of every server worker. Waits on the shared epoll instance
+ * 	and handles whatever it is woken for
+ * Args: [1] args, the Server
+ * Post: this function executes until the server is stopped
+ * ret: NULL
+ */
+static void* serveWorker(void* args) {
+	struct Server* server = args;
+	struct epoll_event events[EVENTS_PER_WAIT];
+	struct signalfd_siginfo signal;
+	uint64_t one = 1;
+	int count;
+	int i;
+
+	while(1) {
+		count = epoll_wait(server->epoll, events, EVENTS_PER_WAIT, -1);
+		if(count < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			fprintf(stderr, "Error. Server worker stopped: %s\n", strerror(errno));
+			return NULL;
+		}
+
+		for(i = 0; i < count; i++) {
+			if(events[i].data.ptr == &server->wake) {
+				return NULL;
+			} else if(events[i].data.ptr == &server->signals) {
+				/*Never rearmed, so only one worker reads the signal; the
+ * 					eventfd then stays readable and wakes all of them */
+				if(read(server->signals, &signal, sizeof(signal)) > 0
+						&& write(server->wake, &one, sizeof(one)) < 0) {
+					fprintf(stderr, "Error. Couldn't wake the server workers\n");
+				}
+			} else if(events[i].data.ptr == &server->listener) {
+				acceptSessions(server);
+			} else {
+				handleSession(server, events[i].data.ptr, events[i].events);
+			}
+		}
+	}
+}
+
+/* Opens a listening Unix domain socket
+ * args: [1] path, where to create the socket
+ * post: a stale socket left at path by an earlier server is replaced. Any other
+ * 	kind of file at path is left alone, and the socket is not created
+ * ret: the non-blocking listening socket, or -1 on error
+ */
+static int openListener(const char* path) {
+	struct sockaddr_un address;
+	struct stat info;
+	int fd;
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(strlen(path) >= sizeof(address.sun_path)) {
+		fprintf(stderr, "Error. Socket path %s is too long\n", path);
+		return -1;
+	}
+	strcpy(address.sun_path, path);
+
+	if(lstat(path, &info) == 0 && S_ISSOCK(info.st_mode)) {
+		unlink(path);
+	}
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(fd < 0) {
+		fprintf(stderr, "Error. Couldn't create a socket: %s\n", strerror(errno));
+		return -1;
+	}
+	if(bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0
+			|| listen(fd, LISTEN_BACKLOG) != 0) {
+		fprintf(stderr, "Error. Couldn't listen on %s: %s\n", path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/*Registers fd with the epoll instance, reporting it through data */
+static int watchFd(int epoll, int fd, uint32_t events, void* data) {
+	struct epoll_event event;
+
+	event.events = events;
+	event.data.ptr = data;
+	return epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event);
+}
+
+/*Closes every descriptor of a server that was opened */
+static void closeServerFds(struct Server* server) {
+	if(server->listener >= 0) {
+		close(server->listener);
+	}
+	if(server->wake >= 0) {
+		close(server->wake);
+	}
+	if(server->signals >= 0) {
+		close(server->signals);
+	}
+	if(server->epoll >= 0) {
+		close(server->epoll);
+	}
+}
+
+/* Serves game sessions until SIGINT or SIGTERM is received
+ * args: [1] socketPath, where to create the listening socket
+ * 	[2] workers, the number of worker threads, counting the calling thread
+ * 	[3] maze, the loaded maze, shared read-only by every session
+ * 	[4] names, the name table of maze
+ * 	[5] reloader, a started MazeReloader to take the maze from instead, or NULL.
+ * 	New sessions start in its newest maze, and sessions move to newer mazes as
+ * 	they are published; maze and names are then not used
+ * 	[6] timeService, a started time service for the time command
+ * pre: SIGINT and SIGTERM are blocked in every thread of the process, so they can
+ * 	only be received through this server's signalfd
+ * post: every session has been closed, the socket file has been removed, and a
+ * 	summary of the sessions served is printed to stdout
+ * ret: 0 on success, 1 if the server could not be started
+ */
+int runServer(const char* socketPath, int workers, struct Maze* maze, struct NameTable* names,
+		struct MazeReloader* reloader, struct TimeService* timeService) {
+	struct Server server;
+	struct MazeSnapshot* snapshot;
+	pthread_t* threads;
+	sigset_t stopSignals;
+	uint32_t numRooms;
+	int started;
+	int i;
+
+	memset(&server, 0, sizeof(server));
+	server.maze = maze;
+	server.names = names;
+	server.reloader = reloader;
+	server.timeService = timeService;
+	if(reloader != NULL) {
+		snapshot = acquireSnapshot(reloader);
+		numRooms = snapshot->maze.numRooms;
+		server.startRoom = snapshot->startRoom;
+		releaseSnapshot(snapshot);
+	} else {
+		numRooms = maze->numRooms;
+		server.startRoom = findRoomOfType(maze, START_ROOM);
+	}
+	if(server.startRoom == NO_ROOM) {
+		fprintf(stderr, "Error. The maze has no START_ROOM\n");
+		return 1;
+	}
+	if(workers < 1) {
+		workers = 1;
+	}
+
+	sigemptyset(&stopSignals);
+	sigaddset(&stopSignals, SIGINT);
+	sigaddset(&stopSignals, SIGTERM);
+	server.epoll = epoll_create1(EPOLL_CLOEXEC);
+	server.signals = signalfd(-1, &stopSignals, SFD_NONBLOCK | SFD_CLOEXEC);
+	server.wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	server.listener = openListener(socketPath);
+	if(server.epoll < 0 || server.signals < 0 || server.wake < 0 || server.listener < 0
+			|| watchFd(server.epoll, server.listener, EPOLLIN | EPOLLONESHOT, &server.listener) != 0
+			|| watchFd(server.epoll, server.signals, EPOLLIN | EPOLLONESHOT, &server.signals) != 0
+			|| watchFd(server.epoll, server.wake, EPOLLIN, &server.wake) != 0) {
+		fprintf(stderr, "Error. Couldn't start the server on %s\n", socketPath);
+		closeServerFds(&server);
+		return 1;
+	}
+	threads = malloc(workers * sizeof(pthread_t));
+	if(threads == NULL) {
+		closeServerFds(&server);
+		unlink(socketPath);
+		return 1;
+	}
+	pthread_mutex_init(&server.lock, NULL);
+	printf("serving %u rooms on %s with %d workers%s\n", numRooms, socketPath, workers,
+		reloader != NULL ? ", reloading new mazes" : "");
+	fflush(stdout);
+
+	/*The calling thread is worker 0 */
+	for(started = 1; started < workers; started++) {
+		if(pthread_create(&threads[started], NULL, serveWorker, &server) != 0) {
+			fprintf(stderr, "Error. Only %d of %d server workers started\n", started, workers);
+			break;
+		}
+	}
+	serveWorker(&server);
+	for(i = 1; i < started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	/*Every worker has returned, so the sessions left are safe to close here */
+	while(server.sessions != NULL) {
+		closeSession(&server, server.sessions);
+	}
+	unlink(socketPath);
+	printf("served %llu sessions (%llu reached the END_ROOM), %llu moves\n",
+		server.opened, server.finished, server.moves);
+
+	closeServerFds(&server);
+	pthread_mutex_destroy(&server.lock);
+	free(threads);
+	return 0;
+}
@@ -0,0 +1,31 @@
+/* Filename: chenhowa.server.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Game server for chenhowa.adventure. Many players share one loaded,
+ * 	read-only maze, each as a session on a Unix domain socket. With a
+ * 	MazeReloader, sessions move to each new maze on their next move.
+ *
+ * 	The protocol is line based. Every line ends in '\n'.
+ * 	server: ROOM <name> <connection> <connection> ...	sent on connect and after every move
+ * 	client: <room name>					move to a connected room
+ * 	server: HUH						the room is not a connection
+ * 	client: time						ask for the time
+ * 	server: TIME <time>
+ * 	server: END <steps>					sent instead of ROOM when the END_ROOM
+ * 								is reached; the server then hangs up
+ */
+
+#ifndef CHENHOWA_SERVER_H
+#define CHENHOWA_SERVER_H
+
+#include "chenhowa.maze.h"
+#include "chenhowa.nametable.h"
+#include "chenhowa.timeservice.h"
+#include "chenhowa.reload.h"
+
+#define SERVER_LINE_LEN 4096 /*longest line either side may send, newline included */
+
+int runServer(const char* socketPath, int workers, struct Maze* maze, struct NameTable* names,
+	struct MazeReloader* reloader, struct TimeService* timeService);
+
+#endif
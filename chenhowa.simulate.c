@@ -0,0 +1,238 @@
+/* Filename: chenhowa.simulate.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Random walk simulation for chenhowa.adventure --simulate.
+ *
+ * 	The walkers are split evenly across the threads, and every thread draws
+ * 	from its own random stream, split from one seed, so the threads share
+ * 	nothing but the read-only maze. A thread walks WALK_BATCH walkers at once,
+ * 	kept as a structure of arrays: one pass moves every lane a step, and a
+ * 	second pass retires the lanes that hit the END_ROOM or gave up and refills
+ * 	them with the thread's next walkers. Keeping the lanes busy hides the
+ * 	latency of each lane's random connection lookup behind the others.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "chenhowa.simulate.h"
+#include "chenhowa.rng.h"
+#include "chenhowa.timing.h"
+#include "chenhowa.graph.h"
+
+#define WALK_BATCH 64 /*walkers a thread moves together */
+#define GAVE_UP UINT32_MAX /*step count of a walker that never hit the END_ROOM */
+#define HISTOGRAM_BUCKETS 33 /*bucket b counts walks of fewer than 2^b steps */
+
+/*One thread's share of the walkers */
+struct WalkTask {
+	const struct Maze* maze;
+	uint32_t start; /*START_ROOM */
+	uint32_t maxSteps;
+	uint64_t first; /*index of the task's first walker */
+	uint64_t end; /*one past the task's last walker */
+	uint32_t* steps; /*steps taken by every walker, indexed by walker */
+	struct Rng rng; /*the task's own random stream */
+	uint64_t totalSteps; /*steps taken by the task's walkers, counting the ones that gave up */
+};
+
+/*Moves a task's walkers until each hits the END_ROOM or gives up */
+static void* walkTask(void* arg) {
+	struct WalkTask* task = arg;
+	const struct Maze* maze = task->maze;
+	uint32_t room[WALK_BATCH]; /*current room of each lane */
+	uint32_t taken[WALK_BATCH]; /*steps taken by each lane's walker */
+	uint64_t walker[WALK_BATCH]; /*walker in each lane */
+	uint64_t next = task->first;
+	int active = 0;
+	int lane;
+	uint32_t r;
+
+	/*Fill the lanes; with fewer walkers than lanes, the rest stay empty */
+	while(active < WALK_BATCH && next < task->end) {
+		room[active] = task->start;
+		taken[active] = 0;
+		walker[active] = next;
+		next++;
+		active++;
+	}
+
+	while(active > 0) {
+		/*Move every lane one step */
+		for(lane = 0; lane < active; lane++) {
+			r = room[lane];
+			room[lane] = maze->links[maze->linkStart[r] + rngBounded(&task->rng, maze->degrees[r])];
+			taken[lane]++;
+		}
+
+		/*Retire the lanes that are done, refilling them with new walkers or,
+ * 			once there are none, with the last active lane */
+		for(lane = 0; lane < active; lane++) {
+			while(lane < active && (maze->types[room[lane]] == END_ROOM || taken[lane] == task->maxSteps)) {
+				task->steps[walker[lane]] = maze->types[room[lane]] == END_ROOM ? taken[lane] : GAVE_UP;
+				task->totalSteps += taken[lane];
+				if(next < task->end) {
+					room[lane] = task->start;
+					taken[lane] = 0;
+					walker[lane] = next;
+					next++;
+				} else {
+					active--;
+					room[lane] = room[active];
+					taken[lane] = taken[active];
+					walker[lane] = walker[active];
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/*Orders step counts from fewest to most for qsort */
+static int compareSteps(const void* a, const void* b) {
+	uint32_t x = *(const uint32_t*)a;
+	uint32_t y = *(const uint32_t*)b;
+
+	return (x > y) - (x < y);
+}
+
+/* Prints the distribution of the walks' step counts
+ * args: [1] steps, the step count of every walker, sorted, with GAVE_UP last
+ * 	[2] simulation, what was simulated
+ * 	[3] totalSteps, the steps taken by every walker
+ * 	[4] seconds, how long the walks took
+ * ret: none
+ */
+static void printWalks(const uint32_t* steps, const struct Simulation* simulation, uint64_t totalSteps,
+		double seconds) {
+	uint64_t histogram[HISTOGRAM_BUCKETS] = { 0 };
+	uint64_t reached = 0;
+	uint64_t i;
+	double sum = 0;
+	double squares = 0;
+	double mean;
+	double deviation = 0;
+	int bucket;
+
+	while(reached < simulation->walkers && steps[reached] != GAVE_UP) {
+		sum += steps[reached];
+		squares += (double)steps[reached] * steps[reached];
+		for(bucket = 0; ((uint64_t)1 << bucket) <= steps[reached]; bucket++);
+		histogram[bucket]++;
+		reached++;
+	}
+
+	printf("walkers: %llu, threads: %i, seed: %llu\n", (unsigned long long)simulation->walkers,
+		simulation->threads, (unsigned long long)simulation->seed);
+	printf("reached the END_ROOM: %llu, gave up after %u steps: %llu\n", (unsigned long long)reached,
+		simulation->maxSteps, (unsigned long long)(simulation->walkers - reached));
+	if(reached == 0) {
+		return;
+	}
+
+	/*The mean of the walks that finished is the hitting time from the START_ROOM */
+	mean = sum / reached;
+	if(reached > 1) {
+		deviation = sqrt((squares - sum * mean) / (reached - 1));
+	}
+	printf("hitting time: mean %.1f steps (+/- %.1f), standard deviation %.1f\n", mean,
+		deviation / sqrt(reached), deviation);
+	printf("steps: min %u, p50 %u, p90 %u, p99 %u, max %u\n", steps[0], steps[(reached - 1) / 2],
+		steps[(uint64_t)((reached - 1) * 0.9)], steps[(uint64_t)((reached - 1) * 0.99)], steps[reached - 1]);
+	if(simulation->optimal != 0 && simulation->optimal != NO_PATH) {
+		printf("shortest route: %u steps, %.1f times fewer than the mean walk\n", simulation->optimal,
+			mean / simulation->optimal);
+	}
+	printf("elapsed: %.3f s, %.0f steps per second\n", seconds, totalSteps / seconds);
+
+	printf("distribution of steps:\n");
+	for(i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		if(histogram[i] > 0) {
+			printf("  %10llu to %10llu: %llu\n", i ? 1ULL << (i - 1) : 0ULL,
+				(1ULL << i) - 1, (unsigned long long)histogram[i]);
+		}
+	}
+}
+
+/* Walks random walkers from the START_ROOM until they hit the END_ROOM, and
+ * 	prints the distribution of how many steps they took
+ * args: [1] maze, the loaded maze
+ * 	[2] simulation, how many walkers to run, and how
+ * pre: simulation->walkers and simulation->threads are at least 1
+ * ret: 0 on success, 1 if the maze has no START_ROOM or END_ROOM or memory
+ * 	could not be allocated
+ */
+int runSimulation(const struct Maze* maze, const struct Simulation* simulation) {
+	struct WalkTask* tasks;
+	pthread_t* workers;
+	char* started;
+	uint32_t* steps;
+	struct Rng base;
+	uint32_t start = findRoomOfType(maze, START_ROOM);
+	uint64_t totalSteps = 0;
+	double began;
+	double seconds;
+	int threads = simulation->threads;
+	int i;
+
+	if(start == NO_ROOM || findRoomOfType(maze, END_ROOM) == NO_ROOM) {
+		fprintf(stderr, "Error. The maze needs a START_ROOM and an END_ROOM\n");
+		return 1;
+	}
+	if((uint64_t)threads > simulation->walkers) {
+		threads = simulation->walkers;
+	}
+	steps = malloc(simulation->walkers * sizeof(uint32_t));
+	tasks = calloc(threads, sizeof(struct WalkTask));
+	workers = calloc(threads, sizeof(pthread_t));
+	started = calloc(threads, 1);
+	if(steps == NULL || tasks == NULL || workers == NULL || started == NULL) {
+		fprintf(stderr, "Error. Couldn't allocate %llu walkers\n", (unsigned long long)simulation->walkers);
+		free(steps);
+		free(tasks);
+		free(workers);
+		free(started);
+		return 1;
+	}
+
+	seedRng(&base, simulation->seed);
+	for(i = 0; i < threads; i++) {
+		tasks[i].maze = maze;
+		tasks[i].start = start;
+		tasks[i].maxSteps = simulation->maxSteps;
+		tasks[i].first = simulation->walkers * i / threads;
+		tasks[i].end = simulation->walkers * (i + 1) / threads;
+		tasks[i].steps = steps;
+		splitRng(&tasks[i].rng, &base, i);
+	}
+
+	/*The calling thread walks task 0, and any task whose thread couldn't start */
+	began = nowNs();
+	for(i = 1; i < threads; i++) {
+		started[i] = pthread_create(workers + i, NULL, walkTask, tasks + i) == 0;
+	}
+	walkTask(tasks);
+	for(i = 1; i < threads; i++) {
+		if(started[i]) {
+			pthread_join(workers[i], NULL);
+		} else {
+			walkTask(tasks + i);
+		}
+	}
+	seconds = (nowNs() - began) / 1e9;
+	for(i = 0; i < threads; i++) {
+		totalSteps += tasks[i].totalSteps;
+	}
+
+	qsort(steps, simulation->walkers, sizeof(uint32_t), compareSteps);
+	printWalks(steps, simulation, totalSteps, seconds);
+
+	free(steps);
+	free(tasks);
+	free(workers);
+	free(started);
+	return 0;
+}
@@ -0,0 +1,26 @@
+/* Filename: chenhowa.simulate.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Grades a maze by letting many random walkers loose from its
+ * 	START_ROOM and measuring how many steps each takes to hit the END_ROOM.
+ */
+
+#ifndef CHENHOWA_SIMULATE_H
+#define CHENHOWA_SIMULATE_H
+
+#include <stdint.h>
+
+#include "chenhowa.maze.h"
+
+/*What to simulate */
+struct Simulation {
+	uint64_t walkers; /*number of independent walkers */
+	uint32_t maxSteps; /*steps after which a walker gives up */
+	int threads; /*threads that share the walkers */
+	uint64_t seed; /*seed of the random streams; the same seed and threads give the same walks */
+	uint32_t optimal; /*steps on a shortest route, to compare against, or NO_PATH (see chenhowa.graph.h) */
+};
+
+int runSimulation(const struct Maze* maze, const struct Simulation* simulation);
+
+#endif
@@ -0,0 +1,208 @@
+/* Filename: chenhowa.stats.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Per-thread counters and latency histograms for chenhowa.adventure,
+ * 	and the thread that prints a snapshot of them on SIGUSR1. Only built with
+ * 	-DCHENHOWA_STATS (see chenhowa.stats.h).
+ *
+ * 	Each thread owns a ThreadStats block, found through a thread-local pointer,
+ * 	and is the only writer of it. Writes are relaxed atomic stores, which are
+ * 	plain moves on the machines we run on, so a snapshot taken by another thread
+ * 	may be a few events behind but never reads a torn counter. Blocks are kept
+ * 	after their thread exits, so a dump still counts the loader's workers.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "chenhowa.stats.h"
+
+#ifdef CHENHOWA_STATS
+
+#define STATS_BUCKETS 48 /*histogram buckets; bucket b holds times below 2^b ns */
+
+/*Count, total and histogram of one phase in one thread */
+struct StatCounter {
+	uint64_t count;
+	uint64_t totalNs;
+	uint64_t maxNs;
+	uint64_t buckets[STATS_BUCKETS];
+};
+
+/*Everything one thread has recorded */
+struct ThreadStats {
+	struct StatCounter phases[NUM_STATS];
+	int id; /*order the thread first recorded in */
+	struct ThreadStats* next; /*next block in the list of every block */
+};
+
+static const char* phaseNames[NUM_STATS] = { "discover", "read", "parse", "move", "time",
+	"lock wait", "lock hold" };
+
+static pthread_mutex_t blocksLock = PTHREAD_MUTEX_INITIALIZER; /*guards blocks and numBlocks */
+static struct ThreadStats* blocks; /*every thread's block, newest first */
+static int numBlocks;
+static __thread struct ThreadStats* ownBlock; /*the calling thread's block, or NULL */
+
+/*Sets a counter that only the calling thread writes, so other threads may read it */
+static inline void setCounter(uint64_t* counter, uint64_t value) {
+	__atomic_store_n(counter, value, __ATOMIC_RELAXED);
+}
+
+/*Returns the calling thread's block, creating it on first use, or NULL if memory ran out */
+static struct ThreadStats* threadBlock(void) {
+	if(ownBlock == NULL) {
+		ownBlock = calloc(1, sizeof(struct ThreadStats));
+		if(ownBlock != NULL) {
+			pthread_mutex_lock(&blocksLock);
+			ownBlock->id = numBlocks;
+			ownBlock->next = blocks;
+			blocks = ownBlock;
+			numBlocks++;
+			pthread_mutex_unlock(&blocksLock);
+		}
+	}
+	return ownBlock;
+}
+
+/* Records one timed event of a phase in the calling thread's counters
+ * args: [1] phase, the StatPhase the event belongs to
+ * 	[2] ns, how long it took
+ * ret: none
+ */
+void statsRecord(int phase, uint64_t ns) {
+	struct ThreadStats* block = threadBlock();
+	struct StatCounter* counter;
+	int bucket = 0;
+
+	if(block == NULL) {
+		return;
+	}
+	counter = &block->phases[phase];
+	if(ns > 0) {
+		bucket = 64 - __builtin_clzll(ns);
+		if(bucket >= STATS_BUCKETS) {
+			bucket = STATS_BUCKETS - 1;
+		}
+	}
+	setCounter(&counter->count, counter->count + 1);
+	setCounter(&counter->totalNs, counter->totalNs + ns);
+	setCounter(&counter->buckets[bucket], counter->buckets[bucket] + 1);
+	if(ns > counter->maxNs) {
+		setCounter(&counter->maxNs, ns);
+	}
+}
+
+/*Returns a counter that another thread may be writing */
+static inline uint64_t readCounter(const uint64_t* counter) {
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/*Returns the upper bound of the histogram bucket that holds the given fraction of a counter's events */
+static uint64_t bucketPercentile(const struct StatCounter* counter, double fraction) {
+	uint64_t wanted = counter->count * fraction;
+	uint64_t seen = 0;
+	int bucket;
+
+	for(bucket = 0; bucket < STATS_BUCKETS - 1; bucket++) {
+		seen += counter->buckets[bucket];
+		if(seen > wanted) {
+			break;
+		}
+	}
+	return (uint64_t)1 << bucket;
+}
+
+/* Prints the counters of every thread, added up per phase, then each thread's event counts
+ * args: [1] file, where to print
+ * post: percentiles are the upper bound of their power-of-two histogram bucket
+ * ret: none
+ */
+void printStats(FILE* file) {
+	struct StatCounter totals[NUM_STATS] = { { 0 } };
+	struct ThreadStats* block;
+	uint64_t value;
+	int phase;
+	int bucket;
+
+	pthread_mutex_lock(&blocksLock);
+	for(block = blocks; block != NULL; block = block->next) {
+		for(phase = 0; phase < NUM_STATS; phase++) {
+			totals[phase].count += readCounter(&block->phases[phase].count);
+			totals[phase].totalNs += readCounter(&block->phases[phase].totalNs);
+			value = readCounter(&block->phases[phase].maxNs);
+			if(value > totals[phase].maxNs) {
+				totals[phase].maxNs = value;
+			}
+			for(bucket = 0; bucket < STATS_BUCKETS; bucket++) {
+				totals[phase].buckets[bucket] += readCounter(&block->phases[phase].buckets[bucket]);
+			}
+		}
+	}
+
+	fprintf(file, "stats: %i threads\n", numBlocks);
+	fprintf(file, "%-10s %10s %12s %10s %10s %10s %12s\n", "phase", "count", "mean ns",
+		"p50 ns <", "p90 ns <", "p99 ns <", "max ns");
+	for(phase = 0; phase < NUM_STATS; phase++) {
+		if(totals[phase].count == 0) {
+			continue;
+		}
+		fprintf(file, "%-10s %10llu %12.1f %10llu %10llu %10llu %12llu\n", phaseNames[phase],
+			(unsigned long long)totals[phase].count,
+			(double)totals[phase].totalNs / totals[phase].count,
+			(unsigned long long)bucketPercentile(&totals[phase], 0.5),
+			(unsigned long long)bucketPercentile(&totals[phase], 0.9),
+			(unsigned long long)bucketPercentile(&totals[phase], 0.99),
+			(unsigned long long)totals[phase].maxNs);
+	}
+
+	/*Which thread did the work */
+	for(block = blocks; block != NULL; block = block->next) {
+		fprintf(file, "thread %i:", block->id);
+		for(phase = 0; phase < NUM_STATS; phase++) {
+			value = readCounter(&block->phases[phase].count);
+			if(value > 0) {
+				fprintf(file, " %s %llu", phaseNames[phase], (unsigned long long)value);
+			}
+		}
+		fprintf(file, "\n");
+	}
+	pthread_mutex_unlock(&blocksLock);
+	fflush(file);
+}
+
+/*Body of the stats thread: prints a snapshot to stderr every time SIGUSR1 arrives */
+static void* snapshotThread(void* arg) {
+	sigset_t* signals = arg;
+	int signal;
+
+	while(sigwait(signals, &signal) == 0) {
+		printStats(stderr);
+	}
+	return NULL;
+}
+
+/* Starts the thread that prints a snapshot of the stats on SIGUSR1
+ * pre: no other thread has been started yet, since every thread must inherit
+ * 	the blocked SIGUSR1
+ * post: SIGUSR1 is blocked in the calling thread, and only the stats thread
+ * 	takes it. The thread runs until the process exits
+ * ret: 0 on success, 1 if the thread could not be started
+ */
+int startStatsThread(void) {
+	static sigset_t signals;
+	pthread_t thread;
+
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+	if(pthread_create(&thread, NULL, snapshotThread, &signals) != 0) {
+		return 1;
+	}
+	pthread_detach(thread);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/* Filename: chenhowa.stats.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Optional timing instrumentation for chenhowa.adventure. Every
+ * 	thread counts and times its own phases in a private block, so recording
+ * 	never takes a lock; a snapshot adds the blocks up. Build with
+ * 	-DCHENHOWA_STATS (make stats) to turn it on. Without it every STATS_ macro
+ * 	and stats function compiles to nothing.
+ */
+
+#ifndef CHENHOWA_STATS_H
+#define CHENHOWA_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*Phases of chenhowa.adventure that are timed */
+enum StatPhase {
+	STAT_DISCOVER, /*finding the newest rooms directory */
+	STAT_READ, /*opening and reading one room file */
+	STAT_PARSE, /*parsing one room file */
+	STAT_MOVE, /*looking up and checking one move command */
+	STAT_TIME, /*answering one time command, from request to answer */
+	STAT_LOCK_WAIT, /*waiting to take the time service's lock */
+	STAT_LOCK_HOLD, /*holding the time service's lock */
+	NUM_STATS
+};
+
+#ifdef CHENHOWA_STATS
+
+#include <time.h>
+
+#define STATS_ENABLED 1
+
+/*Declares a timer. Must be the last declaration of its block */
+#define STATS_TIMER(name) uint64_t name
+/*Starts, or restarts, a timer */
+#define STATS_START(name) ((name) = statsClock())
+/*Records the time since a timer started against a phase */
+#define STATS_STOP(phase, name) statsRecord((phase), statsClock() - (name))
+
+/*Returns the monotonic clock in ns. clock_gettime runs in the vDSO, without a
+ * system call, so it is cheap enough to call around every move */
+static inline uint64_t statsClock(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void statsRecord(int phase, uint64_t ns);
+void printStats(FILE* file);
+int startStatsThread(void);
+
+#else
+
+#define STATS_ENABLED 0
+#define STATS_TIMER(name)
+#define STATS_START(name)
+#define STATS_STOP(phase, name)
+#define printStats(file)
+#define startStatsThread() 0
+
+#endif
+
+#endif
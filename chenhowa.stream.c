@@ -0,0 +1,744 @@
+/* Filename: chenhowa.stream.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Streaming generator for mazes that don't fit in memory.
+ *
+ * 	The rooms are split into contiguous shards small enough for a RoomGraph
+ * 	within half of the memory budget, and the shards are built one after the
+ * 	other by connectStreamShard. Each shard is connected inside, and is linked
+ * 	to the shards 1, 2, 4, 8, ... places ahead of and behind it (wrapping
+ * 	around), so the whole maze is connected and any two shards are a few hops
+ * 	apart. Each of those pairs of shards gets the same number of links: up to
+ * 	one for every CROSS_LINK_RATIO rooms, as in the parallel generator, as far
+ * 	as a sixteenth of the budget can remember the rooms waiting for them. The
+ * 	links use rooms that each shard keeps a placeholder slot on, and are made
+ * 	when the later of their two shards is built.
+ *
+ * 	Every link a shard makes goes into a buffer of (room, neighbour) pairs the
+ * 	size of the other half of the budget. A full buffer is sorted and spilled
+ * 	to a temporary file as a run. Once every shard is built, the runs are
+ * 	merged, and the merged pairs arrive in room order: exactly the order of
+ * 	the arrays of a maze file, so each array is written front to back through
+ * 	its own small buffer. Degree bounds and repeated links are checked on the
+ * 	way; connectivity holds by construction.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+
+#include "chenhowa.stream.h"
+#include "chenhowa.maze.h"
+#include "chenhowa.roomgraph.h"
+#include "chenhowa.generator.h"
+
+#define MAX_SHARD_LINKS 64 /*most shards linked to one shard: two per power of two below the shard count */
+#define CROSS_LINK_RATIO 16 /*fewest rooms of a shard per link to another shard */
+#define MIN_RUN_BUFFER 512 /*fewest links of each run held in memory while merging */
+#define WRITE_BUFFER_LEN 65536 /*bytes buffered for each array of the maze file */
+#define GENERATED_NAME_PREFIX "ROOM_"
+#define GENERATED_NAME_LEN 16 /*room for "ROOM_" plus a 10 digit index */
+
+/*A sorted run of links spilled to the temporary file */
+struct Run {
+	uint64_t offset; /*file offset of the next link not yet read */
+	uint64_t count; /*links not yet read */
+	uint64_t* buffer; /*links read in while merging */
+	size_t position; /*next link of buffer to merge */
+	size_t length; /*links in buffer */
+};
+
+/*One array of the maze file, written front to back */
+struct ArrayWriter {
+	uint64_t offset; /*file offset the buffer will be written at */
+	size_t length; /*bytes used in buffer */
+	char buffer[WRITE_BUFFER_LEN];
+};
+
+/*The arrays of the maze file, and the room being written */
+struct MazeWriter {
+	int fd;
+	struct ArrayWriter linkStart;
+	struct ArrayWriter nameOffsets;
+	struct ArrayWriter nameOrder;
+	struct ArrayWriter types;
+	struct ArrayWriter degrees;
+	struct ArrayWriter names;
+	struct ArrayWriter links;
+	uint32_t room; /*room whose links are being merged */
+	uint32_t degree; /*links of room so far */
+	uint64_t link; /*links written */
+	uint64_t nameOffset; /*bytes of names written */
+	uint64_t lastLink; /*the previous link, to catch a repeat */
+	uint64_t badDegrees; /*rooms with too few or too many links */
+	uint64_t badLinks; /*links that repeat or lead back to their own room */
+};
+
+/*State of a streamed generation between shards */
+struct Stream {
+	uint32_t numRooms;
+	int minDegree;
+	int maxDegree;
+	uint32_t startRoom;
+	uint32_t endRoom;
+	uint32_t numShards;
+	int numNeighbours; /*shards linked to each shard */
+	uint32_t width; /*links between each pair of linked shards */
+	uint32_t* ports; /*ports[(shard * numNeighbours + i) * width + k] is the room of a built
+				shard that takes its k-th link to its i-th neighbour */
+	uint64_t* links; /*links not yet spilled, each (room << 32 | neighbour) */
+	size_t capacity; /*links that fit in links */
+	size_t used; /*links in links */
+	uint64_t numLinks; /*links made so far */
+	int spill; /*the temporary file runs are written to */
+	uint64_t spillSize; /*bytes written to spill */
+	struct Run* runs;
+	int numRuns;
+	int runCapacity;
+};
+
+/*Writes all of a block of memory to a file at an offset. Returns 0 on success, 1 on error */
+static int writeAt(int fd, const void* data, size_t size, uint64_t offset) {
+	const char* next = data;
+	ssize_t result;
+
+	while(size > 0) {
+		result = pwrite(fd, next, size, offset);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result <= 0) {
+			return 1;
+		}
+		next += result;
+		size -= result;
+		offset += result;
+	}
+	return 0;
+}
+
+/*Reads a block of a file at an offset. Returns 0 on success, 1 on error or end of file */
+static int readAt(int fd, void* data, size_t size, uint64_t offset) {
+	char* next = data;
+	ssize_t result;
+
+	while(size > 0) {
+		result = pread(fd, next, size, offset);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result <= 0) {
+			return 1;
+		}
+		next += result;
+		size -= result;
+		offset += result;
+	}
+	return 0;
+}
+
+/*Sorts links in place. This is a quicksort around the median of three that
+ * loops on the larger side, so the stack stays shallow; qsort may allocate a
+ * copy of the array, which the budget has no room for */
+static void sortLinks(uint64_t* links, size_t count) {
+	uint64_t pivot;
+	uint64_t swap;
+	size_t mid;
+	size_t i, j;
+
+	while(count > 16) {
+		/*Order the first, middle and last links, and split around the middle one */
+		mid = count / 2;
+		if(links[mid] < links[0]) {
+			swap = links[mid]; links[mid] = links[0]; links[0] = swap;
+		}
+		if(links[count - 1] < links[mid]) {
+			swap = links[mid]; links[mid] = links[count - 1]; links[count - 1] = swap;
+			if(links[mid] < links[0]) {
+				swap = links[mid]; links[mid] = links[0]; links[0] = swap;
+			}
+		}
+		pivot = links[mid];
+
+		/*Hoare partition: afterwards links[0..j] <= pivot <= links[j + 1..] */
+		i = 0;
+		j = count - 1;
+		while(1) {
+			while(links[i] < pivot) {
+				i++;
+			}
+			while(links[j] > pivot) {
+				j--;
+			}
+			if(i >= j) {
+				break;
+			}
+			swap = links[i]; links[i] = links[j]; links[j] = swap;
+			i++;
+			j--;
+		}
+
+		if(j + 1 < count - j - 1) {
+			sortLinks(links, j + 1);
+			links += j + 1;
+			count -= j + 1;
+		} else {
+			sortLinks(links + j + 1, count - j - 1);
+			count = j + 1;
+		}
+	}
+
+	for(i = 1; i < count; i++) {
+		swap = links[i];
+		for(j = i; j > 0 && links[j - 1] > swap; j--) {
+			links[j] = links[j - 1];
+		}
+		links[j] = swap;
+	}
+}
+
+/*Sorts the buffered links and appends them to the spill file as a new run.
+ * Returns 0 on success, 1 on error (a message is printed) */
+static int spillLinks(struct Stream* stream) {
+	struct Run* grown;
+	size_t size = stream->used * sizeof(uint64_t);
+
+	if(stream->used == 0) {
+		return 0;
+	}
+	if(stream->numRuns == stream->runCapacity) {
+		grown = realloc(stream->runs, 2 * stream->runCapacity * sizeof(struct Run));
+		if(grown == NULL) {
+			fprintf(stderr, "Error. Could not allocate run %i\n", stream->numRuns);
+			return 1;
+		}
+		stream->runs = grown;
+		stream->runCapacity *= 2;
+	}
+
+	sortLinks(stream->links, stream->used);
+	if(writeAt(stream->spill, stream->links, size, stream->spillSize) != 0) {
+		fprintf(stderr, "Error. Could not spill links: %s\n", strerror(errno));
+		return 1;
+	}
+	stream->runs[stream->numRuns].offset = stream->spillSize;
+	stream->runs[stream->numRuns].count = stream->used;
+	stream->numRuns++;
+	stream->spillSize += size;
+	stream->used = 0;
+	return 0;
+}
+
+/*Adds a one-way link from room to neighbour, spilling the buffer first if it is full.
+ * Returns 0 on success, 1 on error */
+static int addLink(struct Stream* stream, uint32_t room, uint32_t neighbour) {
+	if(stream->used == stream->capacity && spillLinks(stream) != 0) {
+		return 1;
+	}
+	stream->links[stream->used] = (uint64_t)room << 32 | neighbour;
+	stream->used++;
+	stream->numLinks++;
+	return 0;
+}
+
+/* Lists the shards a shard is linked to
+ * args: [1] shard, the shard
+ * 	[2] numShards, the number of shards
+ * 	[3] neighbours, filled with the linked shards; MAX_SHARD_LINKS entries
+ * post: the shards 1, 2, 4, ... places ahead and behind, wrapping around, each
+ * 	once. Shard a is a neighbour of b exactly when b is a neighbour of a
+ * ret: the number of neighbours
+ */
+static int listNeighbours(uint32_t shard, uint32_t numShards, uint32_t* neighbours) {
+	uint64_t offset;
+	uint32_t candidates[2];
+	int count = 0;
+	int i, j;
+
+	for(offset = 1; offset < numShards; offset *= 2) {
+		candidates[0] = (shard + offset) % numShards;
+		candidates[1] = (shard + numShards - offset) % numShards;
+		for(i = 0; i < 2; i++) {
+			for(j = 0; j < count && neighbours[j] != candidates[i]; j++);
+			if(j == count) {
+				neighbours[count] = candidates[i];
+				count++;
+			}
+		}
+	}
+	return count;
+}
+
+/* Builds one shard, and hands its links to the stream
+ * args: [1] stream, the stream, with every earlier shard built
+ * 	[2] shard, the shard to build
+ * 	[3] rng, the shard's own random stream
+ * post: the links inside the shard, and the links to every earlier neighbour
+ * 	shard, are added both ways. The rooms that will link to later neighbours
+ * 	are kept in stream->ports. A room holds at most one placeholder, so no two
+ * 	links between shards can join the same rooms
+ * ret: 0 on success, 1 on error
+ */
+static int buildShard(struct Stream* stream, uint32_t shard, struct Rng* rng) {
+	struct RoomGraph graph;
+	uint32_t neighbours[MAX_SHARD_LINKS];
+	uint32_t theirs[MAX_SHARD_LINKS];
+	uint32_t first = (uint64_t)stream->numRooms * shard / stream->numShards;
+	uint32_t count = (uint64_t)stream->numRooms * (shard + 1) / stream->numShards - first;
+	const uint32_t* links;
+	uint32_t ports = stream->numNeighbours * stream->width;
+	uint32_t other;
+	uint32_t partner;
+	uint32_t room;
+	uint32_t port;
+	int result = 0;
+	int i, j;
+
+	listNeighbours(shard, stream->numShards, neighbours);
+	if(initRoomGraph(&graph, count + ports, stream->minDegree, stream->maxDegree) != 0
+			|| connectStreamShard(&graph, ports, rng) != 0) {
+		fprintf(stderr, "Error. Could not allocate a shard of %u rooms\n", count);
+		freeRoomGraph(&graph);
+		return 1;
+	}
+
+	for(room = 0; result == 0 && room < count; room++) {
+		links = roomLinks(&graph, room);
+		for(i = 0; result == 0 && i < graph.degrees[room]; i++) {
+			if(links[i] < count) {
+				result = addLink(stream, first + room, first + links[i]);
+				continue;
+			}
+
+			/*A placeholder: link to the room the other shard kept for this link */
+			port = links[i] - count;
+			other = neighbours[port / stream->width];
+			if(other > shard) {
+				stream->ports[(size_t)shard * ports + port] = first + room;
+				continue;
+			}
+			listNeighbours(other, stream->numShards, theirs);
+			for(j = 0; theirs[j] != shard; j++);
+			partner = stream->ports[(size_t)other * ports + (size_t)j * stream->width + port % stream->width];
+			result = addLink(stream, first + room, partner);
+			result |= addLink(stream, partner, first + room);
+		}
+	}
+
+	freeRoomGraph(&graph);
+	return result;
+}
+
+/*Appends bytes to one array of the maze file. Returns 0 on success, 1 on a write error */
+static int appendArray(int fd, struct ArrayWriter* array, const void* data, size_t size) {
+	if(array->length + size > sizeof(array->buffer)) {
+		if(writeAt(fd, array->buffer, array->length, array->offset) != 0) {
+			return 1;
+		}
+		array->offset += array->length;
+		array->length = 0;
+	}
+	memcpy(array->buffer + array->length, data, size);
+	array->length += size;
+	return 0;
+}
+
+/*Writes what is left in the buffer of one array. Returns 0 on success, 1 on a write error */
+static int flushArray(int fd, struct ArrayWriter* array) {
+	int result = writeAt(fd, array->buffer, array->length, array->offset);
+
+	array->offset += array->length;
+	array->length = 0;
+	return result;
+}
+
+/* Writes every array entry of the room whose links have all been merged, and
+ * 	moves on to the next room
+ * args: [1] stream, the stream, for the degree bounds and room types
+ * 	[2] writer, the maze file being written
+ * post: a room with too few or too many links is counted in writer->badDegrees
+ * ret: 0 on success, 1 on a write error
+ */
+static int finishRoom(const struct Stream* stream, struct MazeWriter* writer) {
+	char name[GENERATED_NAME_LEN];
+	uint64_t start = writer->link - writer->degree;
+	uint8_t type = MID_ROOM;
+	uint8_t degree = writer->degree > UINT8_MAX ? UINT8_MAX : writer->degree;
+	int length;
+	int result;
+
+	if(writer->room == stream->startRoom) {
+		type = START_ROOM;
+	} else if(writer->room == stream->endRoom) {
+		type = END_ROOM;
+	}
+	if(writer->degree < (uint32_t)stream->minDegree || writer->degree > (uint32_t)stream->maxDegree) {
+		writer->badDegrees++;
+	}
+	length = sprintf(name, GENERATED_NAME_PREFIX "%u", writer->room + 1) + 1;
+
+	result = appendArray(writer->fd, &writer->linkStart, &start, sizeof(start));
+	result |= appendArray(writer->fd, &writer->nameOffsets, &writer->nameOffset, sizeof(writer->nameOffset));
+	result |= appendArray(writer->fd, &writer->types, &type, sizeof(type));
+	result |= appendArray(writer->fd, &writer->degrees, &degree, sizeof(degree));
+	result |= appendArray(writer->fd, &writer->names, name, length);
+	writer->nameOffset += length;
+	writer->room++;
+	writer->degree = 0;
+	return result;
+}
+
+/*Writes one merged link, first finishing every room before the one it leaves.
+ * Returns 0 on success, 1 on a write error */
+static int writeLink(const struct Stream* stream, struct MazeWriter* writer, uint64_t link) {
+	uint32_t room = link >> 32;
+	uint32_t neighbour = (uint32_t)link;
+	int result = 0;
+
+	while(result == 0 && writer->room < room) {
+		result = finishRoom(stream, writer);
+	}
+	if(neighbour == room || (writer->degree > 0 && link == writer->lastLink)) {
+		writer->badLinks++;
+	}
+	writer->lastLink = link;
+	writer->degree++;
+	writer->link++;
+	return result | appendArray(writer->fd, &writer->links, &neighbour, sizeof(neighbour));
+}
+
+/*Returns the next link of a run being merged */
+static uint64_t runHead(const struct Run* run) {
+	return run->buffer[run->position];
+}
+
+/*Reads the next block of a run into its buffer. Returns 0 on success, 1 on a read error */
+static int refillRun(int fd, struct Run* run, size_t block) {
+	size_t count = run->count < block ? run->count : block;
+
+	if(readAt(fd, run->buffer, count * sizeof(uint64_t), run->offset) != 0) {
+		return 1;
+	}
+	run->offset += count * sizeof(uint64_t);
+	run->count -= count;
+	run->position = 0;
+	run->length = count;
+	return 0;
+}
+
+/*Moves the run at heap[at] down the min-heap of runs until its head is in order */
+static void siftRun(struct Run** heap, int size, int at) {
+	struct Run* run = heap[at];
+	int child;
+
+	while((child = 2 * at + 1) < size) {
+		if(child + 1 < size && runHead(heap[child + 1]) < runHead(heap[child])) {
+			child++;
+		}
+		if(runHead(run) <= runHead(heap[child])) {
+			break;
+		}
+		heap[at] = heap[child];
+		at = child;
+	}
+	heap[at] = run;
+}
+
+/* Merges the spilled runs into the arrays of a maze file
+ * args: [1] stream, the stream, with every shard built and every link spilled
+ * 	[2] writer, the maze file, with each array's offset set
+ * post: every room has been written. The link buffer is reused for the runs'
+ * 	blocks, so each run is read MIN_RUN_BUFFER or more links at a time
+ * ret: 0 on success, 1 on error (a message is printed)
+ */
+static int mergeRuns(struct Stream* stream, struct MazeWriter* writer) {
+	struct Run** heap;
+	struct Run* top;
+	size_t block = stream->numRuns > 0 ? stream->capacity / stream->numRuns : 0;
+	int size = 0;
+	int result = 0;
+	int i;
+
+	if(stream->numRuns > 0 && block < MIN_RUN_BUFFER) {
+		fprintf(stderr, "Error. %i runs are too many to merge in this much memory; raise the budget\n",
+			stream->numRuns);
+		return 1;
+	}
+	heap = malloc((stream->numRuns + 1) * sizeof(struct Run*));
+	if(heap == NULL) {
+		fprintf(stderr, "Error. Could not allocate the merge of %i runs\n", stream->numRuns);
+		return 1;
+	}
+	for(i = 0; i < stream->numRuns; i++) {
+		stream->runs[i].buffer = stream->links + (size_t)i * block;
+		result |= refillRun(stream->spill, stream->runs + i, block);
+		heap[size] = stream->runs + i;
+		size++;
+	}
+	for(i = size / 2; i-- > 0;) {
+		siftRun(heap, size, i);
+	}
+
+	while(result == 0 && size > 0) {
+		top = heap[0];
+		result = writeLink(stream, writer, runHead(top));
+		top->position++;
+		if(top->position == top->length) {
+			if(top->count > 0) {
+				result |= refillRun(stream->spill, top, block);
+			} else {
+				size--;
+				heap[0] = heap[size];
+			}
+		}
+		if(size > 0) {
+			siftRun(heap, size, 0);
+		}
+	}
+	while(result == 0 && writer->room < stream->numRooms) {
+		result = finishRoom(stream, writer);
+	}
+	free(heap);
+
+	if(result != 0) {
+		fprintf(stderr, "Error. Could not merge the spilled links: %s\n", strerror(errno));
+	}
+	return result;
+}
+
+/*Returns the bytes taken by the names ROOM_1 to ROOM_<numRooms>, with their terminators */
+static uint64_t generatedNamesSize(uint32_t numRooms) {
+	uint64_t size = 0;
+	uint64_t low;
+	uint64_t high;
+	int digits = 1;
+
+	for(low = 1; low <= numRooms; low *= 10) {
+		high = low * 10 - 1 < numRooms ? low * 10 - 1 : numRooms;
+		size += (high - low + 1) * (strlen(GENERATED_NAME_PREFIX) + digits + 1);
+		digits++;
+	}
+	return size;
+}
+
+/* Writes the name index of a maze whose rooms are named ROOM_1 to ROOM_<numRooms>.
+ * 	Their strcmp order is the dictionary order of the numbers, which is walked
+ * 	like a tree: 1, 10, 100, ..., 101, ..., 11, ..., so no name is generated
+ * args: [1] fd, the maze file
+ * 	[2] array, the writer of its nameOrder
+ * 	[3] numRooms, the number of rooms
+ * ret: 0 on success, 1 on a write error
+ */
+static int writeGeneratedNameOrder(int fd, struct ArrayWriter* array, uint32_t numRooms) {
+	uint64_t number = 1;
+	uint32_t room;
+	uint32_t i;
+	int result = 0;
+
+	for(i = 0; i < numRooms && result == 0; i++) {
+		room = (uint32_t)(number - 1);
+		result = appendArray(fd, array, &room, sizeof(room));
+
+		/*Go down to the number's first child if there is one, else on to the
+		 * next sibling, going up past every number that has none */
+		if(number * 10 <= numRooms) {
+			number *= 10;
+		} else {
+			while(number % 10 == 9 || number + 1 > numRooms) {
+				number /= 10;
+			}
+			number++;
+		}
+	}
+	return result;
+}
+
+/* Writes the merged maze to its file, header last, so a file cut short is never
+ * 	taken for a maze
+ * args: [1] stream, the stream, with every shard built and every link spilled
+ * 	[2] path, the maze file to create
+ * ret: 0 on success, 1 on error (a message is printed, and the file is removed)
+ */
+static int writeStreamedMaze(struct Stream* stream, const char* path) {
+	struct MazeHeader header;
+	struct MazeWriter* writer;
+	int result;
+
+	layoutMaze(&header, stream->numRooms, stream->numLinks, generatedNamesSize(stream->numRooms));
+	writer = calloc(1, sizeof(struct MazeWriter));
+	if(writer == NULL) {
+		return 1;
+	}
+	writer->linkStart.offset = header.linkStartOffset;
+	writer->nameOffsets.offset = header.nameOffsetsOffset;
+	writer->nameOrder.offset = header.nameOrderOffset;
+	writer->types.offset = header.typesOffset;
+	writer->degrees.offset = header.degreesOffset;
+	writer->names.offset = header.namesOffset;
+	writer->links.offset = header.linksOffset;
+
+	writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(writer->fd < 0) {
+		fprintf(stderr, "Could not open %s: %s\n", path, strerror(errno));
+		free(writer);
+		return 1;
+	}
+
+	/*Sizing the file first leaves the gaps between arrays zeroed */
+	if(ftruncate(writer->fd, header.fileSize) != 0) {
+		fprintf(stderr, "Could not write %s: %s\n", path, strerror(errno));
+		result = 1;
+	} else {
+		result = mergeRuns(stream, writer);
+	}
+	if(result == 0 && writeGeneratedNameOrder(writer->fd, &writer->nameOrder, stream->numRooms) != 0) {
+		fprintf(stderr, "Could not write %s: %s\n", path, strerror(errno));
+		result = 1;
+	}
+	if(result == 0 && (flushArray(writer->fd, &writer->linkStart) != 0
+			|| flushArray(writer->fd, &writer->nameOffsets) != 0
+			|| flushArray(writer->fd, &writer->nameOrder) != 0
+			|| flushArray(writer->fd, &writer->types) != 0
+			|| flushArray(writer->fd, &writer->degrees) != 0
+			|| flushArray(writer->fd, &writer->names) != 0
+			|| flushArray(writer->fd, &writer->links) != 0)) {
+		fprintf(stderr, "Could not write %s: %s\n", path, strerror(errno));
+		result = 1;
+	}
+	if(result == 0 && (writer->badDegrees > 0 || writer->badLinks > 0)) {
+		fprintf(stderr, "Generated maze is invalid: %llu rooms with a bad degree, %llu repeated links\n",
+			(unsigned long long)writer->badDegrees, (unsigned long long)writer->badLinks);
+		result = 1;
+	} else if(result == 0 && writeAt(writer->fd, &header, sizeof(header), 0) != 0) {
+		fprintf(stderr, "Could not write %s: %s\n", path, strerror(errno));
+		result = 1;
+	}
+	if(close(writer->fd) != 0 && result == 0) {
+		fprintf(stderr, "Could not write %s: %s\n", path, strerror(errno));
+		result = 1;
+	}
+
+	if(result != 0) {
+		unlink(path);
+	}
+	free(writer);
+	return result;
+}
+
+/* Generates a random maze and writes it to a binary maze file, in bounded memory
+ * args: [1] path, the maze file to create. The runs are spilled to a temporary
+ * 	file next to it, which is removed as soon as it is opened
+ * 	[2] numRooms, the number of rooms
+ * 	[3] minDegree, [4] maxDegree, the degree bounds, which pass checkDegreeBounds
+ * 	[5] memory, the memory budget in bytes; at least MIN_STREAM_MEMORY
+ * 	[6] rng, the seeded random stream. It picks the START_ROOM and END_ROOM,
+ * 	and shard i connects its rooms with its own stream, split from it as by splitRng.
+ * 	Left unchanged otherwise
+ * 	[7] report, 1 to print the shards, runs and peak memory used to stdout
+ * pre: if numRooms needs more than one shard, maxDegree >= 3
+ * post: rooms are named ROOM_1 to ROOM_<numRooms>, every room has minDegree to
+ * 	maxDegree two-way connections, and every room can be reached from every
+ * 	other. The result depends only on the stream, the size and bounds, and memory
+ * ret: 0 on success, 1 on error (a message is printed, and no file is left behind)
+ */
+int streamMaze(const char* path, uint32_t numRooms, int minDegree, int maxDegree, size_t memory,
+		struct Rng* rng, int report) {
+	struct Stream stream;
+	struct Rng shardRng;
+	struct Rng nextRng;
+	struct rusage usage;
+	uint32_t neighbours[MAX_SHARD_LINKS];
+	char spillName[1024];
+	size_t roomBytes = sizeof(char*) + 2 + maxDegree * sizeof(uint32_t) + 2 * sizeof(int);
+	uint64_t shardRooms = memory / 2 / roomBytes * CROSS_LINK_RATIO / (CROSS_LINK_RATIO + 1);
+	uint64_t portSlots;
+	uint32_t shard;
+	int result = 0;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.numRooms = numRooms;
+	stream.minDegree = minDegree;
+	stream.maxDegree = maxDegree;
+	stream.numShards = shardRooms >= numRooms ? 1 : (numRooms + shardRooms - 1) / shardRooms;
+	stream.numNeighbours = listNeighbours(0, stream.numShards, neighbours); /*every shard has as many */
+	if(stream.numShards > 1 && maxDegree < 3) {
+		fprintf(stderr, "Error. A maze of more than one shard needs a max degree of at least 3\n");
+		return 1;
+	}
+
+	/*Half the budget holds the shard being built, with its placeholders. A
+ * 	sixteenth holds ports, and the rest links */
+	stream.width = 1;
+	if(stream.numNeighbours > 0) {
+		portSlots = (uint64_t)stream.numShards * stream.numNeighbours;
+		stream.width = numRooms / stream.numShards / CROSS_LINK_RATIO / stream.numNeighbours;
+		if(stream.width > memory / 16 / sizeof(uint32_t) / portSlots) {
+			stream.width = memory / 16 / sizeof(uint32_t) / portSlots;
+		}
+		if(stream.width < 1) {
+			stream.width = 1;
+		}
+	}
+	stream.capacity = (memory / 2 - memory / 16) / sizeof(uint64_t);
+	stream.links = malloc(stream.capacity * sizeof(uint64_t));
+	stream.ports = malloc(((size_t)stream.numShards * stream.numNeighbours * stream.width + 1) * sizeof(uint32_t));
+	stream.runCapacity = 16;
+	stream.runs = malloc(stream.runCapacity * sizeof(struct Run));
+	if(stream.links == NULL || stream.ports == NULL || stream.runs == NULL) {
+		fprintf(stderr, "Error. Could not allocate %llu bytes to stream the maze\n", (unsigned long long)memory);
+		free(stream.links);
+		free(stream.ports);
+		free(stream.runs);
+		return 1;
+	}
+
+	snprintf(spillName, sizeof(spillName), "%s.runs", path);
+	stream.spill = open(spillName, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if(stream.spill < 0) {
+		fprintf(stderr, "Could not open %s: %s\n", spillName, strerror(errno));
+		result = 1;
+	} else {
+		unlink(spillName);
+	}
+
+	/*Pick the START_ROOM and END_ROOM as assignRandomTypes does */
+	stream.startRoom = rngBounded(rng, numRooms);
+	do {
+		stream.endRoom = rngBounded(rng, numRooms);
+	} while(stream.endRoom == stream.startRoom);
+
+	/*Jumping once per shard gives shard i the stream splitRng would give it,
+ * 	without jumping i + 1 times for each shard */
+	nextRng = *rng;
+	for(shard = 0; result == 0 && shard < stream.numShards; shard++) {
+		jumpRng(&nextRng);
+		shardRng = nextRng;
+		result = buildShard(&stream, shard, &shardRng);
+	}
+	if(result == 0) {
+		result = spillLinks(&stream);
+	}
+	if(result == 0) {
+		result = writeStreamedMaze(&stream, path);
+	}
+
+	if(result == 0 && report) {
+		getrusage(RUSAGE_SELF, &usage);
+		printf("streamed %u rooms in %u shards, %u links between linked shards: "
+			"%llu links in %i runs (%.1f MB spilled), peak RSS %.1f MB\n",
+			numRooms, stream.numShards, stream.width, (unsigned long long)stream.numLinks, stream.numRuns,
+			stream.spillSize / 1048576.0, usage.ru_maxrss / 1024.0);
+	}
+
+	if(stream.spill >= 0) {
+		close(stream.spill);
+	}
+	free(stream.links);
+	free(stream.ports);
+	free(stream.runs);
+	return result;
+}
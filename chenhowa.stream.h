@@ -0,0 +1,23 @@
+/* Filename: chenhowa.stream.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Streaming generator for chenhowa.buildrooms, for mazes with more
+ * 	rooms than fit in memory. Rooms are connected one shard at a time, their
+ * 	links are spilled to disk in sorted runs, and the runs are merged straight
+ * 	into a binary maze file, all within a fixed memory budget.
+ */
+
+#ifndef CHENHOWA_STREAM_H
+#define CHENHOWA_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chenhowa.rng.h"
+
+#define MIN_STREAM_MEMORY (16 << 20) /*smallest memory budget a streamed maze can be built in */
+
+int streamMaze(const char* path, uint32_t numRooms, int minDegree, int maxDegree, size_t memory,
+	struct Rng* rng, int report);
+
+#endif
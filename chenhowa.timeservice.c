@@ -0,0 +1,182 @@
+/* Filename: chenhowa.timeservice.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Runs the time thread for chenhowa.adventure. The thread sleeps on a
+ * 	condition variable until someone asks for the time, formats it once for every
+ * 	request that is waiting, and wakes the callers back up.
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "chenhowa.timeservice.h"
+#include "chenhowa.stats.h"
+
+/*Method of getting time is from
+ * https://stackoverflow.com/questions/1442116/how-to-get-date-and-time-value-in-c-program
+ *
+ * Description: formats the current LOCAL time in the assignment format,
+ * 	for example "12:28am, Tuesday, July 25, 2017"
+ * Args: [1] buffer, where to write the time
+ * 	[2] size, the size of buffer; TIME_TEXT_LEN is always enough
+ * ret: none
+ */
+void formatTime(char* buffer, size_t size) {
+	static const char* days[] = { "Sunday", "Monday", "Tuesday", "Wednesday",
+		"Thurday", "Friday", "Saturday" };
+	static const char* months[] = { "January", "February", "March", "April", "May",
+		"June", "July", "August", "September", "October", "November", "December" };
+	time_t t;
+	struct tm local_time;
+	int hour;
+
+	t = time(NULL);
+	localtime_r(&t, &local_time);
+
+	/*Convert hour values to correct format */
+	hour = local_time.tm_hour;
+	if(hour == 0) {
+		hour = 12;
+	} else if(hour > 12) {
+		hour -= 12;
+	}
+
+	/*Write the hour, minute, am/pm status, day of the week, month,
+ * 	day of the month, and the year */
+	snprintf(buffer, size, "%d:%02d%s, %s, %s %d, %d", hour, local_time.tm_min,
+		local_time.tm_hour >= 12 ? "pm" : "am",
+		days[local_time.tm_wday], months[local_time.tm_mon],
+		local_time.tm_mday, local_time.tm_year + 1900);
+}
+
+/* Description: body of the time thread. Waits for requests, and answers every
+ * 	request that is waiting with one freshly formatted time
+ * Args: [1] args, the TimeService to serve
+ * Post: this function executes until stopTimeService is called, after answering
+ * 	any requests still waiting. If the service was started with writeFile,
+ * 	every answer is also written to TIME_FILE_NAME
+ * ret: NULL
+ * */
+static void *writeTime(void *args) {
+	struct TimeService* service = args;
+	char text[TIME_TEXT_LEN];
+	uint64_t target;
+	FILE *file;
+	STATS_TIMER(started);
+
+	while(1) {
+		/*Sleep until somebody asks for the time, or the service is stopped */
+		pthread_mutex_lock(&service->lock);
+		while(service->answers == service->requests && !service->stopping) {
+			pthread_cond_wait(&service->requested, &service->lock);
+		}
+		if(service->answers == service->requests) {
+			pthread_mutex_unlock(&service->lock);
+			break;
+		}
+		target = service->requests;
+		pthread_mutex_unlock(&service->lock);
+
+		/*Format the time without holding the lock */
+		formatTime(text, sizeof(text));
+		if(service->writeFile) {
+			file = fopen(TIME_FILE_NAME, "w");
+			if(file != NULL) {
+				fprintf(file, "%s\n", text);
+				fclose(file);
+			}
+		}
+
+		/*Answer every request that was posted before the time was formatted */
+		STATS_START(started);
+		pthread_mutex_lock(&service->lock);
+		STATS_STOP(STAT_LOCK_WAIT, started);
+		STATS_START(started);
+		memcpy(service->text, text, sizeof(text));
+		service->answers = target;
+		pthread_cond_broadcast(&service->answered);
+		pthread_mutex_unlock(&service->lock);
+		STATS_STOP(STAT_LOCK_HOLD, started);
+	}
+
+	return NULL;
+}
+
+/* Starts the time thread
+ * args: [1] service, the TimeService to set up
+ * 	[2] writeFile, 1 if every answer should also be written to TIME_FILE_NAME
+ * ret: 0 on success, 1 if the thread could not be started
+ */
+int startTimeService(struct TimeService* service, int writeFile) {
+	memset(service->text, '\0', sizeof(service->text));
+	service->requests = 0;
+	service->answers = 0;
+	service->writeFile = writeFile;
+	service->stopping = 0;
+	pthread_mutex_init(&service->lock, NULL);
+	pthread_cond_init(&service->requested, NULL);
+	pthread_cond_init(&service->answered, NULL);
+
+	if(pthread_create(&service->thread, NULL, writeTime, service) != 0) {
+		return 1;
+	}
+	return 0;
+}
+
+/* Asks the time thread for the current time and waits for the answer
+ * args: [1] service, a started TimeService
+ * 	[2] buffer, where to copy the time
+ * 	[3] size, the size of buffer
+ * post: buffer holds a time formatted after this call was made
+ * ret: none
+ *
+ * Any number of threads may ask at once; requests that arrive together are
+ * answered by the same formatted time.
+ */
+void requestTime(struct TimeService* service, char* buffer, size_t size) {
+	uint64_t ticket;
+	STATS_TIMER(started);
+	STATS_TIMER(held);
+
+	STATS_START(started);
+	STATS_START(held);
+	pthread_mutex_lock(&service->lock);
+	STATS_STOP(STAT_LOCK_WAIT, held);
+
+	/*The lock is not held while waiting for the answer, so only the time
+ * 		around the wait counts as held */
+	STATS_START(held);
+	service->requests++;
+	ticket = service->requests;
+	pthread_cond_signal(&service->requested);
+	while(service->answers < ticket) {
+		STATS_STOP(STAT_LOCK_HOLD, held);
+		pthread_cond_wait(&service->answered, &service->lock);
+		STATS_START(held);
+	}
+	snprintf(buffer, size, "%s", service->text);
+	pthread_mutex_unlock(&service->lock);
+	STATS_STOP(STAT_LOCK_HOLD, held);
+	STATS_STOP(STAT_TIME, started);
+}
+
+/* Stops the time thread and waits for it to exit
+ * args: [1] service, a started TimeService
+ * pre: nobody may ask for the time once this has been called
+ * post: the thread has been joined and the service's lock and condition
+ * 	variables are destroyed
+ * ret: none
+ */
+void stopTimeService(struct TimeService* service) {
+	pthread_mutex_lock(&service->lock);
+	service->stopping = 1;
+	pthread_cond_signal(&service->requested);
+	pthread_mutex_unlock(&service->lock);
+
+	pthread_join(service->thread, NULL);
+
+	pthread_mutex_destroy(&service->lock);
+	pthread_cond_destroy(&service->requested);
+	pthread_cond_destroy(&service->answered);
+}
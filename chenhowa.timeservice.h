@@ -0,0 +1,36 @@
+/* Filename: chenhowa.timeservice.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Background thread that formats the current local time whenever a
+ * 	caller asks for it, and hands the text back in memory.
+ */
+
+#ifndef CHENHOWA_TIMESERVICE_H
+#define CHENHOWA_TIMESERVICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define TIME_FILE_NAME "currentTime.txt" /*file the time is also written to, if asked */
+#define TIME_TEXT_LEN 64 /*longest formatted time, with its terminator */
+
+/*Request/response state shared by the time thread and everyone asking it for the time */
+struct TimeService {
+	pthread_mutex_t lock; /*guards every field below */
+	pthread_cond_t requested; /*signalled when a request is posted */
+	pthread_cond_t answered; /*broadcast when requests are answered */
+	uint64_t requests; /*number of requests posted so far */
+	uint64_t answers; /*number of requests answered so far */
+	char text[TIME_TEXT_LEN]; /*the most recently formatted time */
+	int writeFile; /*1 if every answer is also written to TIME_FILE_NAME */
+	int stopping; /*set by stopTimeService to make the thread exit */
+	pthread_t thread; /*the time thread */
+};
+
+void formatTime(char* buffer, size_t size);
+int startTimeService(struct TimeService* service, int writeFile);
+void requestTime(struct TimeService* service, char* buffer, size_t size);
+void stopTimeService(struct TimeService* service);
+
+#endif
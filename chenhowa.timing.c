@@ -0,0 +1,55 @@
+/* Filename: chenhowa.timing.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Clock and percentile helpers shared by the batch mode, the load
+ * 	generator and the benchmarks.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "chenhowa.timing.h"
+
+/*Returns the current time in nanoseconds, from the monotonic clock */
+double nowNs(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/*Orders doubles from smallest to largest for qsort */
+static int compareDoubles(const void* a, const void* b) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+
+	return (x > y) - (x < y);
+}
+
+/*Sorts samples from smallest to largest, ready for percentile */
+void sortSamples(double* samples, size_t count) {
+	qsort(samples, count, sizeof(double), compareDoubles);
+}
+
+/* Returns a nearest-rank percentile of sorted samples
+ * args: [1] sorted, samples sorted from smallest to largest
+ * 	[2] count, the number of samples
+ * 	[3] fraction, the percentile wanted, from 0 to 1
+ * ret: the smallest sample that at least fraction of the samples are no larger than,
+ * 	or 0 if there are no samples
+ */
+double percentile(double* sorted, size_t count, double fraction) {
+	size_t rank;
+
+	if(count == 0) {
+		return 0;
+	}
+	rank = (size_t)(fraction * count + 0.999999);
+	if(rank < 1) {
+		rank = 1;
+	}
+	if(rank > count) {
+		rank = count;
+	}
+	return sorted[rank - 1];
+}
@@ -0,0 +1,17 @@
+/* Filename: chenhowa.timing.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Clock and percentile helpers shared by the batch mode, the load
+ * 	generator and the benchmarks.
+ */
+
+#ifndef CHENHOWA_TIMING_H
+#define CHENHOWA_TIMING_H
+
+#include <stddef.h>
+
+double nowNs(void);
+void sortSamples(double* samples, size_t count);
+double percentile(double* sorted, size_t count, double fraction);
+
+#endif
@@ -0,0 +1,532 @@
+/* Filename: chenhowa.verify.c
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Verifies a maze with a pool of worker threads.
+ *
+ * 	Each worker first checks the degrees of its own range of rooms, rejects any
+ * 	connection to a missing room, to its own room, or repeated, and sums a
+ * 	hash of every other connection both forward and reversed. The maze is symmetric
+ * 	when the two sums agree, which takes one sequential pass instead of looking
+ * 	up every connection's room; one-way connections are only counted exactly
+ * 	when the sums differ.
+ *
+ * 	Then they run a level-synchronous, direction-optimizing BFS from the
+ * 	START_ROOM. While the frontier is small, workers claim chunks of it and mark
+ * 	the rooms it links to in a shared bitset with atomic ORs (top-down). Once the
+ * 	frontier's links outnumber the unexplored links by enough, each worker
+ * 	instead scans its own words of the bitset for unreached rooms and checks
+ * 	whether any of their connections is on the frontier (bottom-up), which needs
+ * 	no atomics at all. Worker 0 does the serial step between levels, and the
+ * 	only synchronization besides the atomics is the barrier between phases.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "chenhowa.verify.h"
+#include "chenhowa.timing.h"
+
+#define TOP_DOWN 0
+#define BOTTOM_UP 1
+#define ALPHA 14 /*go bottom-up once the frontier has more than 1/ALPHA of the unexplored links */
+#define BETA 24 /*go back top-down once the frontier has fewer than 1/BETA of the rooms */
+#define CHUNK 1024 /*frontier rooms a worker claims at a time */
+#define LOCAL_BATCH 256 /*rooms a worker finds before adding them to a shared queue */
+
+struct VerifyJob;
+
+/*One worker's share of verifying a maze */
+struct VerifyTask {
+	struct VerifyJob* job; /*the verification this task is part of */
+	int index; /*index of this task in job->tasks */
+	uint64_t firstWord; /*first bitset word this worker owns; it owns rooms 64 * firstWord on */
+	uint64_t endWord; /*one past the last bitset word this worker owns */
+	uint64_t badDegrees; /*rooms in range with a bad degree */
+	uint64_t badLinks; /*connections from rooms in range to a missing room, to their own room, or repeated */
+	uint64_t forwardHash; /*sum of linkHash(room, connection) over connections from rooms in range */
+	uint64_t backwardHash; /*sum of linkHash(connection, room) over the same connections */
+	uint64_t oneWayLinks; /*connections from rooms in range with no connection back */
+	uint64_t found; /*rooms found in the current level */
+	uint64_t foundLinks; /*connections of the rooms found in the current level */
+	uint32_t buffer[LOCAL_BATCH]; /*found rooms not yet added to a shared queue */
+	int buffered; /*number of rooms in buffer */
+};
+
+/*State shared by every worker */
+struct VerifyJob {
+	const struct Maze* maze;
+	int minDegree;
+	int maxDegree;
+	uint32_t start; /*START_ROOM of maze */
+	struct VerifyTask* tasks; /*one task per worker */
+	int numTasks; /*number of workers */
+	pthread_mutex_t startLock; /*held until the workers' ranges and the barrier are set up */
+	pthread_barrier_t barrier; /*separates the phases of the verification */
+	uint64_t numWords; /*words in each bitset */
+	uint64_t* visited; /*rooms reached so far */
+	uint64_t* frontierBits; /*rooms found in the last level, when they are kept as bits */
+	uint64_t* nextBits; /*rooms found in the current bottom-up level */
+	uint32_t* frontier; /*rooms found in the last level, when they are kept as a queue */
+	uint32_t* next; /*rooms found in the current top-down level */
+	uint64_t frontierSize; /*rooms in frontier */
+	uint64_t nextSize; /*rooms in next; workers reserve space in it with an atomic add */
+	uint64_t claimed; /*frontier rooms claimed so far; workers claim chunks with an atomic add */
+	int direction; /*TOP_DOWN or BOTTOM_UP, for the current level */
+	int frontierIsBits; /*1 if the frontier is in frontierBits, 0 if it is in frontier */
+	int done; /*1 once a level finds no new rooms */
+	int asymmetric; /*1 if the link hashes disagree, so one-way links must be counted */
+	uint64_t unexploredLinks; /*connections of the rooms not yet reached */
+	double started; /*when the current phase started */
+	struct MazeCheck* check;
+};
+
+/*Mixes a connection from one room to another into a well spread 64 bit hash */
+static uint64_t linkHash(uint64_t from, uint64_t to) {
+	uint64_t x = from << 32 | to;
+
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+/*Returns one past the last room a task owns */
+static uint64_t endRoom(const struct VerifyTask* task) {
+	uint64_t end = task->endWord * 64;
+
+	return end < task->job->maze->numRooms ? end : task->job->maze->numRooms;
+}
+
+/* Counts the rooms a task owns with a bad degree or a bad connection, and
+ * 	hashes the rest of their connections. A self-loop or a repeated two-way
+ * 	connection hashes the same both ways, so the hashes alone can't catch them
+ * args: [1] task, the worker's VerifyTask
+ * ret: none
+ */
+static void checkDegrees(struct VerifyTask* task) {
+	const struct Maze* maze = task->job->maze;
+	uint64_t room;
+	uint64_t end = endRoom(task);
+	const uint32_t* connections;
+	int i, j;
+
+	for(room = task->firstWord * 64; room < end; room++) {
+		if(maze->degrees[room] < task->job->minDegree || maze->degrees[room] > task->job->maxDegree) {
+			task->badDegrees++;
+		}
+		connections = mazeConnections(maze, room);
+		for(i = 0; i < maze->degrees[room]; i++) {
+			if(connections[i] >= maze->numRooms || connections[i] == room) {
+				task->badLinks++;
+				continue;
+			}
+
+			/*A room has at most 255 connections, so a scan of the earlier ones is cheap */
+			for(j = 0; j < i; j++) {
+				if(connections[j] == connections[i]) {
+					break;
+				}
+			}
+			if(j < i) {
+				task->badLinks++;
+				continue;
+			}
+			task->forwardHash += linkHash(room, connections[i]);
+			task->backwardHash += linkHash(connections[i], room);
+		}
+	}
+}
+
+/*Counts the connections from rooms a task owns that have no connection back */
+static void countOneWayLinks(struct VerifyTask* task) {
+	const struct Maze* maze = task->job->maze;
+	uint64_t room;
+	uint64_t end = endRoom(task);
+	const uint32_t* connections;
+	const uint32_t* back;
+	int i, j;
+	int found;
+
+	for(room = task->firstWord * 64; room < end; room++) {
+		connections = mazeConnections(maze, room);
+		for(i = 0; i < maze->degrees[room]; i++) {
+			back = mazeConnections(maze, connections[i]);
+			found = 0;
+			for(j = 0; j < maze->degrees[connections[i]] && !found; j++) {
+				found = back[j] == room;
+			}
+			if(!found) {
+				task->oneWayLinks++;
+			}
+		}
+	}
+}
+
+/*Adds a task's buffered rooms to a shared queue, reserving space with an atomic add on size */
+static void flushRooms(struct VerifyTask* task, uint32_t* queue, uint64_t* size) {
+	uint64_t position;
+
+	if(task->buffered == 0) {
+		return;
+	}
+	position = __atomic_fetch_add(size, task->buffered, __ATOMIC_RELAXED);
+	memcpy(queue + position, task->buffer, task->buffered * sizeof(uint32_t));
+	task->buffered = 0;
+}
+
+/*Buffers a room to be added to a shared queue */
+static void pushRoom(struct VerifyTask* task, uint32_t* queue, uint64_t* size, uint32_t room) {
+	task->buffer[task->buffered] = room;
+	task->buffered++;
+	if(task->buffered == LOCAL_BATCH) {
+		flushRooms(task, queue, size);
+	}
+}
+
+/*Expands chunks of the frontier queue, claiming every unreached connection with an
+ * atomic OR. Only the worker whose OR set the bit adds the room to next */
+static void expandTopDown(struct VerifyTask* task) {
+	struct VerifyJob* job = task->job;
+	const struct Maze* maze = job->maze;
+	const uint32_t* connections;
+	uint64_t first, end, i;
+	uint64_t bit;
+	uint64_t old;
+	uint32_t room, next;
+	int j;
+
+	while((first = __atomic_fetch_add(&job->claimed, CHUNK, __ATOMIC_RELAXED)) < job->frontierSize) {
+		end = first + CHUNK < job->frontierSize ? first + CHUNK : job->frontierSize;
+		for(i = first; i < end; i++) {
+			room = job->frontier[i];
+			connections = mazeConnections(maze, room);
+			for(j = 0; j < maze->degrees[room]; j++) {
+				next = connections[j];
+				bit = (uint64_t)1 << (next & 63);
+				if(__atomic_load_n(&job->visited[next >> 6], __ATOMIC_RELAXED) & bit) {
+					continue;
+				}
+				old = __atomic_fetch_or(&job->visited[next >> 6], bit, __ATOMIC_RELAXED);
+				if(!(old & bit)) {
+					pushRoom(task, job->next, &job->nextSize, next);
+					task->found++;
+					task->foundLinks += maze->degrees[next];
+				}
+			}
+		}
+	}
+	flushRooms(task, job->next, &job->nextSize);
+}
+
+/*Finds the unreached rooms a task owns that connect to the frontier. Every word
+ * written belongs to this task, so no atomics are needed */
+static void expandBottomUp(struct VerifyTask* task) {
+	struct VerifyJob* job = task->job;
+	const struct Maze* maze = job->maze;
+	const uint32_t* connections;
+	uint64_t word;
+	uint64_t unreached;
+	uint64_t found;
+	uint32_t room;
+	int j;
+
+	for(word = task->firstWord; word < task->endWord; word++) {
+		unreached = ~job->visited[word];
+		if(word == job->numWords - 1 && (maze->numRooms & 63) != 0) {
+			unreached &= ((uint64_t)1 << (maze->numRooms & 63)) - 1;
+		}
+		found = 0;
+		while(unreached != 0) {
+			room = word * 64 + __builtin_ctzll(unreached);
+			connections = mazeConnections(maze, room);
+			for(j = 0; j < maze->degrees[room]; j++) {
+				if((job->frontierBits[connections[j] >> 6] >> (connections[j] & 63)) & 1) {
+					found |= (uint64_t)1 << (room & 63);
+					task->found++;
+					task->foundLinks += maze->degrees[room];
+					break;
+				}
+			}
+			unreached &= unreached - 1;
+		}
+		job->visited[word] |= found;
+		job->nextBits[word] = found;
+	}
+}
+
+/*Turns the frontier bits a task owns into entries of the frontier queue */
+static void bitsToQueue(struct VerifyTask* task) {
+	struct VerifyJob* job = task->job;
+	uint64_t word;
+	uint64_t bits;
+
+	for(word = task->firstWord; word < task->endWord; word++) {
+		for(bits = job->frontierBits[word]; bits != 0; bits &= bits - 1) {
+			pushRoom(task, job->frontier, &job->frontierSize, word * 64 + __builtin_ctzll(bits));
+		}
+	}
+	flushRooms(task, job->frontier, &job->frontierSize);
+}
+
+/*Sets the frontier bits of chunks of the frontier queue. The frontier bits must
+ * have been cleared first */
+static void queueToBits(struct VerifyTask* task) {
+	struct VerifyJob* job = task->job;
+	uint64_t first, end, i;
+	uint32_t room;
+
+	while((first = __atomic_fetch_add(&job->claimed, CHUNK, __ATOMIC_RELAXED)) < job->frontierSize) {
+		end = first + CHUNK < job->frontierSize ? first + CHUNK : job->frontierSize;
+		for(i = first; i < end; i++) {
+			room = job->frontier[i];
+			__atomic_fetch_or(&job->frontierBits[room >> 6], (uint64_t)1 << (room & 63), __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/*Serial step between levels, done by worker 0: totals the level, makes what it
+ * found the new frontier, and picks the direction of the next level */
+static void finishLevel(struct VerifyJob* job) {
+	uint64_t found = 0;
+	uint64_t foundLinks = 0;
+	uint64_t* bits;
+	uint32_t* queue;
+	int i;
+
+	for(i = 0; i < job->numTasks; i++) {
+		found += job->tasks[i].found;
+		foundLinks += job->tasks[i].foundLinks;
+		job->tasks[i].found = 0;
+		job->tasks[i].foundLinks = 0;
+	}
+	if(found == 0) {
+		job->done = 1;
+		return;
+	}
+
+	job->check->levels++;
+	job->check->reached += found;
+	job->unexploredLinks -= foundLinks;
+	if(job->direction == TOP_DOWN) {
+		job->check->topDownLevels++;
+		queue = job->frontier;
+		job->frontier = job->next;
+		job->next = queue;
+		job->frontierSize = job->nextSize;
+		job->frontierIsBits = 0;
+		if(foundLinks > job->unexploredLinks / ALPHA) {
+			job->direction = BOTTOM_UP;
+		}
+	} else {
+		job->check->bottomUpLevels++;
+		bits = job->frontierBits;
+		job->frontierBits = job->nextBits;
+		job->nextBits = bits;
+		job->frontierIsBits = 1;
+		if(found < job->maze->numRooms / BETA) {
+			job->direction = TOP_DOWN;
+		}
+	}
+
+	/*A frontier of bits is turned into a queue at the start of a top-down level */
+	if(job->direction == TOP_DOWN && job->frontierIsBits) {
+		job->frontierSize = 0;
+	}
+	job->nextSize = 0;
+	job->claimed = 0;
+}
+
+/* Description: body of every verification worker
+ * Args: [1] arg, the worker's VerifyTask
+ * Post: the task's counters are filled in, and after worker 0 returns, job->check
+ * 	holds the totals
+ * ret: NULL
+ *
+ * Every barrier is reached by every worker, so all of them see the same value of
+ * job->direction, job->frontierIsBits and job->done between two barriers.
+ */
+static void* verifyWorker(void* arg) {
+	struct VerifyTask* task = arg;
+	struct VerifyJob* job = task->job;
+	uint64_t word;
+	uint64_t forward = 0, backward = 0;
+	int i;
+
+	/*Wait until every worker that could be started has its range of rooms */
+	pthread_mutex_lock(&job->startLock);
+	pthread_mutex_unlock(&job->startLock);
+
+	checkDegrees(task);
+	pthread_barrier_wait(&job->barrier);
+	if(task->index == 0) {
+		for(i = 0; i < job->numTasks; i++) {
+			job->check->badDegrees += job->tasks[i].badDegrees;
+			job->check->badLinks += job->tasks[i].badLinks;
+			forward += job->tasks[i].forwardHash;
+			backward += job->tasks[i].backwardHash;
+		}
+
+		/*A bad connection may lead outside the maze, so nothing may follow one */
+		job->asymmetric = job->check->badLinks == 0 && forward != backward;
+		job->done = job->check->badLinks > 0;
+	}
+	pthread_barrier_wait(&job->barrier);
+	if(job->asymmetric) {
+		countOneWayLinks(task);
+		pthread_barrier_wait(&job->barrier);
+	}
+	if(task->index == 0) {
+		for(i = 0; i < job->numTasks; i++) {
+			job->check->oneWayLinks += job->tasks[i].oneWayLinks;
+		}
+		job->check->degreeSeconds = (nowNs() - job->started) / 1e9;
+		job->started = nowNs();
+	}
+	pthread_barrier_wait(&job->barrier);
+
+	while(!job->done) {
+		if(job->direction == TOP_DOWN) {
+			if(job->frontierIsBits) {
+				bitsToQueue(task);
+				pthread_barrier_wait(&job->barrier);
+			}
+			expandTopDown(task);
+		} else {
+			if(!job->frontierIsBits) {
+				for(word = task->firstWord; word < task->endWord; word++) {
+					job->frontierBits[word] = 0;
+				}
+				pthread_barrier_wait(&job->barrier);
+				queueToBits(task);
+				pthread_barrier_wait(&job->barrier);
+			}
+			expandBottomUp(task);
+		}
+
+		pthread_barrier_wait(&job->barrier);
+		if(task->index == 0) {
+			finishLevel(job);
+		}
+		pthread_barrier_wait(&job->barrier);
+	}
+
+	if(task->index == 0) {
+		job->check->bfsSeconds = (nowNs() - job->started) / 1e9;
+	}
+	return NULL;
+}
+
+/* Checks the degrees, symmetry and connectivity of a maze
+ * args: [1] maze, the maze to check
+ * 	[2] minDegree, the fewest connections a room may have
+ * 	[3] maxDegree, the most connections a room may have
+ * 	[4] threads, the number of worker threads, counting the calling thread
+ * 	[5] check, where to store what was found
+ * post: check is filled in; see mazeIsValid. If some workers can't be started,
+ * 	the rooms are split across the ones that were
+ * ret: 0 on success, 1 if the maze has no START_ROOM or memory could not be allocated
+ */
+int verifyMaze(const struct Maze* maze, int minDegree, int maxDegree, int threads, struct MazeCheck* check) {
+	struct VerifyJob job;
+	pthread_t* workers;
+	uint64_t wordsPerTask;
+	int started;
+	int i;
+
+	memset(check, 0, sizeof(*check));
+	memset(&job, 0, sizeof(job));
+	job.maze = maze;
+	job.minDegree = minDegree;
+	job.maxDegree = maxDegree;
+	job.check = check;
+	job.start = findRoomOfType(maze, START_ROOM);
+	if(job.start == NO_ROOM) {
+		fprintf(stderr, "The maze has no START_ROOM\n");
+		return 1;
+	}
+	if(threads < 1) {
+		threads = 1;
+	}
+
+	job.numWords = ((uint64_t)maze->numRooms + 63) / 64;
+	job.visited = calloc(job.numWords, sizeof(uint64_t));
+	job.frontierBits = calloc(job.numWords, sizeof(uint64_t));
+	job.nextBits = calloc(job.numWords, sizeof(uint64_t));
+	job.frontier = malloc(maze->numRooms * sizeof(uint32_t));
+	job.next = malloc(maze->numRooms * sizeof(uint32_t));
+	job.tasks = calloc(threads, sizeof(struct VerifyTask));
+	workers = calloc(threads, sizeof(pthread_t));
+	if(job.visited == NULL || job.frontierBits == NULL || job.nextBits == NULL || job.frontier == NULL
+			|| job.next == NULL || job.tasks == NULL || workers == NULL) {
+		fprintf(stderr, "Could not allocate the verification of %u rooms\n", maze->numRooms);
+		free(job.visited);
+		free(job.frontierBits);
+		free(job.nextBits);
+		free(job.frontier);
+		free(job.next);
+		free(job.tasks);
+		free(workers);
+		return 1;
+	}
+
+	/*The BFS starts from a frontier of just the START_ROOM */
+	job.visited[job.start >> 6] |= (uint64_t)1 << (job.start & 63);
+	job.frontier[0] = job.start;
+	job.frontierSize = 1;
+	job.direction = TOP_DOWN;
+	job.unexploredLinks = maze->numLinks - maze->degrees[job.start];
+	check->reached = 1;
+	check->levels = 1;
+
+	/*The calling thread acts as worker 0. The workers wait on startLock, so the
+ * 	rooms and the barrier can be split across only the ones that started */
+	for(i = 0; i < threads; i++) {
+		job.tasks[i].job = &job;
+		job.tasks[i].index = i;
+	}
+	pthread_mutex_init(&job.startLock, NULL);
+	pthread_mutex_lock(&job.startLock);
+	for(started = 1; started < threads; started++) {
+		if(pthread_create(workers + started, NULL, verifyWorker, job.tasks + started) != 0) {
+			break;
+		}
+	}
+
+	/*Every worker owns whole bitset words, so bottom-up levels never share a word */
+	job.numTasks = started;
+	wordsPerTask = (job.numWords + started - 1) / started;
+	for(i = 0; i < started; i++) {
+		job.tasks[i].firstWord = i * wordsPerTask < job.numWords ? i * wordsPerTask : job.numWords;
+		job.tasks[i].endWord = (i + 1) * wordsPerTask < job.numWords ? (i + 1) * wordsPerTask : job.numWords;
+	}
+	pthread_barrier_init(&job.barrier, NULL, started);
+	job.started = nowNs();
+	pthread_mutex_unlock(&job.startLock);
+
+	verifyWorker(job.tasks);
+	for(i = 1; i < started; i++) {
+		pthread_join(workers[i], NULL);
+	}
+	pthread_barrier_destroy(&job.barrier);
+	pthread_mutex_destroy(&job.startLock);
+
+	free(job.visited);
+	free(job.frontierBits);
+	free(job.nextBits);
+	free(job.frontier);
+	free(job.next);
+	free(job.tasks);
+	free(workers);
+	return 0;
+}
+
+/*Returns 1 if a verified maze has no degree, connection or symmetry problems
+ * and every room can be reached, 0 otherwise */
+int mazeIsValid(const struct Maze* maze, const struct MazeCheck* check) {
+	return check->badDegrees == 0 && check->badLinks == 0 && check->oneWayLinks == 0
+		&& check->reached == maze->numRooms;
+}
@@ -0,0 +1,33 @@
+/* Filename: chenhowa.verify.h
+ * Author: Howard Chen
+ * Date Created: 10-16-2026
+ * Description: Checks a generated maze with a pool of worker threads: every room
+ * 	has an allowed number of connections, every connection leads to another
+ * 	room at most once and goes both ways, and every room can be reached from
+ * 	the START_ROOM.
+ */
+
+#ifndef CHENHOWA_VERIFY_H
+#define CHENHOWA_VERIFY_H
+
+#include <stdint.h>
+
+#include "chenhowa.maze.h"
+
+/*What verifyMaze found, and how long it took */
+struct MazeCheck {
+	uint64_t badDegrees; /*rooms with too few or too many connections */
+	uint64_t badLinks; /*connections to a missing room, to their own room, or repeated */
+	uint64_t oneWayLinks; /*connections with no connection back; not counted if there are bad ones */
+	uint64_t reached; /*rooms reachable from the START_ROOM, counting it */
+	uint32_t levels; /*BFS levels, one more than the farthest room's distance */
+	uint32_t topDownLevels; /*levels expanded from the frontier outward */
+	uint32_t bottomUpLevels; /*levels found by unreached rooms looking for the frontier */
+	double degreeSeconds; /*time taken by the degree and symmetry checks */
+	double bfsSeconds; /*time taken by the BFS */
+};
+
+int verifyMaze(const struct Maze* maze, int minDegree, int maxDegree, int threads, struct MazeCheck* check);
+int mazeIsValid(const struct Maze* maze, const struct MazeCheck* check);
+
+#endif